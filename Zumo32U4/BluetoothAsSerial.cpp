@@ -7,6 +7,9 @@
 
 #include "BluetoothAsSerial.hpp"
 #include <Zumo32U4.h>
+#include "trace.hpp"
+#include "telemetry.hpp"
+#include "framing.hpp"
 
 using namespace robo_utils;
 
@@ -23,45 +26,148 @@ namespace robotieee {
         Serial1.begin(BAUD_RATE);
 
         receivedOnePackage = false;
+        nextSequence = 0;
+        selectiveAckDue = false;
+        windowVersion = WINDOW_PROTOCOL_VERSION;
+    }
+
+    void BluetoothAsSerial::receiveWindowed(const uint8_t* frame) {
+        uint8_t sequence = CommunicationPackage::getIDFromString((char*)frame);
+        uint8_t length = PACKAGE_HEADER_BYTE_LENGTH + CommunicationPackage::getPayloadLengthFromString((char*)frame);
+
+        if (CommunicationPackage::getTypeFromString((char*)frame) == PACKAGE_TYPE_ACKNOWLEDGE) {
+            acknowledgeWindowed(frame);
+            return;
+        }
+
+        //a package already read came again because its selective ack has been lost: the answer is in the send window
+        if (receiveWindow.contains(sequence))
+            receiveWindow.put(sequence, frame, length);
+
+        //even a package out of the window needs the ack: the Host hasn't received the previous one
+        selectiveAckDue = true;
+        windowVersion = CommunicationPackage::getVersionFromString((char*)frame);
+    }
+
+    void BluetoothAsSerial::acknowledgeWindowed(const uint8_t* frame) {
+        uint8_t sequence = CommunicationPackage::getIDFromString((char*)frame);
+        uint8_t bitmap = 0;
+
+        if (CommunicationPackage::getPayloadLengthFromString((char*)frame) >= 2 && frame[PACKAGE_HEADER_BYTE_LENGTH] == MESSAGE_TYPE_SELECTIVE_ACK)
+            bitmap = frame[PACKAGE_HEADER_BYTE_LENGTH + 1];
+
+        //every package up to the ID has been received
+        while (sendWindow.getBase() != nextSequence && sendWindow.contains(sequence))
+            sendWindow.slide();
+
+        //and the ones after it in the bitmap
+        for(uint8_t i = 0; i < WINDOW_SIZE; i++) {
+            if (bitmap & (1 << i))
+                sendWindow.remove(sequence + 1 + i);
+        }
+
+        //the window starts from the first package not acknowledged
+        while (sendWindow.getBase() != nextSequence && !sendWindow.isPresent(sendWindow.getBase()))
+            sendWindow.slide();
+    }
+
+    bool BluetoothAsSerial::sendWindowed(IPackage* package) {
+        uint8_t frame[WINDOW_FRAME_LENGTH];
+        uint16_t length;
+
+        if (package->getPayload()->getSize() > PARSER_MAX_PAYLOAD_LENGTH)
+            return false;
+
+        //waits only if the window is full
+        while ((uint8_t)(nextSequence - sendWindow.getBase()) >= WINDOW_SIZE)
+            update();
+
+        package->setID(nextSequence);
+        length = package->serialize(frame);
+        sendWindow.put(nextSequence, frame, length);
+        sendWindow.setSentTime(nextSequence, millis());
+        nextSequence++;
+
+        write(frame, length);
+        lastSent.clone(package);
+
+        return true;
+    }
+
+    void BluetoothAsSerial::sendSelectiveAck() {
+        uint8_t frame[PACKAGE_HEADER_BYTE_LENGTH + 2];
+
+        CommunicationPackage::writeHeader(frame, windowVersion, receiveWindow.getBase() - 1, 2, PACKAGE_TYPE_ACKNOWLEDGE);
+        frame[PACKAGE_HEADER_BYTE_LENGTH] = MESSAGE_TYPE_SELECTIVE_ACK;
+        frame[PACKAGE_HEADER_BYTE_LENGTH + 1] = receiveWindow.getBitmap();
+
+        write(frame, sizeof(frame));
+        selectiveAckDue = false;
+    }
+
+    void BluetoothAsSerial::retransmit() {
+        uint16_t now = millis();
+
+        for(uint8_t sequence = sendWindow.getBase(); sequence != nextSequence; sequence++) {
+            if (sendWindow.isPresent(sequence) && (uint16_t)(now - sendWindow.getSentTime(sequence)) >= WINDOW_ACK_TIMEOUT) {
+                write(sendWindow.get(sequence), sendWindow.getLength(sequence));
+                sendWindow.setSentTime(sequence, now);
+            }
+        }
+    }
+
+    void BluetoothAsSerial::write(const uint8_t* frame, uint8_t length) {
+#       ifdef TELEMETRY
+        //the telemetry package being streamed must end before this one starts
+        telemetryFinish();
+#       endif
+        if (CommunicationPackage::getVersionFromString((char*)frame) >= FRAMED_PROTOCOL_VERSION) {
+            uint8_t framed[FRAMED_LENGTH(WINDOW_FRAME_LENGTH)];
+
+            Serial1.write(framed, frameEncode(frame, length, framed));
+            return;
+        }
+        Serial1.write(frame, length);
     }
 
     /* PUBLIC ------------------------------------------------------------------------------------------------------------------- */
 
     bool BluetoothAsSerial::somethingToRead() {
-        return Serial1.available() > 0;
+        return Serial1.available() > 0 || parser.receiving() || parser.available() > 0 || receiveWindow.isPresent(receiveWindow.getBase());
     }
 
     bool BluetoothAsSerial::waitForPackage(IPackage* package, uint16_t timeout /* = DEFAULT_READ_TIMEOUT */) {
-        char buffer[MAX_PACKAGE_LENGTH];
+        TRACE_BEGIN(traceStart);
         long startTime = millis();
         bool packageOk = false;
-        uint16_t bufIndex = 0;
-        uint8_t payloadLength = 0;
 
         //while timeout occurs or package is ok
-        while (millis()-startTime < timeout && !packageOk) {
-            //continue while there is something to read and the number of bytes read is less than the number of bytes to read
-            while(somethingToRead() && bufIndex < PACKAGE_HEADER_BYTE_LENGTH + payloadLength) {
-                buffer[bufIndex++] = Serial1.read();
-
-                //if all the bytes of the header are read, init the payload length
-                if (bufIndex == PACKAGE_HEADER_BYTE_LENGTH) {
-                    payloadLength = CommunicationPackage::getPayloadLengthFromString(buffer);
-                }
-            }
+        while (millis()-startTime < timeout && !packageOk)
+            packageOk = pollPackage(package);
 
-            if (bufIndex == PACKAGE_HEADER_BYTE_LENGTH + payloadLength)
-                packageOk = true;
-        }
+        TRACE_END(TE_WAIT_PACKAGE, traceStart);
+        return packageOk;
+    }
+
+    bool BluetoothAsSerial::pollPackage(IPackage* package) {
+        bool packageOk = false;
+
+        update();
 
-        //init the package from string
-        packageOk = packageOk & CommunicationPackage::initFromString(package, buffer);
+        //the packages of protocol version 3 are read in order of sequence number
+        if (receiveWindow.isPresent(receiveWindow.getBase())) {
+            packageOk = CommunicationPackage::initFromString(package, (char*)receiveWindow.get(receiveWindow.getBase()));
+            receiveWindow.slide();
+            receivedOnePackage = true;
+            lastReceived.clone(package);
+            return packageOk;
+        }
 
-        //verify the package read
-        packageOk = packageOk & package->verify(PROTOCOL_VERSION);
+        //the parser has already verified the package
+        packageOk = parser.pop(package);
 
         //more checks
-        if (packageOk && receivedOnePackage) {
+        if (packageOk && receivedOnePackage && lastReceived.getVersion() == package->getVersion()) {
             //if the package received has the same id of the last received, the ack has been lost. 
             //So it will re-send it (supposed in lastSent)
             if(package->getID() == lastReceived.getID()) {
@@ -79,32 +185,65 @@ namespace robotieee {
         return packageOk;
     }
 
+    void BluetoothAsSerial::update() {
+        const uint8_t* frame = nullptr;
+
+        //feeds the parser only with the bytes already received
+        while (Serial1.available() > 0)
+            parser.feed(Serial1.read());
+
+        //the packages of protocol version 3 go to their window, the others wait for pollPackage
+        while ((frame = parser.peek()) != nullptr && CommunicationPackage::getVersionFromString((char*)frame) >= WINDOW_PROTOCOL_VERSION) {
+            receiveWindowed(frame);
+            parser.drop();
+        }
+
+        //acks in bulk: once the Host has stopped sending
+        if (selectiveAckDue && !parser.receiving())
+            sendSelectiveAck();
+
+        retransmit();
+    }
+
     bool BluetoothAsSerial::sendPackage(IPackage* package) {
-        IPackage* ack =  nullptr;
-        string<MAX_PACKAGE_LENGTH>* pkgStr = nullptr;
+        //on the stack: the pool may be taken by the packages of the caller
+        CommunicationPackage ack;
+        uint8_t header[PACKAGE_HEADER_BYTE_LENGTH];
         bool sentCorrectly = false;
         uint8_t i = 0;
 
         if (package == nullptr)
             return false;
 
-        ack = new CommunicationPackage();
-        pkgStr = package->toString();
+        //the packages of protocol version 3 on don't wait for their ack. The answers too go in the window, so a lost one is sent again
+        if (package->getVersion() >= WINDOW_PROTOCOL_VERSION) {
+            TRACE_BEGIN(windowStart);
+            sentCorrectly = sendWindowed(package);
+            TRACE_END(TE_SEND_PACKAGE, windowStart);
+            return sentCorrectly;
+        }
+
+        TRACE_BEGIN(traceStart);
+#       ifdef TELEMETRY
+        //the telemetry package being streamed must end before this one starts
+        telemetryFinish();
+#       endif
+        package->serializeHeader(header);
 
         while (!sentCorrectly) {
-            //sends byte to byte the package 
-            for(i = 0; i < pkgStr->getSize(); i++)
-                Serial1.print(pkgStr->getBuffer()[i]);
+            //sends the header and then the payload straight from the package, without copying them
+            Serial1.write(header, PACKAGE_HEADER_BYTE_LENGTH);
+            Serial1.write((const uint8_t*)package->getPayload()->getBuffer(), package->getPayload()->getSize());
             
             Serial1.flush(); //waits for all data is sent
 
             //wait for the ack if the package sent isn't an ack
             if (package->getType() != PACKAGE_TYPE_ACKNOWLEDGE) {
                 //wait for the ack
-                for(i = 0; i < ACK_WAIT_ATTEMPT && !waitForPackage(ack); i++);
+                for(i = 0; i < ACK_WAIT_ATTEMPT && !waitForPackage(&ack); i++);
 
                 //verify the package received
-                if (i < ACK_WAIT_ATTEMPT && ack->getType() == PACKAGE_TYPE_ACKNOWLEDGE && ack->getID() == package->getID()) {
+                if (i < ACK_WAIT_ATTEMPT && ack.getType() == PACKAGE_TYPE_ACKNOWLEDGE && ack.getID() == package->getID()) {
                     sentCorrectly = true; //exit
                 }
             } else {
@@ -114,11 +253,34 @@ namespace robotieee {
 
         lastSent.clone(package);
 
-        delete(ack);
-        delete(pkgStr);
+        TRACE_END(TE_SEND_PACKAGE, traceStart);
+        return true;
+    }
+
+    bool BluetoothAsSerial::sendWithoutAck(IPackage* package) {
+        uint8_t frame[WINDOW_FRAME_LENGTH];
+
+        if (package == nullptr || package->getPayload()->getSize() > PARSER_MAX_PAYLOAD_LENGTH)
+            return false;
+
+        write(frame, package->serialize(frame));
+
         return true;
     }
 
+    uint8_t BluetoothAsSerial::getLinkVersion() {
+        return receivedOnePackage ? lastReceived.getVersion() : PROTOCOL_VERSION;
+    }
+
+    void BluetoothAsSerial::discardReceived() {
+        while (Serial1.available() > 0)
+            Serial1.read();
+
+        parser.reset();
+        receiveWindow.reset(0);
+        selectiveAckDue = false;
+    }
+
     BluetoothAsSerial::~BluetoothAsSerial() {
         Serial1.end();
     }
@@ -126,21 +288,38 @@ namespace robotieee {
     /* STATIC ------------------------------------------------------------------------------------------------------------------- */
 
     IPackage* BluetoothAsSerial::initAcknowledge(IPackage* package, IMessage* message /* = nullptr */) {
+        uint8_t argsLength = 0;
+
+        if (message == nullptr)
+            return initAcknowledge(package, '\0', nullptr, 0);
+
+        //the arguments of a plain message end with the first '\0'
+        while (argsLength < ARGS_LENGHT && message->getArgs()[argsLength] != '\0')
+            argsLength++;
+
+        return initAcknowledge(package, message->getType(), message->getArgs(), argsLength);
+    }
+
+    IPackage* BluetoothAsSerial::initAcknowledge(IPackage* package, char type, const char* args, uint8_t argsLength) {
         IPackage* ack = nullptr;
 
         if (package == nullptr)
             return nullptr;
 
-        ack = new CommunicationPackage(PROTOCOL_VERSION, package->getID(), 0, PACKAGE_TYPE_ACKNOWLEDGE);
+        //the ack speaks the protocol version of the package
+        ack = new CommunicationPackage(package->getVersion(), package->getID(), 0, PACKAGE_TYPE_ACKNOWLEDGE);
 
-        if (message != nullptr) {
-            string<MAX_MESSAGE_LENGTH>* msgStr = message->toString();
-            ack->setPayloadLength(msgStr->getSize());
+        //the pool of the packages is full
+        if (ack == nullptr)
+            return nullptr;
 
-            for(uint8_t i = 0; i < msgStr->getSize(); i++)
-                ack->appendToPayload(msgStr->getBuffer()[i]);
+        if (type != '\0') {
+            //the same content of message->toString(), copied straight into the payload
+            ack->appendToPayload(type);
+            for(uint8_t i = 0; i < argsLength && i < ARGS_LENGHT; i++)
+                ack->appendToPayload(args[i]);
 
-            delete(msgStr);
+            ack->setPayloadLength(ack->getPayload()->getSize());
         }
 
         return ack;
@@ -153,10 +332,13 @@ namespace robotieee {
     }
 
     IPackage* BluetoothAsSerial::initFoundAck(IPackage* package, point robotPos, uint8_t blocksNum, point* blocksPos) {
-        compositeAction msg = compositeAction();
-        string<ARGS_LENGHT> args = string<ARGS_LENGHT>{};
+        //one more character: string::append always writes the terminator after the last one
+        string<ARGS_LENGHT + 1> args = string<ARGS_LENGHT + 1>{};
+
+        //the robot position and the blocks which still fit into the arguments
+        if (blocksNum > MAX_ACK_BLOCKS)
+            blocksNum = MAX_ACK_BLOCKS;
 
-        msg.setType(MESSAGE_TYPE_FOUND);
         /*
         //0123456789abcdefghil...
         args.append(robotPos.x > 9 ? (char)('a' + robotPos.x-10) : (char)('0' + robotPos.x));
@@ -176,16 +358,13 @@ namespace robotieee {
             args.append((char)blocksPos[i].y);
         }
 
-        msg.setArgs((char*)args.getBuffer());
-
-        return initAcknowledge(package, &msg);
+        //a coordinate may be 0: the length is given explicitly, so it is not taken for the end of the arguments
+        return initAcknowledge(package, MESSAGE_TYPE_FOUND, args.getBuffer(), args.getSize());
     }
     
     IPackage* BluetoothAsSerial::initNotFoundAck(IPackage* package, point robotPos) {
-        compositeAction msg = compositeAction();
-        string<ARGS_LENGHT> args = string<ARGS_LENGHT>{};
+        string<ARGS_LENGHT + 1> args = string<ARGS_LENGHT + 1>{};
 
-        msg.setType(MESSAGE_TYPE_FOUND);
         /*
         //0123456789abcdefghil...
         args.append(robotPos.x > 9 ? (char)('a' + robotPos.x-10) : (char)('0' + robotPos.x));
@@ -195,9 +374,7 @@ namespace robotieee {
         args.append((char)robotPos.x);
         args.append((char)robotPos.y);
 
-        msg.setArgs((char*)args.getBuffer());
-
-        return initAcknowledge(package, &msg);
+        return initAcknowledge(package, MESSAGE_TYPE_FOUND, args.getBuffer(), args.getSize());
     }
 
     void BluetoothAsSerial::jumpByte (uint8_t number) {
@@ -14,6 +14,8 @@
 #include <Zumo32U4.h>
 #include "ICommunicator.hpp"
 #include "CommunicationPackage.hpp"
+#include "PackageParser.hpp"
+#include "PackageWindow.hpp"
 #include "compositeAction.hpp"
 #include "string.hpp"
 #include "point.hpp"
@@ -23,6 +25,14 @@ using namespace robo_utils;
 namespace robotieee {
     /* Protocol version implemented */
     #define PROTOCOL_VERSION            2
+    /* Protocol version with a sliding window of WINDOW_SIZE packages and selective acks */
+    #define WINDOW_PROTOCOL_VERSION     3
+    /* Protocol version with the sliding window of version 3, in frames with a CRC (see framing.hpp) */
+    #define FRAMED_PROTOCOL_VERSION     4
+    /* Latest protocol version understood: the robot answers each package with its version */
+    #define MAX_PROTOCOL_VERSION        FRAMED_PROTOCOL_VERSION
+    /* Millis to wait for the ack of a package of protocol version 3 before sending it again */
+    #define WINDOW_ACK_TIMEOUT          500
 
     /* Message type: move */
     #define MESSAGE_TYPE_MOVE           'M'
@@ -34,6 +44,13 @@ namespace robotieee {
     #define MESSAGE_TYPE_NOT_FOUND      'N'
     /* Message type: error */
     #define MESSAGE_TYPE_ERROR          'E'
+    /* Message type: dump of the traces (see trace.hpp), sent after the ack */
+    #define MESSAGE_TYPE_TRACE          'T'
+    /* Message type: selective ack of protocol version 3. The argument is the bitmap of the packages received after the ID of the ack */
+    #define MESSAGE_TYPE_SELECTIVE_ACK  'K'
+
+    /* Blocks a FOUND acknowledge can carry: two characters each, after the two of the robot position */
+    #define MAX_ACK_BLOCKS              ((ARGS_LENGHT - 2) / 2)
     
     /**
      * Implements ICommunicator interface.
@@ -41,6 +58,17 @@ namespace robotieee {
      * Suitable for implementations of second version protocol onwards.
      * The communication is with a Bluetooth module that Robot see as a serial module. The class uses Serial1 integrated class.
      * This class is a Singleton, so to access to the unique instance of the object you have to use BluetoothAsSerial::getInstance() method.
+     * 
+     * Protocol version 2 is stop-and-wait: the Host sends a package and waits for its ack.
+     * Protocol version 3 has a sliding window: the ID is a sequence number (see SEQUENCE_PROTOCOL_VERSION) and each side sends
+     * up to WINDOW_SIZE packages before they are acknowledged. The receiver acks in bulk with a selective ack: an acknowledge with
+     * the ID of the last package read and a MESSAGE_TYPE_SELECTIVE_ACK message, whose argument has bit i set if the package
+     * ID + 1 + i has been received too. The sender sends again only the packages not acknowledged after WINDOW_ACK_TIMEOUT millis.
+     * The answers of the Robot (the acknowledges with or without a message, e.g. block found) are packages of the window too,
+     * with their own sequence number: they come in the order of the instructions they answer, and the Host acks them as any
+     * other package. An acknowledge whose message isn't MESSAGE_TYPE_SELECTIVE_ACK is an answer.
+     * Protocol version 4 works as version 3, but each package goes in a frame with a CRC-16 (see framing.hpp): the corrupted
+     * packages are dropped and sent again as if they were lost.
      */
     class BluetoothAsSerial : public ICommunicator {
     public:
@@ -48,7 +76,7 @@ namespace robotieee {
         /**
          * Checks if there's something to read.
          * 
-         * @return  true: somenthing to read in buffer; false: otherwise
+         * @return  true: somenthing to read in buffer, or a package partially or completely received; false: otherwise
          */
         bool somethingToRead();
 
@@ -62,6 +90,27 @@ namespace robotieee {
          */
         bool waitForPackage(IPackage* package, uint16_t timeout = DEFAULT_READ_TIMEOUT);
 
+        /**
+         * Feeds the parser with the bytes received and reads a package if it is complete, without waiting for the bytes still to come.
+         * Verifies the package received and if it's the same of the last received, it will re-send the last sent (that has to be the ack) 
+         * 
+         * @param[out]  package package to fill up
+         * @return  true: package read correctly; false: no complete package yet
+         */
+        bool pollPackage(IPackage* package);
+
+        /**
+         * Feeds the parser with the bytes received, keeps the packages of protocol version 3 in their window, sends their
+         * selective ack once the Host stops sending and sends again the packages whose ack is late. It never waits.
+         */
+        void update();
+
+        /**
+         * Discards the bytes received and the packages not read yet, as on a new connection: the next package of protocol
+         * version 3 is expected with sequence number 0.
+         */
+        void discardReceived();
+
         /**
          * Sends a package.
          * 
@@ -70,6 +119,22 @@ namespace robotieee {
          */
         bool sendPackage(IPackage* package);
 
+        /**
+         * Sends a package the Host doesn't acknowledge (e.g. the traces, see trace.hpp): it is written once, after the
+         * telemetry being streamed, in a frame from protocol version 4 on.
+         * 
+         * @param[in]   package package to send
+         * @return  true: the package written; false: its payload is longer than a message
+         */
+        bool sendWithoutAck(IPackage* package);
+
+        /**
+         * Gets the protocol version the Host speaks.
+         * 
+         * @return  the protocol version of the last package read; PROTOCOL_VERSION before the first one
+         */
+        uint8_t getLinkVersion();
+
         /** 
          * Dispose the object
          */
@@ -87,6 +152,18 @@ namespace robotieee {
          */
         static IPackage* initAcknowledge(IPackage* package, IMessage* message = nullptr);
 
+        /**
+         * Prepares an acknowledge package with a message given by its parts.
+         * Unlike the arguments of a message, \p args may contain '\0' characters (e.g. a coordinate 0).
+         * 
+         * @param[in]   package     package to send the acknowledge for
+         * @param[in]   type        type of the message; '\0' for an acknowledge without message
+         * @param[in]   args        arguments of the message
+         * @param[in]   argsLength  number of characters of \p args, at most ARGS_LENGHT
+         * @return  the acknowledge package
+         */
+        static IPackage* initAcknowledge(IPackage* package, char type, const char* args, uint8_t argsLength);
+
         /**
          * Prepares an acknowledge package with block found message.
          * 
@@ -99,6 +176,7 @@ namespace robotieee {
         
         /**
          * Prepares an acknowledge package with more than one block found message.
+         * Only the first MAX_ACK_BLOCKS blocks are included.
          * 
          * @param[in]   package     package to send the acknowledge for
          * @param[in]   robotPos    robot position
@@ -139,11 +217,63 @@ namespace robotieee {
         CommunicationPackage lastReceived;
         /** Boolean to know if one package has been received */
         bool receivedOnePackage;
+        /** Splits the bytes received into packages */
+        PackageParser parser;
+        /** Packages of protocol version 3 received and not read yet */
+        PackageWindow receiveWindow;
+        /** Packages of protocol version 3 sent and not acknowledged yet */
+        PackageWindow sendWindow;
+        /** Sequence number of the next package of protocol version 3 to send */
+        uint8_t nextSequence;
+        /** Boolean to know if the Host has to be told which packages of protocol version 3 have been received */
+        bool selectiveAckDue;
+        /** Protocol version of the last package of the sliding window received, used for the selective acks */
+        uint8_t windowVersion;
         
         /**
          * Initialize the object
          */
         BluetoothAsSerial();
+
+        /**
+         * Handles a package of protocol version 3 received.
+         * 
+         * @param[in]   frame   the package, as it came on the link
+         */
+        void receiveWindowed(const uint8_t* frame);
+
+        /**
+         * Removes from the send window the packages acknowledged by an ack of protocol version 3.
+         * 
+         * @param[in]   frame   the ack, as it came on the link
+         */
+        void acknowledgeWindowed(const uint8_t* frame);
+
+        /**
+         * Sends a package of protocol version 3, answers included, waiting only if the send window is full.
+         * 
+         * @param[in]   package package to send. Its ID is set to the next sequence number
+         * @return  true: the package sent; false: the package doesn't fit in the window
+         */
+        bool sendWindowed(IPackage* package);
+
+        /**
+         * Sends the selective ack of the packages of protocol version 3 received.
+         */
+        void sendSelectiveAck();
+
+        /**
+         * Sends again the packages of the send window whose ack is late.
+         */
+        void retransmit();
+
+        /**
+         * Writes a package on Serial1, after the telemetry being streamed, in a frame from protocol version 4 on.
+         * 
+         * @param[in]   frame   the package
+         * @param[in]   length  the bytes of the package
+         */
+        void write(const uint8_t* frame, uint8_t length);
     };
 }
 
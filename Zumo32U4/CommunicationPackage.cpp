@@ -12,11 +12,17 @@ using namespace robo_utils;
 namespace robotieee {
 
     #define ID_INT_BITMASK                      0x1         //00000001
+    #define SEQUENCE_BITMASK                    0xFF        //11111111
     #define ID_APPLICATION_ZERO_BITMASK         0xFFFE      //11111111 11111110
     #define ID_APPLICATION_ONE_BITMASK          0x0001      //00000000 00000001
     #define VERSION_APPLICATION_ZERO_BITMASK    0xF0FF      /*11110000 11111111*/
     #define VERSION_APPLICATION_ONE_BITMASK     0xF00       /*00001111 00000000*/
 
+    /* The slots of the packages allocated with new */
+    alignas(CommunicationPackage) static uint8_t pool[PACKAGE_POOL_SIZE][sizeof(CommunicationPackage)];
+    /* true if the slot with the same index in pool holds a package */
+    static bool poolUsed[PACKAGE_POOL_SIZE];
+
     CommunicationPackage::CommunicationPackage(uint8_t version, uint8_t id, uint8_t payloadLength, char type) : CommunicationPackage() {
         setVersion(version);
         setID(id);
@@ -29,7 +35,6 @@ namespace robotieee {
         _flags = 0;
         _payloadLength = 0;
         _type = '\0';
-        _payload = new string<MAX_PAYLOAD_LENGTH>{};
     }
 
     void CommunicationPackage::setVersion(uint8_t version) {
@@ -64,27 +69,30 @@ namespace robotieee {
         return _type;
     }
     
-    void CommunicationPackage::setPayload(string<MAX_PAYLOAD_LENGTH>* payload) {
-        if (payload == nullptr)
+    void CommunicationPackage::setPayload(string<PACKAGE_PAYLOAD_LENGTH>* payload) {
+        if (payload == nullptr || payload == &_payload)
             return;
 
-        delete(_payload);
-        _payload = new string<MAX_PAYLOAD_LENGTH>{};
+        _payload.clear();
         for(int i = 0; i < payload->getSize(); i++)
-            _payload->append(payload->getBuffer()[i]);
+            appendToPayload(payload->getBuffer()[i]);
     }
 
     bool CommunicationPackage::appendToPayload(char data) {
-        return _payload->append(data);
+        //the last character of the buffer is left to the terminator
+        if (_payload.getSize() >= PACKAGE_PAYLOAD_LENGTH - 1)
+            return false;
+
+        return _payload.append(data);
     }
 
-    string<MAX_PAYLOAD_LENGTH>* CommunicationPackage::getPayload() {
-        return _payload;
+    string<PACKAGE_PAYLOAD_LENGTH>* CommunicationPackage::getPayload() {
+        return &_payload;
     }
     
     void CommunicationPackage::getPayloadAsMessage(IMessage* payload) {
-        payload->setType(_payload->getBuffer()[0]);
-        payload->setArgs((char*)_payload->getBuffer() + 1);
+        payload->setType(_payload.getBuffer()[0]);
+        payload->setArgs((char*)_payload.getBuffer() + 1);
     }
 
     void CommunicationPackage::clone(IPackage* package) {
@@ -98,11 +106,11 @@ namespace robotieee {
     
     bool CommunicationPackage::verify(uint8_t protocolVersion /* = NO_VERIFY_VERSION_VALUE */) {
         //Check the version
-        if (protocolVersion != NO_VERIFY_VERSION_VALUE && getVersion() != protocolVersion)
+        if (protocolVersion != (uint8_t)NO_VERIFY_VERSION_VALUE && getVersion() != protocolVersion)
             return false;
 
-        //Check the id
-        if (getID() != 0 && getID() != 1)
+        //Check the id: from SEQUENCE_PROTOCOL_VERSION on, any value is a sequence number
+        if (getVersion() < SEQUENCE_PROTOCOL_VERSION && getID() != 0 && getID() != 1)
             return false;
 
         //Check the type
@@ -132,42 +140,74 @@ namespace robotieee {
 
     string<MAX_PACKAGE_LENGTH>* CommunicationPackage::toString() {
         string<MAX_PACKAGE_LENGTH>* data = new string<MAX_PACKAGE_LENGTH>{};
-        uint8_t byteToAppend = 0;
-        uint16_t tmpMask = _flags;
 
-        byteToAppend = getVersion()<<(8/*bit in a byte*/-VERSION_BIT_LENGTH);
-        //Applaing flags if value is 1
-        tmpMask = _flags;
-        tmpMask &= VERSION_APPLICATION_ONE_BITMASK;
-        tmpMask >>= 8/*bit in a byte*/;
-        byteToAppend |= (uint8_t)(tmpMask);
-        //Applaing flags if value is 0
-        tmpMask = _flags;
-        tmpMask |= VERSION_APPLICATION_ZERO_BITMASK;
-        tmpMask >>= 8/*bit in a byte*/;
-        byteToAppend &= (uint8_t)(tmpMask);
+        toString(data);
+        return data;
+    }
 
-        data->append((char)byteToAppend);
+    void CommunicationPackage::toString(string<MAX_PACKAGE_LENGTH>* data) {
+        uint8_t header[PACKAGE_HEADER_BYTE_LENGTH];
 
-        byteToAppend = (uint8_t)_flags;
-        data->append((char)byteToAppend);
+        data->clear();
 
-        data->append((char)_payloadLength);
-        data->append(_type);
+        serializeHeader(header);
+        for(uint8_t i = 0; i < PACKAGE_HEADER_BYTE_LENGTH; i++)
+            data->append((char)header[i]);
 
         //data->append(&_payload);
-        for(int i = 0; i < _payload->getSize(); i++)
-            data->append(_payload->getBuffer()[i]);
+        for(int i = 0; i < _payload.getSize(); i++)
+            data->append(_payload.getBuffer()[i]);
+    }
 
-        return data;
+    uint8_t CommunicationPackage::serializeHeader(uint8_t* buffer) {
+        encodeHeader(buffer, getVersion(), _flags, _payloadLength, _type);
+
+        return PACKAGE_HEADER_BYTE_LENGTH;
+    }
+
+    uint16_t CommunicationPackage::serialize(uint8_t* buffer) {
+        uint16_t length = serializeHeader(buffer);
+
+        memcpy(buffer + length, _payload.getBuffer(), _payload.getSize());
+
+        return length + _payload.getSize();
     }
     
     CommunicationPackage::~CommunicationPackage() {
-        delete(_payload);
+
+    }
+
+    void* CommunicationPackage::operator new(size_t size) noexcept {
+        //a derived class doesn't fit in the slots
+        if (size > sizeof(CommunicationPackage))
+            return nullptr;
+
+        for(uint8_t i = 0; i < PACKAGE_POOL_SIZE; i++) {
+            if (!poolUsed[i]) {
+                poolUsed[i] = true;
+                return pool[i];
+            }
+        }
+
+        return nullptr;
+    }
+
+    void CommunicationPackage::operator delete(void* pointer) {
+        for(uint8_t i = 0; i < PACKAGE_POOL_SIZE; i++) {
+            if (pointer == pool[i])
+                poolUsed[i] = false;
+        }
     }
 
     /* STATIC */
 
+    void CommunicationPackage::writeHeader(uint8_t* buffer, uint8_t version, uint8_t id, uint8_t payloadLength, char type) {
+        if (version >= SEQUENCE_PROTOCOL_VERSION)
+            encodeHeader(buffer, version, id, payloadLength, type);
+        else
+            encodeHeader(buffer, version, (id & ID_INT_BITMASK)<<(FLAG_ID_POSITION-1), payloadLength, type);
+    }
+
     bool CommunicationPackage::initFromString (IPackage* package, char* str) {
 
         if (package == nullptr)
@@ -175,7 +215,6 @@ namespace robotieee {
 
         uint8_t tmpByte = 0;
         char tmpType;
-        string<MAX_PAYLOAD_LENGTH>* tmpPayload = nullptr;
 
         tmpByte = getVersionFromString(str);
         if (tmpByte == STRING_PARSE_VERSION_ERROR)
@@ -197,11 +236,12 @@ namespace robotieee {
             return false;
         package->setType(tmpType);
 
-        tmpPayload = getPayloadFromString(str);
-        if (tmpPayload == STRING_PARSE_PAYLOAD_ERROR)
-            return false;
-        package->setPayload(tmpPayload);
-        delete(tmpPayload);
+        //copies the payload straight into the package
+        package->getPayload()->clear();
+        for(uint16_t i = PACKAGE_HEADER_BYTE_LENGTH; i < package->getPayloadLength() + PACKAGE_HEADER_BYTE_LENGTH; i++)
+            package->appendToPayload(str[i]);
+
+        return true;
     }
 
     uint8_t CommunicationPackage::getVersionFromString(char* str) {
@@ -213,9 +253,11 @@ namespace robotieee {
     }
 
     uint8_t CommunicationPackage::getIDFromString(char* str) {
-        uint16_t flags = ((uint8_t)str[0])<<8/*bit in a byte*/ | ((uint8_t)str[1]); //get the first 2 byte
-        
         if (str != nullptr) {
+            uint16_t flags = ((uint8_t)str[0])<<8/*bit in a byte*/ | ((uint8_t)str[1]); //get the first 2 byte
+
+            if (getVersionFromString(str) >= SEQUENCE_PROTOCOL_VERSION)
+                return flags & SEQUENCE_BITMASK;
             return (flags>>(FLAG_ID_POSITION-1)) & ID_INT_BITMASK;
         } else {
             return STRING_PARSE_ID_ERROR;
@@ -238,14 +280,14 @@ namespace robotieee {
         }
     }
 
-    string<MAX_PAYLOAD_LENGTH>* CommunicationPackage::getPayloadFromString(char* str) {
+    string<PACKAGE_PAYLOAD_LENGTH>* CommunicationPackage::getPayloadFromString(char* str) {
         uint8_t payloadLength = getPayloadLengthFromString(str);
 
         if (payloadLength != -1) {
-            string<MAX_PAYLOAD_LENGTH>* res = new string<MAX_PAYLOAD_LENGTH>{};
+            string<PACKAGE_PAYLOAD_LENGTH>* res = new string<PACKAGE_PAYLOAD_LENGTH>{};
             int i = 0;
             
-            for(i = PACKAGE_HEADER_BYTE_LENGTH; i < payloadLength + PACKAGE_HEADER_BYTE_LENGTH; i++)
+            for(i = PACKAGE_HEADER_BYTE_LENGTH; i < payloadLength + PACKAGE_HEADER_BYTE_LENGTH && res->getSize() < PACKAGE_PAYLOAD_LENGTH - 1; i++)
                 res->append(str[i]);
             
             return res;
@@ -256,9 +298,39 @@ namespace robotieee {
 
     /* PRIVATE */
 
+    void CommunicationPackage::encodeHeader(uint8_t* buffer, uint8_t version, uint16_t flags, uint8_t payloadLength, char type) {
+        uint8_t byteToAppend = 0;
+        uint16_t tmpMask = flags;
+
+        byteToAppend = version<<(8/*bit in a byte*/-VERSION_BIT_LENGTH);
+        //Applaing flags if value is 1
+        tmpMask = flags;
+        tmpMask &= VERSION_APPLICATION_ONE_BITMASK;
+        tmpMask >>= 8/*bit in a byte*/;
+        byteToAppend |= (uint8_t)(tmpMask);
+        //Applaing flags if value is 0
+        tmpMask = flags;
+        tmpMask |= VERSION_APPLICATION_ZERO_BITMASK;
+        tmpMask >>= 8/*bit in a byte*/;
+        byteToAppend &= (uint8_t)(tmpMask);
+
+        buffer[0] = byteToAppend;
+        buffer[1] = (uint8_t)flags;
+        buffer[2] = payloadLength;
+        buffer[3] = (uint8_t)type;
+    }
+
     void CommunicationPackage::setIDFromInt(uint8_t id) {
         uint16_t settingMask = 0;
         uint16_t idMask = id;
+
+        //the sequence number takes the whole second byte
+        if (getVersion() >= SEQUENCE_PROTOCOL_VERSION) {
+            _flags = (_flags & ~SEQUENCE_BITMASK) | id;
+            return;
+        }
+        //clears what is left of a sequence number
+        _flags &= ~SEQUENCE_BITMASK;
         
         /*Example: 
         id start from yyyyyyyx,
@@ -280,6 +352,9 @@ namespace robotieee {
     uint8_t CommunicationPackage::getIDAsInt() {
         uint16_t idMask = _flags;
 
+        if (getVersion() >= SEQUENCE_PROTOCOL_VERSION)
+            return idMask & SEQUENCE_BITMASK;
+
         idMask >>= FLAG_ID_POSITION-1;  //Shift the id to the first right bit
         idMask &= ID_INT_BITMASK;       //Select only the first right bit of the integer
 
@@ -30,6 +30,8 @@ namespace robotieee {
     #define FLAG_ID_POSITION                    1
     /* number of bit that the version needs in the first byte */
     #define VERSION_BIT_LENGTH                  4
+    /* first protocol version where the ID is a sequence number filling the second byte of the header, instead of a single bit */
+    #define SEQUENCE_PROTOCOL_VERSION           3
 
     /* Value returned by the parsing to extract version */
     #define STRING_PARSE_VERSION_ERROR          -1
@@ -42,10 +44,17 @@ namespace robotieee {
     /* Value returned by the parsing to extract payload */
     #define STRING_PARSE_PAYLOAD_ERROR          nullptr
 
+    /* Number of packages that can be allocated with new at the same time (see CommunicationPackage::operator new). The ack
+       BluetoothAsSerial::sendPackage waits for is not among them: the sketch may hold both slots while it sends */
+    #define PACKAGE_POOL_SIZE                   2
+
     /**
      * Implements IPackage interface.
      * Represents the package in the communication between Host and Robot.
      * Suitable for implementations of second version protocol onwards.
+     * 
+     * The payload is stored inside the package and the packages created with new are placed in a static pool of
+     * PACKAGE_POOL_SIZE packages, so reading, acknowledging and sending a package never use the heap.
      */
     class CommunicationPackage : public IPackage {
     public:
@@ -80,7 +89,7 @@ namespace robotieee {
         uint8_t getVersion();
         
         /**
-         * Sets the ID of the package.
+         * Sets the ID of the package. Set the version first: the ID is a single bit before SEQUENCE_PROTOCOL_VERSION.
          * 
          * @param[in]   id  package ID
          */
@@ -126,13 +135,13 @@ namespace robotieee {
          * 
          * @param[in]  payload reference to the data
          */
-        void setPayload(string<MAX_PAYLOAD_LENGTH>* payload);
+        void setPayload(string<PACKAGE_PAYLOAD_LENGTH>* payload);
 
         /**
          * Append a single character to the payload of the package.
          * 
          * @param[in]  data character to append to the payload
-         * @return  the result of the operation
+         * @return  the result of the operation; false if the payload already holds PACKAGE_PAYLOAD_LENGTH - 1 characters
          */
         bool appendToPayload(char data);
 
@@ -141,7 +150,7 @@ namespace robotieee {
          * 
          * @return  package payload reference
          */
-        string<MAX_PAYLOAD_LENGTH>* getPayload();
+        string<PACKAGE_PAYLOAD_LENGTH>* getPayload();
         
         /**
          * Gets the payload of the package masked as an compositeAction object.
@@ -181,13 +190,63 @@ namespace robotieee {
          */
         string<MAX_PACKAGE_LENGTH>* toString();
 
+        /**
+         * Codes the package data into a string given by the caller, without allocating anything.
+         * 
+         * @param[out]  data    the string to fill up. Its previous content is lost
+         */
+        void toString(string<MAX_PACKAGE_LENGTH>* data);
+
+        /**
+         * Writes the header of the package, as it goes on the link, into a buffer given by the caller.
+         * 
+         * @param[out]  buffer  the buffer to fill up, at least PACKAGE_HEADER_BYTE_LENGTH bytes long
+         * @return  the number of bytes written
+         */
+        uint8_t serializeHeader(uint8_t* buffer);
+
+        /**
+         * Writes the whole package, as it goes on the link, into a buffer given by the caller.
+         * 
+         * @param[out]  buffer  the buffer to fill up, at least MAX_PACKAGE_LENGTH bytes long
+         * @return  the number of bytes written
+         */
+        uint16_t serialize(uint8_t* buffer);
+
         /**
          * dispose the receiver
          */
         ~CommunicationPackage();
 
+        /**
+         * Places a new package in a free slot of the static pool.
+         * 
+         * @param[in]   size    the size of the object to allocate
+         * @return  the slot for the package; nullptr if the pool is full, so the new expression returns nullptr
+         */
+        static void* operator new(size_t size) noexcept;
+
+        /**
+         * Gives the slot of a deleted package back to the static pool.
+         * 
+         * @param[in]   pointer the slot of the package
+         */
+        static void operator delete(void* pointer);
+
         //STATIC
 
+        /**
+         * Writes the header of a package without building the package: useful when the payload is already in
+         * the buffer, after the header.
+         * 
+         * @param[out]  buffer          the buffer to fill up, at least PACKAGE_HEADER_BYTE_LENGTH bytes long
+         * @param[in]   version         protocol version
+         * @param[in]   id              package id
+         * @param[in]   payloadLength   payload length
+         * @param[in]   type            package type
+         */
+        static void writeHeader(uint8_t* buffer, uint8_t version, uint8_t id, uint8_t payloadLength, char type);
+
         /**
          * Initialize a package from string.
          * 
@@ -231,17 +290,28 @@ namespace robotieee {
 
         /**
          * Extract the payload from a package in string form.
-         * NB: the string has to be deallocated after the use.
+         * NB: the string has to be deallocated after the use. CommunicationPackage::initFromString doesn't need it.
          * 
          * @param[in]   str string of data
          * @return  payload; STRING_PARSE_PAYLOAD_ERROR if it is not possible
          */
-        static string<MAX_PAYLOAD_LENGTH>* getPayloadFromString(char* str);
+        static string<PACKAGE_PAYLOAD_LENGTH>* getPayloadFromString(char* str);
 
     private:
 
         /* METHOD */
 
+        /**
+         * Writes a header into a buffer.
+         * 
+         * @param[out]  buffer          the buffer to fill up, at least PACKAGE_HEADER_BYTE_LENGTH bytes long
+         * @param[in]   version         protocol version
+         * @param[in]   flags           utility flags, with the package ID
+         * @param[in]   payloadLength   payload length
+         * @param[in]   type            package type
+         */
+        static void encodeHeader(uint8_t* buffer, uint8_t version, uint16_t flags, uint8_t payloadLength, char type);
+
         /** 
          * Sets the ID from integer.
          * 
@@ -44,6 +44,20 @@ namespace robotieee {
          */
         virtual bool waitForPackage(IPackage* package, uint16_t timeout = DEFAULT_READ_TIMEOUT) = 0;
 
+        /**
+         * Reads a package if it has already been received, without waiting for the bytes still to come.
+         * 
+         * @param[out]  package package to fill up
+         * @return  true: package read correctly; false: no complete package yet
+         */
+        virtual bool pollPackage(IPackage* package) = 0;
+
+        /**
+         * Reads the bytes received and sends what the protocol needs (acks, retransmissions), without waiting.
+         * Call it often, even while the package read is being executed.
+         */
+        virtual void update() = 0;
+
         /**
          * Sends an acknowledge package.
          * If specified, it include the message in the package.
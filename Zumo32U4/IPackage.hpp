@@ -25,6 +25,8 @@ namespace robotieee {
     #define MAX_PAYLOAD_LENGTH          255 + 1
     /* Max length of a package */
     #define MAX_PACKAGE_LENGTH          PACKAGE_HEADER_BYTE_LENGTH + MAX_PAYLOAD_LENGTH
+    /* Payload kept inside a package: the longest one sent or accepted (a message) + 1 for the terminator */
+    #define PACKAGE_PAYLOAD_LENGTH      (MAX_MESSAGE_LENGTH + 1)
 
     /* Value to inibite the version check in the verify method */
     #define NO_VERIFY_VERSION_VALUE     -1
@@ -100,7 +102,7 @@ namespace robotieee {
          * 
          * @param[in]  payload reference to the data
          */
-        virtual void setPayload(string<MAX_PAYLOAD_LENGTH>* payload) = 0;
+        virtual void setPayload(string<PACKAGE_PAYLOAD_LENGTH>* payload) = 0;
 
         /**
          * Append a single character to the payload of the package.
@@ -115,7 +117,7 @@ namespace robotieee {
          * 
          * @return  package payload reference
          */
-        virtual string<MAX_PAYLOAD_LENGTH>* getPayload() = 0;
+        virtual string<PACKAGE_PAYLOAD_LENGTH>* getPayload() = 0;
         
         /**
          * Gets the payload of the package masked as an compositeAction object.
@@ -155,6 +157,29 @@ namespace robotieee {
          */
         virtual string<MAX_PACKAGE_LENGTH>* toString() = 0;
 
+        /**
+         * Codes the package data into a string given by the caller, without allocating anything.
+         * 
+         * @param[out]  data    the string to fill up. Its previous content is lost
+         */
+        virtual void toString(string<MAX_PACKAGE_LENGTH>* data) = 0;
+
+        /**
+         * Writes the header of the package, as it goes on the link, into a buffer given by the caller.
+         * 
+         * @param[out]  buffer  the buffer to fill up, at least PACKAGE_HEADER_BYTE_LENGTH bytes long
+         * @return  the number of bytes written
+         */
+        virtual uint8_t serializeHeader(uint8_t* buffer) = 0;
+
+        /**
+         * Writes the whole package, as it goes on the link, into a buffer given by the caller.
+         * 
+         * @param[out]  buffer  the buffer to fill up, at least MAX_PACKAGE_LENGTH bytes long
+         * @return  the number of bytes written
+         */
+        virtual uint16_t serialize(uint8_t* buffer) = 0;
+
     protected:
         /* HEADER */
 
@@ -169,8 +194,8 @@ namespace robotieee {
 
         /* PAYLOAD */
 
-        /** payload content */
-        string<MAX_PAYLOAD_LENGTH>* _payload = nullptr;
+        /** payload content, stored inside the package so that it never needs the heap */
+        string<PACKAGE_PAYLOAD_LENGTH> _payload;
 
     };
 }
@@ -0,0 +1,217 @@
+/**
+ * @file    PackageParser.cpp
+ * 
+ * @date    Oct 19, 2026
+ * @author  agent
+ */
+
+#include "PackageParser.hpp"
+#include "CommunicationPackage.hpp"
+#include "BluetoothAsSerial.hpp"
+
+namespace robotieee {
+
+    PackageParser::PackageParser() {
+        _head = 0;
+        _tail = 0;
+        _discarded = 0;
+        reset();
+    }
+
+    bool PackageParser::feed(uint8_t data) {
+        uint32_t now = millis();
+
+        //a partial package with a lost byte would swallow the next package: discard it
+        if (_state != PS_HEADER || _received > 0) {
+            if (now - _lastByteTime > PARSER_BYTE_TIMEOUT) {
+                _discarded += _received;
+                _state = PS_HEADER;
+                _received = 0;
+            }
+        }
+        _lastByteTime = now;
+
+        switch (_state) {
+            case PS_HEADER:
+                //a delimiter where a header should start: a frame follows
+                if (_received == 0 && data == FRAME_DELIMITER) {
+                    _state = PS_FRAME;
+                    _frameTooLong = false;
+                    return false;
+                }
+
+                _header[_received++] = data;
+                if (!validHeader(_received)) {
+                    resynchronize();
+                    return false;
+                }
+                if (_received < PACKAGE_HEADER_BYTE_LENGTH)
+                    return false;
+
+                //the header is complete
+                if (available() == PARSER_QUEUE_SIZE) {
+                    _discarded += PACKAGE_HEADER_BYTE_LENGTH;
+                    _state = PS_SKIPPING;
+                } else {
+                    memcpy(_queue[_tail % PARSER_QUEUE_SIZE], _header, PACKAGE_HEADER_BYTE_LENGTH);
+                    _state = PS_PAYLOAD;
+                }
+                _received = 0;
+                break;
+
+            case PS_PAYLOAD:
+                _queue[_tail % PARSER_QUEUE_SIZE][PACKAGE_HEADER_BYTE_LENGTH + _received++] = data;
+                break;
+
+            case PS_SKIPPING:
+                _received++;
+                _discarded++;
+                break;
+
+            case PS_FRAME:
+                if (data == FRAME_DELIMITER)
+                    return endFrame();
+
+                if (_received < PARSER_MAX_FRAME_LENGTH)
+                    _frame[_received++] = data;
+                else
+                    _frameTooLong = true;
+                return false;
+        }
+
+        //checks if the payload is complete
+        if (_state != PS_HEADER && _received == CommunicationPackage::getPayloadLengthFromString((char*)_header)) {
+            if (_state == PS_PAYLOAD) {
+                commit();
+                return true;
+            }
+            _state = PS_HEADER;
+            _received = 0;
+        }
+
+        return false;
+    }
+
+    uint8_t PackageParser::available() {
+        return (uint8_t)(_tail - _head);
+    }
+
+    bool PackageParser::receiving() {
+        return (_state != PS_HEADER && _state != PS_FRAME) || _received > 0;
+    }
+
+    bool PackageParser::pop(IPackage* package) {
+        bool packageOk;
+
+        if (available() == 0)
+            return false;
+
+        packageOk = CommunicationPackage::initFromString(package, (char*)_queue[_head % PARSER_QUEUE_SIZE]);
+        _head++;
+
+        //the version has already been checked with the header
+        return packageOk && package->verify();
+    }
+
+    const uint8_t* PackageParser::peek() {
+        if (available() == 0)
+            return nullptr;
+
+        return _queue[_head % PARSER_QUEUE_SIZE];
+    }
+
+    void PackageParser::drop() {
+        if (available() > 0)
+            _head++;
+    }
+
+    void PackageParser::reset() {
+        _head = _tail;
+        _state = PS_HEADER;
+        _received = 0;
+        _lastByteTime = millis();
+    }
+
+    uint16_t PackageParser::getDiscarded() {
+        return _discarded;
+    }
+
+    /* PRIVATE */
+
+    bool PackageParser::validHeader(uint8_t length, bool framed /* = false */) {
+        if (length > 0) {
+            uint8_t version = CommunicationPackage::getVersionFromString((char*)_header);
+            //the packages of protocol version 4 on come only in frames
+            if (framed && (version < FRAMED_PROTOCOL_VERSION || version > MAX_PROTOCOL_VERSION))
+                return false;
+            if (!framed && (version < PROTOCOL_VERSION || version >= FRAMED_PROTOCOL_VERSION))
+                return false;
+        }
+
+        if (length > 2 && CommunicationPackage::getPayloadLengthFromString((char*)_header) > PARSER_MAX_PAYLOAD_LENGTH)
+            return false;
+
+        if (length > 3) {
+            switch (CommunicationPackage::getTypeFromString((char*)_header)) {
+                case PACKAGE_TYPE_ACKNOWLEDGE:
+                case PACKAGE_TYPE_COMMUNICATION:
+                case PACKAGE_TYPE_INSTRUCTION:
+                        break;
+
+                default:
+                        return false;
+            }
+        }
+
+        return true;
+    }
+
+    void PackageParser::resynchronize() {
+        while (_received > 0) {
+            //discards the first byte
+            memmove(_header, _header + 1, --_received);
+            _discarded++;
+
+            //the bytes left could be the beginning of the next header
+            if (validHeader(_received))
+                return;
+        }
+    }
+
+    bool PackageParser::endFrame() {
+        uint8_t length = _received;
+        uint16_t packageLength = 0;
+
+        //the frame ends and the next one starts from the same delimiter
+        _received = 0;
+
+        //two delimiters in a row
+        if (length == 0)
+            return false;
+
+        if (!_frameTooLong)
+            packageLength = frameDecode(_frame, length);
+
+        //corrupted, too long or not a package at all
+        if (packageLength < PACKAGE_HEADER_BYTE_LENGTH) {
+            _discarded += length;
+            return false;
+        }
+        memcpy(_header, _frame, PACKAGE_HEADER_BYTE_LENGTH);
+        if (!validHeader(PACKAGE_HEADER_BYTE_LENGTH, true) || packageLength != PACKAGE_HEADER_BYTE_LENGTH + CommunicationPackage::getPayloadLengthFromString((char*)_header) || available() == PARSER_QUEUE_SIZE) {
+            _discarded += length;
+            return false;
+        }
+
+        memcpy(_queue[_tail % PARSER_QUEUE_SIZE], _frame, packageLength);
+        commit();
+        _state = PS_FRAME;
+        return true;
+    }
+
+    void PackageParser::commit() {
+        _tail++;
+        _state = PS_HEADER;
+        _received = 0;
+    }
+}
@@ -0,0 +1,177 @@
+/**
+ * @file    PackageParser.hpp
+ * 
+ * API specifying a class that splits the bytes coming from the Host into packages, one byte at a time.
+ * Suitable for use with protocol version 2 onwards.
+ * 
+ * @date    Oct 19, 2026
+ * @author  agent
+ */
+
+#ifndef PACKAGE_PARSER_HPP_
+#define PACKAGE_PARSER_HPP_
+
+#include <Arduino.h>
+#include <stdint.h>
+#include "IPackage.hpp"
+#include "IMessage.hpp"
+#include "framing.hpp"
+
+namespace robotieee {
+
+    /* Max payload length of a package the robot accepts: the Host only sends messages and acknowledges */
+    #define PARSER_MAX_PAYLOAD_LENGTH   MAX_MESSAGE_LENGTH
+    /* Number of complete packages the parser keeps until they are read. Must be a power of 2 */
+    #define PARSER_QUEUE_SIZE           4
+    /* Millis without bytes after which a partial package is discarded */
+    #define PARSER_BYTE_TIMEOUT         50
+    /* Max bytes of a frame of protocol version 4 (see framing.hpp) */
+    #define PARSER_MAX_FRAME_LENGTH     FRAMED_LENGTH(PACKAGE_HEADER_BYTE_LENGTH + PARSER_MAX_PAYLOAD_LENGTH)
+
+    /**
+     * Splits the bytes coming from the Host into packages.
+     * 
+     * The parser is a state machine fed one byte at a time (see PackageParser::feed), so it never waits for the
+     * bytes still to come: the caller feeds the bytes available and goes on with its work.
+     * The complete packages are kept in a queue until they are read (see PackageParser::pop).
+     * 
+     * A byte that cannot start a header (version not understood, unknown type or a payload too long) is discarded, and a
+     * partial package is discarded after PARSER_BYTE_TIMEOUT millis without bytes: so the parser resynchronizes
+     * on the next package after garbage or a lost byte.
+     * 
+     * A FRAME_DELIMITER byte where a header should start begins a frame of protocol version 4 (see framing.hpp): the
+     * parser collects the bytes up to the next delimiter and keeps the package only if its CRC is right. It expects frames
+     * until PARSER_BYTE_TIMEOUT millis pass without bytes, so the Host should start each frame with a delimiter after a pause.
+     * 
+     * The queue has a single producer (feed) and a single consumer (pop), each with its own index, so feed can be
+     * called from an interrupt while the main loop calls pop.
+     */
+    class PackageParser {
+    public:
+
+        /**
+         * Initializes a parser waiting for the first header.
+         */
+        PackageParser();
+
+        /**
+         * Parses the next byte coming from the Host.
+         * 
+         * @param[in]   data    the byte to parse
+         * @return  true: the byte completes a package, now in the queue; false: otherwise
+         */
+        bool feed(uint8_t data);
+
+        /**
+         * Checks if there are complete packages in the queue.
+         * 
+         * @return  the number of packages in the queue
+         */
+        uint8_t available();
+
+        /**
+         * Checks if a package is being received.
+         * 
+         * @return  true: some bytes of a package have been parsed, but not all of them; false: otherwise
+         */
+        bool receiving();
+
+        /**
+         * Removes the oldest package from the queue.
+         * 
+         * @param[out]  package package to fill up
+         * @return  true: package read; false: the queue is empty
+         */
+        bool pop(IPackage* package);
+
+        /**
+         * Gets the oldest package of the queue, without removing it.
+         * 
+         * @return  the package, as it came from the Host; nullptr if the queue is empty
+         */
+        const uint8_t* peek();
+
+        /**
+         * Removes the oldest package of the queue, if any.
+         */
+        void drop();
+
+        /**
+         * Discards the partial package and every package in the queue.
+         */
+        void reset();
+
+        /**
+         * Gets the number of bytes discarded to resynchronize, including the packages that didn't fit in the queue.
+         * 
+         * @return  discarded bytes
+         */
+        uint16_t getDiscarded();
+
+    private:
+
+        /**
+         * States of the parser
+         */
+        enum parser_state {
+            /** Reading the header */
+            PS_HEADER,
+            /** Reading the payload into the queue */
+            PS_PAYLOAD,
+            /** Reading the payload of a package that doesn't fit in the queue */
+            PS_SKIPPING,
+            /** Reading a frame of protocol version 4, up to its delimiter */
+            PS_FRAME
+        };
+
+        /** Complete packages, as they come from the Host, and the one being parsed after them */
+        uint8_t _queue[PARSER_QUEUE_SIZE][PACKAGE_HEADER_BYTE_LENGTH + PARSER_MAX_PAYLOAD_LENGTH];
+        /** Packages read from the queue. Only pop changes it */
+        volatile uint8_t _head;
+        /** Packages put in the queue. Only feed changes it */
+        volatile uint8_t _tail;
+        /** Bytes of the header read */
+        uint8_t _header[PACKAGE_HEADER_BYTE_LENGTH];
+        /** Bytes of the frame read */
+        uint8_t _frame[PARSER_MAX_FRAME_LENGTH];
+        /** Boolean to know if the frame being read doesn't fit in _frame */
+        bool _frameTooLong;
+        /** State of the parser */
+        parser_state _state;
+        /** Bytes of the current part (header or payload) read */
+        uint8_t _received;
+        /** Millis when the last byte came */
+        uint32_t _lastByteTime;
+        /** Bytes discarded to resynchronize */
+        uint16_t _discarded;
+
+        /**
+         * Checks if the first bytes read can be the beginning of a header.
+         * 
+         * @param[in]   length  number of bytes of _header to check
+         * @param[in]   framed  true if the header comes from a frame, false if it comes as it is
+         * @return  true: they can be the beginning of a header; false: otherwise
+         */
+        bool validHeader(uint8_t length, bool framed = false);
+
+        /**
+         * Checks the frame read, up to its delimiter, and puts its package in the queue.
+         * 
+         * @return  true: the frame holds a package, now in the queue; false: otherwise
+         */
+        bool endFrame();
+
+        /**
+         * Discards the first byte of the header read, and then the following ones until they can be the
+         * beginning of a header.
+         */
+        void resynchronize();
+
+        /**
+         * Puts the package parsed in the queue and waits for the next header.
+         */
+        void commit();
+    };
+}
+
+#endif /* PACKAGE_PARSER_HPP_ */
@@ -0,0 +1,92 @@
+/**
+ * @file    PackageWindow.cpp
+ * 
+ * @date    Oct 19, 2026
+ * @author  agent
+ */
+
+#include "PackageWindow.hpp"
+
+namespace robotieee {
+
+    PackageWindow::PackageWindow() {
+        reset(0);
+    }
+
+    void PackageWindow::reset(uint8_t base) {
+        _base = base;
+        _present = 0;
+    }
+
+    uint8_t PackageWindow::getBase() {
+        return _base;
+    }
+
+    bool PackageWindow::contains(uint8_t sequence) {
+        return (uint8_t)(sequence - _base) < WINDOW_SIZE;
+    }
+
+    bool PackageWindow::isPresent(uint8_t sequence) {
+        return contains(sequence) && (_present & (1 << slotOf(sequence)));
+    }
+
+    bool PackageWindow::put(uint8_t sequence, const uint8_t* frame, uint8_t length) {
+        if (!contains(sequence) || length > WINDOW_FRAME_LENGTH)
+            return false;
+
+        memcpy(_frames[slotOf(sequence)], frame, length);
+        _lengths[slotOf(sequence)] = length;
+        _present |= 1 << slotOf(sequence);
+
+        return true;
+    }
+
+    const uint8_t* PackageWindow::get(uint8_t sequence) {
+        if (!isPresent(sequence))
+            return nullptr;
+
+        return _frames[slotOf(sequence)];
+    }
+
+    uint8_t PackageWindow::getLength(uint8_t sequence) {
+        if (!isPresent(sequence))
+            return 0;
+
+        return _lengths[slotOf(sequence)];
+    }
+
+    void PackageWindow::remove(uint8_t sequence) {
+        if (contains(sequence))
+            _present &= ~(1 << slotOf(sequence));
+    }
+
+    void PackageWindow::slide() {
+        remove(_base);
+        _base++;
+    }
+
+    uint8_t PackageWindow::getBitmap() {
+        uint8_t bitmap = 0;
+
+        for(uint8_t i = 0; i < WINDOW_SIZE; i++) {
+            if (isPresent(_base + i))
+                bitmap |= 1 << i;
+        }
+
+        return bitmap;
+    }
+
+    void PackageWindow::setSentTime(uint8_t sequence, uint16_t time) {
+        _sentTimes[slotOf(sequence)] = time;
+    }
+
+    uint16_t PackageWindow::getSentTime(uint8_t sequence) {
+        return _sentTimes[slotOf(sequence)];
+    }
+
+    /* PRIVATE */
+
+    uint8_t PackageWindow::slotOf(uint8_t sequence) {
+        return sequence % WINDOW_SIZE;
+    }
+}
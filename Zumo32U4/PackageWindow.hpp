@@ -0,0 +1,155 @@
+/**
+ * @file    PackageWindow.hpp
+ * 
+ * API specifying a class that keeps the packages of a sliding window, indexed by their sequence number.
+ * Suitable for use with protocol version 3 onwards.
+ * 
+ * @date    Oct 19, 2026
+ * @author  agent
+ */
+
+#ifndef PACKAGE_WINDOW_HPP_
+#define PACKAGE_WINDOW_HPP_
+
+#include <Arduino.h>
+#include <stdint.h>
+#include "IPackage.hpp"
+#include "PackageParser.hpp"
+
+namespace robotieee {
+
+    /* Number of packages in a window: how many packages can be sent before the first is acknowledged. At most 8 */
+    #define WINDOW_SIZE                 4
+    /* Max length of a package kept in a window */
+    #define WINDOW_FRAME_LENGTH         (PACKAGE_HEADER_BYTE_LENGTH + PARSER_MAX_PAYLOAD_LENGTH)
+
+    /**
+     * Keeps the packages whose sequence number is in [base, base + WINDOW_SIZE), as they go on the link.
+     * 
+     * The sequence numbers wrap around after 255, so a package belongs to the window if its distance from the
+     * base, modulo 256, is less than WINDOW_SIZE.
+     * The sender keeps there the packages not acknowledged yet, the receiver the packages received ahead of the
+     * ones delivered.
+     */
+    class PackageWindow {
+    public:
+
+        /**
+         * Initializes an empty window starting from sequence number 0.
+         */
+        PackageWindow();
+
+        /**
+         * Empties the window.
+         * 
+         * @param[in]   base    sequence number of the first package of the window
+         */
+        void reset(uint8_t base);
+
+        /**
+         * Gets the sequence number of the first package of the window.
+         * 
+         * @return  the sequence number
+         */
+        uint8_t getBase();
+
+        /**
+         * Checks if a sequence number belongs to the window.
+         * 
+         * @param[in]   sequence    the sequence number
+         * @return  true: the sequence number is in the window; false: otherwise
+         */
+        bool contains(uint8_t sequence);
+
+        /**
+         * Checks if the window holds a package.
+         * 
+         * @param[in]   sequence    the sequence number of the package
+         * @return  true: the package is in the window; false: otherwise
+         */
+        bool isPresent(uint8_t sequence);
+
+        /**
+         * Stores a package, as it goes on the link.
+         * 
+         * @param[in]   sequence    the sequence number of the package
+         * @param[in]   frame       the package
+         * @param[in]   length      the bytes of the package
+         * @return  true: package stored; false: the sequence number is not in the window or the package is too long
+         */
+        bool put(uint8_t sequence, const uint8_t* frame, uint8_t length);
+
+        /**
+         * Gets a package.
+         * 
+         * @param[in]   sequence    the sequence number of the package
+         * @return  the package, as it goes on the link; nullptr if it is not in the window
+         */
+        const uint8_t* get(uint8_t sequence);
+
+        /**
+         * Gets the length of a package.
+         * 
+         * @param[in]   sequence    the sequence number of the package
+         * @return  the bytes of the package; 0 if it is not in the window
+         */
+        uint8_t getLength(uint8_t sequence);
+
+        /**
+         * Removes a package. It doesn't move the window (see PackageWindow::slide).
+         * 
+         * @param[in]   sequence    the sequence number of the package
+         */
+        void remove(uint8_t sequence);
+
+        /**
+         * Moves the window forward by one package, removing the first one.
+         */
+        void slide();
+
+        /**
+         * Gets the packages held, one bit for each: bit i is set if the package base + i is in the window.
+         * 
+         * @return  the packages held
+         */
+        uint8_t getBitmap();
+
+        /**
+         * Sets when a package was last sent.
+         * 
+         * @param[in]   sequence    the sequence number of the package
+         * @param[in]   time        millis when it was sent
+         */
+        void setSentTime(uint8_t sequence, uint16_t time);
+
+        /**
+         * Gets when a package was last sent.
+         * 
+         * @param[in]   sequence    the sequence number of the package
+         * @return  millis when it was sent, truncated to 16 bits
+         */
+        uint16_t getSentTime(uint8_t sequence);
+
+    private:
+        /** The packages, in the slot of their sequence number modulo WINDOW_SIZE */
+        uint8_t _frames[WINDOW_SIZE][WINDOW_FRAME_LENGTH];
+        /** The length of the package in each slot */
+        uint8_t _lengths[WINDOW_SIZE];
+        /** When the package in each slot was last sent */
+        uint16_t _sentTimes[WINDOW_SIZE];
+        /** The packages held, one bit for each slot */
+        uint8_t _present;
+        /** Sequence number of the first package of the window */
+        uint8_t _base;
+
+        /**
+         * Gets the slot of a package.
+         * 
+         * @param[in]   sequence    the sequence number of the package
+         * @return  the slot index
+         */
+        uint8_t slotOf(uint8_t sequence);
+    };
+}
+
+#endif /* PACKAGE_WINDOW_HPP_ */
@@ -5,6 +5,22 @@ measure how much the robot has turned about its Z axis. */
 #include <Wire.h>
 #include "TurnSensor.h"
 
+// I2C address of the L3GD20H on the Zumo32U4
+#define GYRO_ADDRESS 0x6B
+
+// Time between two samples of the gyro at 800 Hz, in microseconds
+#define GYRO_SAMPLE_US 1250
+
+// Samples read from the FIFO in a single I2C transfer: each sample
+// takes 6 bytes and the Wire buffer holds 32 bytes.
+#define GYRO_SAMPLES_PER_READ 5
+
+// Bits of FIFO_CTRL and FIFO_SRC of the L3GD20H
+#define GYRO_FIFO_MODE_BYPASS 0b00000000
+#define GYRO_FIFO_MODE_STREAM 0b01000000
+#define GYRO_FIFO_OVERRUN 0b01000000
+#define GYRO_FIFO_LEVEL 0b00011111
+
 /* turnAngle is a 32-bit unsigned integer representing the amount
 the robot has turned since the last time turnSensorReset was
 called.  This is computed solely using the Z axis of the gyro, so
@@ -27,9 +43,13 @@ int16_t turnRate;
 // during calibration.
 int16_t gyroOffset;
 
+static void turnSensorConfigure();
+static void turnSensorStart();
+
 // This variable helps us keep track of how much time has passed
-// between readings of the gyro.
-uint16_t gyroLastUpdate = 0;
+// between readings of the gyro, to make up for the samples lost
+// when the FIFO overruns.
+uint32_t gyroLastUpdate = 0;
 
 /* This should be called in setup() to enable and calibrate the
 gyro.  It uses the LCD, yellow LED, and button A.  While the LCD
@@ -41,18 +61,7 @@ The digital zero-rate level of the L3GD20H gyro can be as high as
 that. */
 void turnSensorSetup()
 {
-  Wire.begin();
-  gyro.init();
-
-  // 800 Hz output data rate,
-  // low-pass filter cutoff 100 Hz
-  gyro.writeReg(L3G::CTRL1, 0b11111111);
-
-  // 2000 dps full scale
-  gyro.writeReg(L3G::CTRL4, 0b00100000);
-
-  // High-pass filter disabled
-  gyro.writeReg(L3G::CTRL5, 0b00000000);
+  turnSensorConfigure();
 
 # ifdef DEBUG_LCD
   lcd.clear();
@@ -86,6 +95,47 @@ void turnSensorSetup()
   lcd.clear();
 # endif
 
+  turnSensorStart();
+}
+
+/* Like turnSensorSetup, but reuses an offset measured by a previous
+calibration (e.g. stored in the EEPROM) instead of sampling the
+gyro for more than two seconds. */
+void turnSensorSetup(int16_t offset)
+{
+  turnSensorConfigure();
+  gyroOffset = offset;
+  turnSensorStart();
+}
+
+// Sets up the I2C bus and the gyro, with the FIFO still disabled.
+static void turnSensorConfigure()
+{
+  Wire.begin();
+  // The gyro supports fast mode I2C: at the default 100 kHz reading
+  // a sample takes about half the time between two samples.
+  Wire.setClock(400000);
+  gyro.init();
+
+  // 800 Hz output data rate,
+  // low-pass filter cutoff 100 Hz
+  gyro.writeReg(L3G::CTRL1, 0b11111111);
+
+  // 2000 dps full scale
+  gyro.writeReg(L3G::CTRL4, 0b00100000);
+
+  // High-pass filter disabled
+  gyro.writeReg(L3G::CTRL5, 0b00000000);
+}
+
+static void turnSensorStart()
+{
+  // From now on the gyro stores its samples in the FIFO, so no
+  // sample is lost between two calls of turnSensorUpdate (up to 32
+  // samples, 40 ms) and each one is integrated over the exact
+  // sampling period instead of the jittery time between two calls.
+  gyro.writeReg(L3G::CTRL5, 0b01000000);
+
   turnSensorReset();
 }
 
@@ -93,22 +143,19 @@ void turnSensorSetup()
 // a turn.  After calling this, turnAngle will be 0.
 void turnSensorReset()
 {
+  // Going through bypass mode empties the FIFO, so the samples
+  // taken before the reset are not integrated.
+  gyro.writeReg(L3G::FIFO_CTRL, GYRO_FIFO_MODE_BYPASS);
+  gyro.writeReg(L3G::FIFO_CTRL, GYRO_FIFO_MODE_STREAM);
   gyroLastUpdate = micros();
   turnAngle = 0;
 }
 
-// Read the gyro and update the angle.  This should be called as
-// frequently as possible while using the gyro to do turns.
-void turnSensorUpdate()
+// Integrates a sample of the gyro taken dt microseconds after the
+// previous one.
+static void turnSensorIntegrate(int16_t z, uint16_t dt)
 {
-  // Read the measurements from the gyro.
-  gyro.read();
-  turnRate = gyro.g.z - gyroOffset;
-
-  // Figure out how much time has passed since the last update (dt)
-  uint16_t m = micros();
-  uint16_t dt = m - gyroLastUpdate;
-  gyroLastUpdate = m;
+  turnRate = z - gyroOffset;
 
   // Multiply dt by turnRate in order to get an estimation of how
   // much the robot has turned since the last update.
@@ -123,5 +170,84 @@ void turnSensorUpdate()
   //
   // (0.07 dps/digit) * (1/1000000 s/us) * (2^29/45 unit/degree)
   // = 14680064/17578125 unit/(digit*us)
-  turnAngle += (int64_t)d * 14680064 / 17578125;
+  turnAngle += turnSensorScale(d);
+}
+
+// Read the samples queued in the FIFO of the gyro and update the
+// angle.  This should be called at least every 40 ms while using
+// the gyro to do turns; calling it more often only makes turnRate
+// fresher.
+void turnSensorUpdate()
+{
+  uint8_t source = gyro.readReg(L3G::FIFO_SRC);
+  uint8_t pending = source & GYRO_FIFO_LEVEL;
+  uint32_t m = micros();
+  uint32_t elapsed = m - gyroLastUpdate;
+  gyroLastUpdate = m;
+
+  // When the FIFO is full the oldest samples have been overwritten:
+  // the time the samples in the FIFO do not cover is integrated with
+  // the mean of the rates before and after the gap.
+  uint32_t lost = 0;
+  if (source & GYRO_FIFO_OVERRUN)
+  {
+    pending++;
+    if (elapsed > (uint32_t)pending * GYRO_SAMPLE_US)
+    {
+      lost = elapsed - (uint32_t)pending * GYRO_SAMPLE_US;
+      if (lost > 0xFFFF) { lost = 0xFFFF; }
+    }
+  }
+
+  uint8_t read = 0;
+  while (read < pending)
+  {
+    uint8_t count = pending - read;
+    if (count > GYRO_SAMPLES_PER_READ) { count = GYRO_SAMPLES_PER_READ; }
+
+    // With the FIFO enabled, the register address wraps from OUT_Z_H
+    // to OUT_X_L, so consecutive samples come in a single burst.
+    Wire.beginTransmission(GYRO_ADDRESS);
+    Wire.write(L3G::OUT_X_L | (1 << 7));
+    Wire.endTransmission();
+    Wire.requestFrom((uint8_t)GYRO_ADDRESS, (uint8_t)(count * 6));
+
+    for (uint8_t i = 0; i < count; i++)
+    {
+      // Only the Z axis is used: skip X and Y.
+      for (uint8_t b = 0; b < 4; b++) { Wire.read(); }
+      uint8_t zl = Wire.read();
+      uint8_t zh = Wire.read();
+      int16_t z = (int16_t)(zh << 8 | zl);
+
+      if (lost > 0)
+      {
+        turnSensorIntegrate((int16_t)(((int32_t)turnRate + gyroOffset + z) / 2), lost);
+        lost = 0;
+      }
+      turnSensorIntegrate(z, GYRO_SAMPLE_US);
+    }
+    read += count;
+  }
+}
+
+/* Converts d, in gyro digits times microseconds, to turnAngle units:
+it computes d * 14680064 / 17578125 without the 64-bit multiply and
+divide, which take hundreds of microseconds on the ATmega32U4.
+
+The factor is written in fixed point with 32 fractional bits,
+14680064/17578125 = (turnAngleScaleHigh + turnAngleScaleLow / 2^16) / 2^16,
+and d is split in its high and low 16 bits, so every product fits in
+32 bits.  The relative error of the factor is below 1e-10 and the
+result is within 2 units (about 1.7e-7 degrees) of the exact value. */
+int32_t turnSensorScale(int32_t d)
+{
+  // d = high * 2^16 + low, with 0 <= low < 2^16
+  int32_t high = d >> 16;
+  uint32_t low = (uint16_t)d;
+
+  // the fractional parts are rounded, so the errors of the samples do not add up
+  return high * (int32_t)turnAngleScaleHigh
+    + (int32_t)((low * turnAngleScaleHigh + 0x8000) >> 16)
+    + ((high * (int32_t)turnAngleScaleLow + 0x8000) >> 16);
 }
@@ -15,12 +15,21 @@ const int32_t turnAngle90 = turnAngle45 * 2;
 // This constant represents a turn of approximately 1 degree.
 const int32_t turnAngle1 = (turnAngle45 + 22) / 45;
 
+// The factor converting gyro digits times microseconds to turnAngle
+// units, 14680064/17578125, in fixed point with 32 fractional bits:
+// (turnAngleScaleHigh + turnAngleScaleLow / 2^16) / 2^16.
+const uint32_t turnAngleScaleHigh = 54731;
+const uint32_t turnAngleScaleLow = 16087;
+
 // These are defined in TurnSensor.cpp:
 void turnSensorSetup();
+void turnSensorSetup(int16_t offset);
 void turnSensorReset();
 void turnSensorUpdate();
+int32_t turnSensorScale(int32_t d);
 extern uint32_t turnAngle;
 extern int16_t turnRate;
+extern int16_t gyroOffset;
 
 // These objects must be defined in your sketch.
 extern Zumo32U4ButtonA buttonA;
@@ -2,6 +2,9 @@
 #define DEFAULT_ID 0 // Used as we do not care about blocks ids in this version of the code
 #define EXEC_PROTOCOL_VERSION  2
 #define ALWAYS_SEND_ROBOT_LOCATION
+#define MAX_FOUND_BLOCKS MAX_ACK_BLOCKS // The robot position and 4 blocks fill the arguments of a FOUND acknowledge
+#define MOTION_DEADLINE  5  // The milliseconds between two updates of the movement at most
+#define TASK_COUNT       (sizeof(tasks) / sizeof(tasks[0]))
 
 #include <Zumo32U4.h>
 #include "robot.hpp"
@@ -10,6 +13,9 @@
 #include "compositeAction.hpp"
 #include "ICommunicator.hpp"
 #include "BluetoothAsSerial.hpp"
+#include "trace.hpp"
+#include "telemetry.hpp"
+#include "scheduler.hpp"
 
 #include "string.hpp" //only for connection test
 
@@ -42,9 +48,10 @@ robot zumo_robot{(point) {0, 0}};
 /*
  * This function returns true if the block was found during the movement. If this happens a LOCATION message is sent
  * to the application and the rest of the cluster needs to be discarded as a new plan for the exploration needs to be
- * determined and comunicated by the application
+ * determined and comunicated by the application.
+ * When nextAction is a move in another direction, the robot turns towards it along an arc at the end of the movement.
  */
-bool handleMoveAction(compositeAction* action) {
+bool handleMoveAction(compositeAction* action, compositeAction* nextAction) {
   
   char* actionArgs = action->getArgs();
   enum object_movement direction = (actionArgs[0] - '0');
@@ -81,7 +88,15 @@ bool handleMoveAction(compositeAction* action) {
   else {
 
     if (actionArgs[1] == '0') {
-      zumo_robot.goAhead(action->getRepetition());
+      enum object_movement nextDirection = (nextAction->getArgs()[0] - '0');
+
+      // The next move starts on the line the arc ends on: its faceDirection does nothing
+      if (nextAction->getType() == HEADER_TYPE_MOVE && nextDirection != direction) {
+        zumo_robot.goAheadAndTurn(action->getRepetition(), nextDirection);
+      }
+      else {
+        zumo_robot.goAhead(action->getRepetition());
+      }
     }
     else if (actionArgs[1] == '1') {
       zumo_robot.pushBlock(action->getRepetition());
@@ -100,6 +115,7 @@ void doActivityVersion1() {
   char actionType;
   char* actionArgs;
   compositeAction currentAction;
+  compositeAction nextAction;
 
   bool foundBlock = false;
   uint16_t executedInstructions = 0;
@@ -108,11 +124,12 @@ void doActivityVersion1() {
   do {
     
     currentAction = bluetooth.getNextAction();
+    nextAction = bluetooth.peekNextAction();
     actionType = currentAction.getType();
     actionArgs = currentAction.getArgs();
 
     switch (actionType) {
-      case HEADER_TYPE_MOVE:    foundBlock = handleMoveAction(&currentAction);
+      case HEADER_TYPE_MOVE:    foundBlock = handleMoveAction(&currentAction, &nextAction);
                                 break;
       
       case HEADER_TYPE_STATE:   if (actionArgs[0] == 'S') {
@@ -155,116 +172,260 @@ void doActivityVersion1() {
 
 #if EXEC_PROTOCOL_VERSION >= 2
 /*
-This function manage the movement action and return the package to sent as responce to the host.
+The phases of a movement requested by the host: the robot first faces the direction of the movement, then moves.
 */
-IPackage* doMovement(IPackage* package, IMessage* action) {
-  IPackage* responce = nullptr; 
+enum movement_phase {
+  MP_NONE,
+  MP_TURNING,
+  MP_MOVING,
+};
+
+/* The phase of the movement the robot is executing */
+enum movement_phase movementPhase = MP_NONE;
+/* The package read from the host, kept until the movement it requests ends */
+CommunicationPackage packageRead;
+/* The message inside packageRead */
+compositeAction packageMessage;
+/* The ack to send to the host, nullptr if there is none */
+IPackage* pendingAck = nullptr;
+#ifdef TRACE
+/* When packageRead was received, in microseconds */
+uint32_t activityStart;
+/* True if the traces are sent after the ack */
+bool dumpTraces = false;
+#endif
+
+/*
+This function starts the movement action. The robot moves while updateMovement() is called.
+*/
+void startMovement(IMessage* action) {
   char* actionArgs = action->getArgs();
   enum object_movement direction = (actionArgs[0] - '0');
 
   //Make the robot face the requested direction of movement
-  zumo_robot.faceDirection(direction);
-  
-  /* 
-   * If the robot is still scanning it means it will not receive any PUSH command, so we
-   * simply move in the direction given, checking if we find the block
-   */
-  if (zumo_robot.isScanning()) {
-    
-    bool foundBlock = zumo_robot.goAhead(1, true);
+  zumo_robot.startFaceDirection(direction);
+  movementPhase = MP_TURNING;
+}
 
-    if (foundBlock) {
-      
-      //TODO: edit the block position with the new proximity management
-      // These two lines simply determines the position of the block: 1 cell ahead of the robot in the direction of the movement
-      block block(DEFAULT_ID, zumo_robot.position);
-      block.move(direction, 1);
+/*
+This function advances the movement action and, when the movement ends, return the package to sent as responce to the host.
+Before the end of the movement it returns nullptr.
+*/
+IPackage* updateMovement(IPackage* package, IMessage* action) {
+  IPackage* responce = nullptr; 
+  char* actionArgs = action->getArgs();
+  enum object_movement direction = (actionArgs[0] - '0');
 
-      responce = BluetoothAsSerial::initFoundAck(package, zumo_robot.position, block.position);
-    } else {
-      responce = BluetoothAsSerial::initNotFoundAck(package, zumo_robot.position);
-    }
+  if (zumo_robot.update()) {
+    return nullptr;
   }
-  else {
 
-    if (actionArgs[1] == '0') {
-      zumo_robot.goAhead(1);
-    }
-    else if (actionArgs[1] == '1') {
-      zumo_robot.pushBlock(1);
-    }
-    
-    responce = BluetoothAsSerial::initAcknowledge(package);
+  switch (movementPhase) {
+    case MP_TURNING:
+        movementPhase = MP_MOVING;
+
+        /* 
+         * If the robot is still scanning it means it will not receive any PUSH command, so we
+         * simply move in the direction given, checking if we find the block
+         */
+        if (zumo_robot.isScanning()) {
+          zumo_robot.startGoAhead(1, true);
+        }
+        else if (actionArgs[1] == '0') {
+          zumo_robot.startGoAhead(1);
+        }
+        else if (actionArgs[1] == '1') {
+          zumo_robot.startPushBlock(1);
+        }
+        break;
+
+    case MP_MOVING:
+        movementPhase = MP_NONE;
+
+        if (zumo_robot.isScanning()) {
+          // The robot is still on the intersection: besides the block that may have stopped it, it looks for the
+          // ones farther ahead and on its sides, so the host learns more of the map from a single movement
+          point blocks[MAX_FOUND_BLOCKS] = { point(0, 0), point(0, 0), point(0, 0), point(0, 0) };
+          // One place is kept for the block that stopped the robot
+          uint8_t blocksNum = zumo_robot.locateBlocks(blocks, MAX_FOUND_BLOCKS - 1);
+
+          // These two lines simply determines the position of the block: 1 cell ahead of the robot in the direction of the movement
+          block block(DEFAULT_ID, zumo_robot.position);
+          block.move(direction, 1);
+
+          // The block that stopped the robot is reported even if the last reading missed it
+          if (zumo_robot.getMotionResult() && (blocksNum == 0 || blocks[0] != block.position)) {
+            blocks[blocksNum++] = block.position;
+          }
+
+          if (blocksNum > 0) {
+            responce = BluetoothAsSerial::initFoundAck(package, zumo_robot.position, blocksNum, blocks);
+          } else {
+            responce = BluetoothAsSerial::initNotFoundAck(package, zumo_robot.position);
+          }
+        }
+        else {
+          responce = BluetoothAsSerial::initAcknowledge(package);
+        }
+        break;
+
+    case MP_NONE:
+        break;
   }
   
   return responce;
 }
 
 /*
-This fuction is the activity execution for second protocol version and on.
-Uses the interfaces ICommunicator, IPackage and IMessage to separate the program logic from the protocol used.
+The activity for the second protocol version and on is split into the tasks of the scheduler (see scheduler.hpp):
+none of them waits for the robot to stop, so the motors are controlled at a steady rate while the robot talks with the host.
+They use the interfaces ICommunicator, IPackage and IMessage to separate the program logic from the protocol used.
 
 NB: use directly the protocol implementation class only to init the package for the message to send.
 */
-void doActivity() {
-  bool foundBlock = false;
-  IPackage* packageRead = new CommunicationPackage();
-  IPackage* packageSent = nullptr;
-  IMessage* packageMessage = new compositeAction();
+
+/*
+Motion control task: advances the movement requested by the host. When the movement ends, its ack is left to ackTask().
+*/
+void motionTask() {
+  if (movementPhase != MP_NONE) {
+    IPackage* ack = updateMovement(&packageRead, &packageMessage);
+    if (ack != nullptr) {
+      pendingAck = ack;
+    }
+  }
+}
+
+#ifdef TELEMETRY
+/*
+Sensor sampling task: records the state of the robot in the telemetry.
+*/
+void samplingTask() {
+  zumo_robot.recordTelemetry();
+}
+#endif
+
+/*
+Link task: keeps reading the bytes from the host while the robot moves, so the host can send the next packages
+(protocol version 3) and get their acks without waiting for the robot to stop.
+*/
+void linkTask() {
+  bluetooth->update();
+}
+
+/*
+Receiving task: once the robot is still and the ack of the last package has been sent, reads the next package from the host
+and starts executing it.
+*/
+void receiveTask() {
+  if (movementPhase != MP_NONE || pendingAck != nullptr) {
+    return;
+  }
 
   //led red on: package waiting
   ledRed(true);
 
-  //wait for a package
-  while(!bluetooth->waitForPackage(packageRead));
+  //read a package only if the host has sent all of it
+  if (!bluetooth->pollPackage(&packageRead)) {
+    return;
+  }
 
   //led red off: package received
   ledRed(false);
 
+# ifdef TRACE
+  activityStart = micros();
+# endif
+
   //Exec only if the package is an instruction type
-  if(packageRead->getType() == PACKAGE_TYPE_INSTRUCTION) {
+  if(packageRead.getType() == PACKAGE_TYPE_INSTRUCTION) {
     //Extract the message from the payload
-    packageRead->getPayloadAsMessage(packageMessage);
+    packageRead.getPayloadAsMessage(&packageMessage);
 
     //Executing the message
-    switch(packageMessage->getType()) {
+    switch(packageMessage.getType()) {
       case MESSAGE_TYPE_MOVE:
-          packageSent = doMovement(packageRead, packageMessage);
-          /*//Init the package to send as ack
-          if (foundBlock) {
-            packageSent = BluetoothAsSerial::initFoundAck(packageRead, zumo_robot.position, block.position);
-          } else {
-            packageSent = BluetoothAsSerial::initNotFoundAck(packageRead, zumo_robot.position);
-          }*/
+          //the ack is prepared by motionTask once the robot stops
+          startMovement(&packageMessage);
           break;
-      
+
       case MESSAGE_TYPE_STATE_CHANGE:
-          if (packageMessage->getArgs()[0] == 'S') {
+          if (packageMessage.getArgs()[0] == 'S') {
             zumo_robot.setScanMode();
           }
-          else if (packageMessage->getArgs()[0] == 'E') {
+          else if (packageMessage.getArgs()[0] == 'E') {
             zumo_robot.setExecuteMode();
           }
 
           //Init the package to send as ack
-          packageSent = BluetoothAsSerial::initAcknowledge(packageRead);
+          pendingAck = BluetoothAsSerial::initAcknowledge(&packageRead);
+          break;
+
+#     ifdef TRACE
+      case MESSAGE_TYPE_TRACE:
+          //the traces follow the ack
+          pendingAck = BluetoothAsSerial::initAcknowledge(&packageRead);
+          dumpTraces = true;
           break;
+#     endif
     }
+  }
+}
+
+/*
+Ack task: sends to the host the ack prepared by the other tasks.
+*/
+void ackTask() {
+  if (pendingAck == nullptr) {
+    return;
+  }
+
+  bluetooth->sendPackage(pendingAck);
+  delete(pendingAck);
+  pendingAck = nullptr;
 
-    //sending the ack to host
-    bluetooth->sendPackage(packageSent);
+# ifdef TRACE
+  TRACE_END(TE_ACTIVITY, activityStart);
+  if (dumpTraces) {
+    traceDump(packageRead.getVersion());
+    dumpTraces = false;
   }
+# endif
+}
 
-  //Free memory
-  delete(packageMessage);
-  delete(packageRead);
-  delete(packageSent);
+#ifdef TELEMETRY
+/*
+Telemetry task: streams the telemetry while the host is not sending anything.
+*/
+void telemetryTask() {
+  if (!bluetooth->somethingToRead()) {
+    telemetryStream(BluetoothAsSerial::getInstance()->getLinkVersion());
+  }
 }
+#endif
+
+/*
+The tasks of the scheduler, in order of priority: the motion control comes first, so the line following runs at least
+every MOTION_DEADLINE milliseconds.
+*/
+struct scheduled_task tasks[] = {
+  // run,          period,             deadline,        nextRun, missed (set by schedulerStart)
+  { motionTask,    0,                  MOTION_DEADLINE, 0,       0 },
+# ifdef TELEMETRY
+  { samplingTask,  TELEMETRY_INTERVAL, 10,              0,       0 },
+# endif
+  { linkTask,      10,                 50,              0,       0 },
+  { receiveTask,   10,                 50,              0,       0 },
+  { ackTask,       0,                  50,              0,       0 },
+# ifdef TELEMETRY
+  { telemetryTask, 20,                 100,             0,       0 },
+# endif
+};
 
 void testConnectionClass() {
   CommunicationPackage* pSent = nullptr;
   CommunicationPackage* pRead = new CommunicationPackage();
-  string<MAX_PAYLOAD_LENGTH> payload = string<MAX_PAYLOAD_LENGTH>{"Per me e' la cipolla"};
+  string<PACKAGE_PAYLOAD_LENGTH> payload = string<PACKAGE_PAYLOAD_LENGTH>{"La cipolla"};
 
   BluetoothAsSerial::jumpByte(42); //length of 'Bluetooth device connected at 00:00:00.000' string sent by btTerminal on connection
 
@@ -294,7 +455,7 @@ void testConnectionClass() {
     bluetooth->sendPackage(pSent);
 
     delete(pSent);
-    pSent = new CommunicationPackage(PROTOCOL_VERSION, 0x0, 20, PACKAGE_TYPE_COMMUNICATION);
+    pSent = new CommunicationPackage(PROTOCOL_VERSION, 0x0, 10, PACKAGE_TYPE_COMMUNICATION);
     pSent->setPayload(&payload);
     //package isn't an ack -> robot will wait for the responce, if not received in 1 minute and half it will re-send the package
     bluetooth->sendPackage(pSent);
@@ -302,12 +463,12 @@ void testConnectionClass() {
 
   /*
   Test example:
-  package to send in string: ' ç"CIl robot parla e dice: ciao mondo!'
+  package to send in string: ' ç' + VT + 'Cciao mondo!'
   version: 2
   id: 1
-  payload length: 34
+  payload length: 11
   type: C
-  payload: 'Il robot parla e dice: ciao mondo!'
+  payload: 'ciao mondo!'
 
   if the robot will receive it correctly will return:
   empty ack, string: ' ç' + '\0' + A' byte: 0x20 0x80 0x00 0x41 (version: 2; id: 1; pLength: 0; type: A)
@@ -315,9 +476,9 @@ void testConnectionClass() {
   not found ack, string: ' ç' + EOT + 'AaA' byte: 0x20 0x80 0x04 0x41 0x91 0x41 (version: 2; id: 1; pLength: 0; type: A; payload: aA)
 
   the will send a package like 
-  string: ' ' + '\0' + DC4 + 'CPer me e' la cipolla'
-  byte: 0x20 0x00 0x14 0x43 0x50 0x65 0x72 0x20 0x6d 0x65 0x20 0x65 0x2c 0x20 0x6c 0x61 0x20 0x63 0x69 0x70 0x6f 0x6c 0x6c 0x61
-  (version: 2; id: 0; pLength: 20; type: C; payload: Per me e' la cipolla)
+  string: ' ' + '\0' + LF + 'CLa cipolla'
+  byte: 0x20 0x00 0x0a 0x43 0x4c 0x61 0x20 0x63 0x69 0x70 0x6f 0x6c 0x6c 0x61
+  (version: 2; id: 0; pLength: 10; type: C; payload: La cipolla)
 
   and expect an ack like:
   string: ' ' + '\0' + '\0' + 'A'
@@ -361,6 +522,10 @@ void setup() {
 #endif
 
   zumo_robot.setScanMode();
+
+# if EXEC_PROTOCOL_VERSION >= 2
+  schedulerStart(tasks, TASK_COUNT);
+# endif
 }
 
 void loop() {
@@ -368,8 +533,8 @@ void loop() {
   #if EXEC_PROTOCOL_VERSION == 1
     doActivityVersion1();
   #elif EXEC_PROTOCOL_VERSION >= 2
-    //doActivity();
-    testConnectionClass();
+    schedulerRun(tasks, TASK_COUNT);
+    //testConnectionClass();
   #endif
 
 }
@@ -216,6 +216,15 @@ namespace robotieee {
         }
     }
 
+    compositeAction actionComunicator::peekNextAction() {
+        if (_clusterIndex < _actionsOnCluster) {
+            return _cluster[_clusterIndex];
+        }
+        else {
+            return compositeAction();
+        }
+    }
+
     bool actionComunicator::isClusterEmpty() {
       return _actionsOnCluster <= 0;
     }
@@ -89,6 +89,14 @@ namespace robotieee {
          */
         compositeAction getNextAction();
 
+        /**
+         * Returns the action getNextAction will return, without moving past it.
+         * NB: if there's no action to return, it returns an empty action with type = '\0'
+         * 
+         * @return action to execute after the current one
+         */
+        compositeAction peekNextAction();
+
         /**
          * Returns if the last cluster read is empty or not.
          * 
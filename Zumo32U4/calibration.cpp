@@ -0,0 +1,45 @@
+/*
+   calibration.cpp
+
+    Created on: Oct 19, 2026
+        Author: agent
+*/
+#include "calibration.hpp"
+#include <EEPROM.h>
+#include <stddef.h>
+
+/**
+ * where the calibration is stored in the EEPROM
+ */
+#define CALIBRATION_ADDRESS 0
+/**
+ * the magic number of the current layout of robotieee::calibration_data. Change it when the layout changes
+ */
+#define CALIBRATION_MAGIC   0x5A01
+
+namespace robotieee {
+
+  bool loadCalibration(struct calibration_data& data) {
+    EEPROM.get(CALIBRATION_ADDRESS, data);
+    return data.magic == CALIBRATION_MAGIC && data.checksum == calibrationChecksum(data);
+  }
+
+  void saveCalibration(struct calibration_data& data) {
+    data.magic = CALIBRATION_MAGIC;
+    data.checksum = calibrationChecksum(data);
+    EEPROM.put(CALIBRATION_ADDRESS, data);
+  }
+
+  uint16_t calibrationChecksum(const struct calibration_data& data) {
+    const uint8_t* bytes = (const uint8_t*) &data;
+    uint16_t sum1 = 0;
+    uint16_t sum2 = 0;
+
+    for (size_t i = 0; i < offsetof(struct calibration_data, checksum); i++) {
+      sum1 = (sum1 + bytes[i]) % 255;
+      sum2 = (sum2 + sum1) % 255;
+    }
+    return (sum2 << 8) | sum1;
+  }
+
+}
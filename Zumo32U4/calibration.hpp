@@ -0,0 +1,70 @@
+/**
+ * @file
+ *
+ * Calibration of the sensors stored in the EEPROM, so that the robot can skip the calibration at boot
+ *
+ * @date Oct 19, 2026
+ * @author agent
+ */
+
+#ifndef CALIBRATION_HPP_
+#define CALIBRATION_HPP_
+
+#include <stdint.h>
+
+namespace robotieee {
+
+/**
+ * The calibration of the gyro and of the three line sensors, as stored in the EEPROM.
+ *
+ * Every field is 16 bits wide, so the layout has no padding and is the same on the robot and on the host
+ */
+struct calibration_data {
+  /**
+   * tells the EEPROM contains a calibration of this layout (and not, for instance, the 0xFF of an erased EEPROM)
+   */
+  uint16_t magic;
+  /**
+   * average reading of the Z axis of the gyro when the robot is still
+   */
+  int16_t gyroOffset;
+  /**
+   * the readings of the line sensors on white
+   */
+  uint16_t lineMinimum[3];
+  /**
+   * the readings of the line sensors on black
+   */
+  uint16_t lineMaximum[3];
+  /**
+   * Fletcher-16 checksum of all the previous fields
+   */
+  uint16_t checksum;
+};
+
+/**
+ * Read the calibration from the EEPROM
+ *
+ * @param[out] data where to put the calibration read
+ * @return true if the EEPROM contains a valid calibration, false if it was never saved or it is corrupted
+ */
+bool loadCalibration(struct calibration_data& data);
+
+/**
+ * Store the calibration in the EEPROM. The magic number and the checksum are computed here
+ *
+ * \note only the bytes which changed are written, to spare the EEPROM (which lasts about 100000 writes per cell)
+ *
+ * @param[in] data the calibration to save
+ */
+void saveCalibration(struct calibration_data& data);
+
+/**
+ * @param[in] data a calibration
+ * @return the Fletcher-16 checksum of every field of the calibration but the checksum itself
+ */
+uint16_t calibrationChecksum(const struct calibration_data& data);
+
+}
+
+#endif /* CALIBRATION_HPP_ */
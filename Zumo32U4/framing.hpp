@@ -0,0 +1,100 @@
+/**
+ * @file
+ *
+ * Framing of the packages of protocol version 4 (see FRAMED_PROTOCOL_VERSION).
+ *
+ * A CRC-16 after the package finds the corrupted ones, and the COBS encoding removes every 0 byte from the package
+ * and its CRC, so a 0 byte can only be a delimiter: on the link a frame is
+ *
+ * @code
+ * 0, COBS(header, payload, CRC high byte, CRC low byte), 0
+ * @endcode
+ *
+ * Two frames can share the delimiter between them. A receiver that lost a byte drops the frame, whose CRC is wrong,
+ * and starts again at the next delimiter.
+ *
+ * The CRC is CRC-16/CCITT-FALSE (polynomial 0x1021, initial value 0xFFFF) of the header and the payload, computed
+ * with a table of 512 bytes kept in flash. COBS replaces each 0 byte with the distance to the next one, and adds a
+ * first byte with the distance to the first one: it adds a byte every 254 bytes at most.
+ *
+ * @date Oct 19, 2026
+ * @author agent
+ */
+
+#ifndef FRAMING_HPP_
+#define FRAMING_HPP_
+
+#include <Arduino.h>
+#include <stdint.h>
+
+/**
+ * the byte which starts and ends a frame
+ */
+#define FRAME_DELIMITER     0
+/**
+ * the initial value of the CRC
+ */
+#define CRC16_INITIAL       0xFFFF
+/**
+ * the bytes of the CRC after the package
+ */
+#define CRC16_LENGTH        2
+/**
+ * the bytes of the frame of a package of \c length bytes at most, delimiters included
+ */
+#define FRAMED_LENGTH(length) ((length) + CRC16_LENGTH + 1 + ((length) + CRC16_LENGTH) / 254 + 2)
+
+namespace robotieee {
+
+/**
+ * Computes the CRC-16/CCITT-FALSE of some bytes
+ *
+ * @param[in] data the bytes
+ * @param[in] length the number of bytes
+ * @param[in] crc the CRC of the bytes before these ones, to compute it a piece at a time
+ * @return the CRC
+ */
+uint16_t crc16(const uint8_t* data, uint16_t length, uint16_t crc = CRC16_INITIAL);
+
+/**
+ * Encodes some bytes with COBS
+ *
+ * @param[in] data the bytes to encode
+ * @param[in] length the number of bytes
+ * @param[out] encoded the encoded bytes, without 0 bytes: length + 1 + length / 254 of them at most
+ * @return the number of encoded bytes
+ */
+uint16_t cobsEncode(const uint8_t* data, uint16_t length, uint8_t* encoded);
+
+/**
+ * Decodes some bytes encoded with COBS
+ *
+ * @param[in] encoded the encoded bytes, without the delimiters
+ * @param[in] length the number of encoded bytes
+ * @param[out] data the decoded bytes. It can be \c encoded itself: the bytes are decoded in place
+ * @return the number of decoded bytes; 0 if the encoded bytes are malformed
+ */
+uint16_t cobsDecode(const uint8_t* encoded, uint16_t length, uint8_t* data);
+
+/**
+ * Builds the frame of a package
+ *
+ * @param[in] package the package, as serialized by IPackage::serialize
+ * @param[in] length the bytes of the package
+ * @param[out] frame the frame, FRAMED_LENGTH(length) bytes at most
+ * @return the bytes of the frame, delimiters included
+ */
+uint16_t frameEncode(const uint8_t* package, uint16_t length, uint8_t* frame);
+
+/**
+ * Extracts the package from a frame, in place, and checks its CRC
+ *
+ * @param[in,out] frame the bytes between the delimiters of the frame. The package takes their place
+ * @param[in] length the number of bytes between the delimiters
+ * @return the bytes of the package; 0 if the frame is malformed or the CRC is wrong
+ */
+uint16_t frameDecode(uint8_t* frame, uint16_t length);
+
+}
+
+#endif /* FRAMING_HPP_ */
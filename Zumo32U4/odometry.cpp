@@ -0,0 +1,57 @@
+/*
+   odometry.cpp
+
+    Created on: Oct 19, 2026
+        Author: agent
+*/
+#include "odometry.hpp"
+#include "TurnSensor.h"
+#include <math.h>
+
+namespace robotieee {
+
+  // The distances are kept as the sum of the counts of both encoders, twice the counts of the center of the robot:
+  // halving them at each update would lose a count every other update
+  static int32_t distanceCounts;    // The distance travelled by the center of the robot
+  static float forwardCounts;       // The distance travelled along the initial heading
+  static uint32_t headingReference; // turnAngle when the odometry was reset
+
+  /**
+   * @return the sum of the counts of both encoders converted in millimeters travelled by the center of the robot
+   */
+  static int16_t toMillimeters(int32_t counts) {
+    return counts * 500 / ODOMETRY_COUNTS_PER_METER;
+  }
+
+  void odometryReset() {
+    Zumo32U4Encoders::getCountsAndResetLeft();
+    Zumo32U4Encoders::getCountsAndResetRight();
+    turnSensorUpdate();
+    headingReference = turnAngle;
+    distanceCounts = 0;
+    forwardCounts = 0;
+  }
+
+  void odometryUpdate() {
+    int16_t left = Zumo32U4Encoders::getCountsAndResetLeft();
+    int16_t right = Zumo32U4Encoders::getCountsAndResetRight();
+    int16_t step = left + right;
+
+    turnSensorUpdate();
+
+    // turnAngle wraps around every 360 degrees: as a signed number, 2^31 units are 180 degrees
+    float heading = (int32_t) (turnAngle - headingReference) * (float) (M_PI / 2147483648.0);
+
+    distanceCounts += step;
+    forwardCounts += step * cos(heading);
+  }
+
+  int16_t odometryDistance() {
+    return toMillimeters(distanceCounts);
+  }
+
+  int16_t odometryForward() {
+    return toMillimeters(forwardCounts);
+  }
+
+}
@@ -0,0 +1,53 @@
+/**
+ * @file
+ *
+ * Odometry of the robot: the distance travelled, measured by the wheel encoders, projected along the heading
+ * measured by the gyro.
+ *
+ * The distance a straight movement covers in a given time depends on the charge of the battery: measuring it
+ * with the encoders makes the centering on the intersections the same whatever the battery
+ *
+ * @date Oct 19, 2026
+ * @author agent
+ */
+
+#ifndef ODOMETRY_HPP_
+#define ODOMETRY_HPP_
+
+#include <stdint.h>
+
+/**
+ * encoder counts per meter travelled by a wheel: 909.7 counts per revolution of the 75:1 motors, 39mm wheels
+ */
+#define ODOMETRY_COUNTS_PER_METER 7425
+
+namespace robotieee {
+
+/**
+ * Start measuring a new movement: the distances go back to 0 and the current heading of the
+ * robot becomes the forward direction.
+ *
+ * \note the gyro must be already set up (see turnSensorSetup): odometryUpdate integrates its readings too
+ */
+void odometryReset();
+
+/**
+ * Read the encoders and the gyro, and add the distance travelled since the last update, projected along the current heading.
+ *
+ * Call it often: the robot is assumed to go straight from one update to the next
+ */
+void odometryUpdate();
+
+/**
+ * @return the distance travelled since odometryReset by the center of the robot, in millimeters. Negative if the robot went backwards
+ */
+int16_t odometryDistance();
+
+/**
+ * @return how far the robot went along the direction it faced at odometryReset, in millimeters
+ */
+int16_t odometryForward();
+
+}
+
+#endif /* ODOMETRY_HPP_ */
@@ -6,15 +6,38 @@
 */
 #include "robot.hpp"
 #include "TurnSensor.h"
+#include "odometry.hpp"
+#include "block.hpp"
 #include <Wire.h>
 
 #define DEFAULT_ORIENTATION               object_movement::DOWN
 #define DEFAULT_SPEED                     150
-#define DEFAULT_CENTERING_DELAY           200
+#define DEFAULT_CENTERING_DISTANCE        45
 #define DEFAULT_PATH_SEEK_COMPENSATION    5
 #define DEFAULT_SPEED_COMPENSATION        5
 #define DEFAULT_BACKWARDS_CENTERING_DELAY 0
-#define DEFAULT_BLOCK_CENTERING_DELAY     325
+#define DEFAULT_BLOCK_CENTERING_DISTANCE  73
+#define DEFAULT_LINE_FOLLOW_MODE          LFM_PATTERN
+#define DEFAULT_PROPORTIONAL_GAIN         150
+#define DEFAULT_INTEGRAL_GAIN             0
+#define DEFAULT_DERIVATIVE_GAIN           600
+#define PID_GAIN_SCALE                    1000
+#define MAX_LINE_ERROR_SUM                50000
+#define MAX_MOTOR_SPEED                   400
+#define DEFAULT_ACCELERATION              4000
+#define DEFAULT_DECELERATION              4000
+#define PROFILE_MINIMUM_SPEED             60
+#define PROFILE_MINIMUM_TURN_RATE         100
+#define MOTOR_TIME_CONSTANT               20
+#define FULL_SPEED_MM_PER_SECOND          600
+#define WHEEL_BASE_MM                     85
+#define LINE_RECOVERY_MARGIN              5
+#define LINE_RECOVERY_MAX_DEGREES         60
+#define DEFAULT_PROXIMITY_INTERVAL        20
+#define PROXIMITY_DEBOUNCE                2
+#define PROXIMITY_ONE_CELL_COUNTS         11
+#define PROXIMITY_TWO_CELLS_COUNTS        7
+#define PROXIMITY_MAX_LEVEL_DIFFERENCE    1
 
 extern L3G gyro;
 extern LSM303 accel;
@@ -29,17 +52,43 @@ extern Zumo32U4LCD lcd;
 namespace robotieee {
 
   static struct line_readings readLineSensors();
+  static struct line_readings readLineSensors(int* values);
+  static int16_t lineError(const int* values);
+  static uint8_t cellsAway(uint8_t counts);
 
   robot::robot(const point start_position) : moveable{start_position} {
     _hardwareInitialized   = false;
     _scanning              = true;
     _speed                 = DEFAULT_SPEED;
-    _centeringDelay        = DEFAULT_CENTERING_DELAY;
+    _centeringDistance     = DEFAULT_CENTERING_DISTANCE;
     _pathSeekCompensation  = DEFAULT_PATH_SEEK_COMPENSATION;
     _speedCompensation     = DEFAULT_SPEED_COMPENSATION;
-    _blockCenteringDelay   = DEFAULT_BLOCK_CENTERING_DELAY;
+    _blockCenteringDistance = DEFAULT_BLOCK_CENTERING_DISTANCE;
     _orientation           = DEFAULT_ORIENTATION;
     _lookLineRight         = false;
+    _motionState           = MS_IDLE;
+    _motionCommand         = MC_NONE;
+    _motionResult          = false;
+    _lineFollowMode        = DEFAULT_LINE_FOLLOW_MODE;
+    _proportionalGain      = DEFAULT_PROPORTIONAL_GAIN;
+    _integralGain          = DEFAULT_INTEGRAL_GAIN;
+    _derivativeGain        = DEFAULT_DERIVATIVE_GAIN;
+    _acceleration          = DEFAULT_ACCELERATION;
+    _deceleration          = DEFAULT_DECELERATION;
+    _profileSpeed          = 0;
+    _arcQuarters           = 0;
+    _rolling               = false;
+    _proximityInterval     = DEFAULT_PROXIMITY_INTERVAL;
+    _leftMotorSpeed        = 0;
+    _rightMotorSpeed       = 0;
+#ifdef TELEMETRY
+    for (int i = 0; i < 3; i++) {
+      _lineValues[i] = 0;
+    }
+#endif
+#ifdef TRACE
+    _tracedState           = MS_IDLE;
+#endif
   }
   
   robot::~robot() {
@@ -64,43 +113,124 @@ namespace robotieee {
     lineSensors.initThreeSensors(); 
     proxSensors.initThreeSensors(); 
     
+    // The calibration saved in the EEPROM spares the 3 seconds of the gyro calibration and the
+    // two button presses of the line sensors one. Holding button A at boot forces a new calibration,
+    // e.g. when the robot is moved to another floor
+    struct calibration_data calibration;
+    if (!buttonA.isPressed() && loadCalibration(calibration)) {
+      restoreCalibration(calibration);
+    } else {
+      buttonA.waitForRelease();
+      calibrate();
+    }
+
+    _hardwareInitialized = true;
+  }
+
+  void robot::calibrate() {
+
+    struct calibration_data calibration;
+
     // Gyroscope offset calibration
     turnSensorSetup();
 
     // Manual line sensor calibration
     calibrateLineSensors();
 
-    _hardwareInitialized = true;
+    calibration.gyroOffset = gyroOffset;
+    for (int i = 0; i < 3; i++) {
+      calibration.lineMinimum[i] = lineSensors.calibratedMinimumOn[i];
+      calibration.lineMaximum[i] = lineSensors.calibratedMaximumOn[i];
+    }
+    saveCalibration(calibration);
+  }
+
+  void robot::restoreCalibration(const struct calibration_data& calibration) {
+
+    // the line sensors library allocates its calibration arrays on the first lineSensors.calibrate():
+    // providing them avoids that allocation
+    static unsigned int lineMinimum[3];
+    static unsigned int lineMaximum[3];
+
+    turnSensorSetup(calibration.gyroOffset);
+
+    for (int i = 0; i < 3; i++) {
+      lineMinimum[i] = calibration.lineMinimum[i];
+      lineMaximum[i] = calibration.lineMaximum[i];
+    }
+    lineSensors.calibratedMinimumOn = lineMinimum;
+    lineSensors.calibratedMaximumOn = lineMaximum;
   }
   
   
   bool robot::rotate(int16_t degrees, bool stopIfCenterBlack = false) {
+    startRotate(degrees, stopIfCenterBlack);
+    waitMotion();
+    return _motionResult;
+  }
+
+  void robot::startRotate(int16_t degrees, bool stopIfCenterBlack) {
+    _motionCommand = MC_NONE;
+    beginRotation(degrees, stopIfCenterBlack, MS_ROTATING);
+  }
+
+  void robot::beginRotation(int16_t degrees, bool stopIfCenterBlack, enum motion_state state) {
 
     int sign = (degrees > 0) ? 1 : -1;
-    bool retVal;
+    int16_t speed;
 
+    _rotationDegrees = degrees;
+    _rotationStopIfCenterBlack = stopIfCenterBlack;
+    _motionState = state;
+    _headingOffset += (int32_t) turnAngle;
     turnSensorReset();
-    Zumo32U4Motors::setSpeeds(-sign * _speed, sign * _speed);
-    while (true) {
-      turnSensorUpdate();
-
-      // If the amount of degrees rotated exceeds the desired rotation, stop
-      if (abs((int32_t) turnAngle) >= abs(degrees * turnAngle1)) {
-        retVal = false;
-        break;
-      }
+    beginProfile();
+    speed = updateProfile(_speed, -1);
+    setMotorSpeeds(-sign * speed, sign * speed);
+  }
+
+  bool robot::updateRotation() {
 
-      // Check for the center line sensor if requested and stop if a black line is found
-      if (stopIfCenterBlack) {
-        struct line_readings readings = readLineSensors();
-        if (readings.center == LC_BLACK) {
-          retVal = true;
-          break;
-        }
+    int sign = (_rotationDegrees > 0) ? 1 : -1;
+    int32_t target = (int32_t) abs(_rotationDegrees) * turnAngle1;
+    int32_t rotated;
+    int16_t speed;
+
+    turnSensorUpdate();
+    rotated = sign * (int32_t) turnAngle;
+
+    // The motors need about MOTOR_TIME_CONSTANT milliseconds to stop, so the robot still turns by about
+    // turn rate * MOTOR_TIME_CONSTANT after they are stopped: 0.07 dps per gyro digit, in hundredths of degree
+    int32_t coast = (int32_t) abs(turnRate) * 7 * MOTOR_TIME_CONSTANT / 1000 * (turnAngle1 / 100);
+
+    // If the amount of degrees rotated, coasting included, exceeds the desired rotation, stop
+    if (rotated + coast >= target) {
+      _rotationFoundBlack = false;
+      setMotorSpeeds(0, 0);
+      return true;
+    }
+
+    // The distance left, in motor speed times milliseconds, is predicted from the degrees left and the ratio
+    // between the motor speed and the turn rate the gyro measures
+    int32_t turnRateTenths = (int32_t) abs(turnRate) * 7 / 10;
+    int32_t remaining = -1;
+    if (abs(turnRate) >= PROFILE_MINIMUM_TURN_RATE) {
+      remaining = (target - rotated - coast) / turnAngle1 * _profileSpeed * 10000 / turnRateTenths;
+    }
+    speed = updateProfile(_speed, remaining);
+    setMotorSpeeds(-sign * speed, sign * speed);
+
+    // Check for the center line sensor if requested and stop if a black line is found
+    if (_rotationStopIfCenterBlack) {
+      struct line_readings readings = readLineSensors();
+      if (readings.center == LC_BLACK) {
+        _rotationFoundBlack = true;
+        setMotorSpeeds(0, 0);
+        return true;
       }
     }
-    Zumo32U4Motors::setSpeeds(0, 0);
-    return retVal;
+
+    return false;
   }
 
   bool robot::rotateAndCheck(int16_t degrees) {
@@ -109,6 +239,11 @@ namespace robotieee {
   }
 
   void robot::faceDirection(object_movement targetDirection) {
+    startFaceDirection(targetDirection);
+    waitMotion();
+  }
+
+  void robot::startFaceDirection(object_movement targetDirection) {
 
     // First of all we rotate the reference system so that we are sure that the initial orientation of the robot becomes UP
     object_movement rotatedTargetOrientation = (targetDirection - _orientation + 4) % 4;
@@ -116,94 +251,370 @@ namespace robotieee {
     // After this rotation it is trivial to determine how to turn the robot by checking rotated target direction
     switch (rotatedTargetOrientation) {
 
-      case 1: turnRight();
+      case 1: startTurn(-90, 1, false);
               break;
               
-      case 2: turnBack();
+      case 2: startTurn(179, 2, false);
               break;
               
-      case 3: turnLeft();
+      case 3: startTurn(90, 3, false);
               break;
               
     }
   }
+
+  void robot::startTurn(int16_t degrees, uint8_t quarters, bool check) {
+    _motionCommand = MC_TURN;
+    _turnQuarters = quarters;
+    _checkAfterTurn = check;
+    beginRotation(degrees, false, MS_ROTATING);
+  }
   
   bool robot::followLine(bool searchBlock = false) {
+    startFollowLine(searchBlock);
+    waitMotion();
+    return _motionResult;
+  }
 
-    int sxSpeed = _speed;
-    int dxSpeed = _speed;
+  void robot::startFollowLine(bool searchBlock) {
+    _motionCommand = MC_NONE;
+    beginProfile();
+    beginFollowLine(searchBlock);
+  }
 
-    bool blockFound = false;
-    
-    while (true) {
-      
-      Zumo32U4Motors::setSpeeds(sxSpeed, dxSpeed);
-      struct line_readings lineReadings = readLineSensors();
+  void robot::beginFollowLine(bool searchBlock) {
+    _leftSpeed = updateProfile(_speed, -1);
+    _rightSpeed = _leftSpeed;
+    _searchBlock = searchBlock;
+    _blockFound = false;
+    _proximityHits = 0;
+    _lastProximitySample = millis();
+    _onIntersection = false;
+    _lastLineError = 0;
+    _lineErrorSum = 0;
+    _motionState = MS_FOLLOWING_LINE;
+
+    // The robot is aligned with the line: the gyro measures how far it heads away from it while following it
+    _headingOffset = 0;
+    turnSensorReset();
+  }
 
-      //proximity check
-      if (searchBlock == true && blockFound == false) {
-        blockFound = checkForBlock();
+  void robot::updateFollowLine() {
+
+    int values[3];
+
+    setMotorSpeeds(_leftSpeed, _rightSpeed);
+    struct line_readings lineReadings = readLineSensors(values);
+    int16_t speed = updateProfile(_speed, -1);
+
+#   ifdef TELEMETRY
+    for (int i = 0; i < 3; i++) {
+      _lineValues[i] = values[i];
+    }
+#   endif
+
+    // Keep track of the heading, for fixPath
+    turnSensorUpdate();
+
+    //proximity check
+    if (_searchBlock == true && _blockFound == false) {
+      _blockFound = sampleProximity();
+    }
+    
+    /* The possible scenarios are:
+     * - WWW: the robot has just abandoned the path
+     * - WWB: we lost the path but we know that we are going left too much
+     * - WBW: we are correctly following the path
+     * - WBB: we reached the intersection but we are a bit off from the track
+     * - BWW: we lost the path but we know that we are going right too much
+     * - BWB: we are looking for the path we lost
+     * - BBW: we reached the intersection but we are a bit off from the track
+     * - BBB: we reached the intersection with no relevant error
+     */
+
+    if (lineReadings.left == LC_BLACK && lineReadings.center == LC_BLACK && lineReadings.right == LC_BLACK) {
+      if (_onIntersection) {
+        // Still on the intersection counted already
       }
-      
-      /* The possible scenarios are:
-       * - WWW: the robot has just abandoned the path
-       * - WWB: we lost the path but we know that we are going left too much
-       * - WBW: we are correctly following the path
-       * - WBB: we reached the intersection but we are a bit off from the track
-       * - BWW: we lost the path but we know that we are going right too much
-       * - BWB: we are looking for the path we lost
-       * - BBW: we reached the intersection but we are a bit off from the track
-       * - BBB: we reached the intersection with no relevant error
-       */
-
-      if (lineReadings.left == LC_BLACK && lineReadings.center == LC_BLACK && lineReadings.right == LC_BLACK) {
-        // The delay is used to make sure that the robot reaches the center of the intersection
+      else if (passesThroughIntersection()) {
+        // An intermediate cell: the robot counts it and goes on following the line, without slowing down
+        _onIntersection = true;
+        move(_orientation, 1);
+        _cellsLeft--;
+      }
+      else if (_motionCommand == MC_GO_AHEAD && (_arcQuarters == 1 || _arcQuarters == 3)) {
+        // The last intersection, and the next line is on a side: the robot turns on it without stopping
+        move(_orientation, 1);
+        _cellsLeft--;
+        beginArc(_arcQuarters);
+        return;
+      }
+      else {
+        // The robot keeps going for a while to make sure that it reaches the center of the intersection
         // and does not stop as soon as it sees the black horizontal line
-        delay(_centeringDelay);
-        break;
+        _straightSpeed = _speed;
+        _profileTarget = _centeringDistance;
+        _profileBraking = stopsAfterCentering();
+        odometryReset();
+        _motionState = MS_CENTERING;
+        return;
       }
+    }
+    else if (lineReadings.left == LC_WHITE && lineReadings.right == LC_WHITE) {
+      // The side sensors have left the horizontal line of the last intersection
+      _onIntersection = false;
+    }
 
-      if (lineReadings.left == LC_WHITE && lineReadings.center == LC_BLACK && lineReadings.right == LC_WHITE) {
-        sxSpeed = _speed;
-        dxSpeed = _speed;
-        continue; 
-      }
+    if (_onIntersection && lineReadings.center == LC_BLACK) {
+      // The side sensors see the horizontal line, not the side the robot is drifting to: go straight until they leave it
+      _leftSpeed = speed;
+      _rightSpeed = speed;
+      return;
+    }
 
-      if (lineReadings.center == LC_WHITE) {
-        fixPath();
-        continue;
-      }
+    if (_lineFollowMode == LFM_PID) {
+      steerWithPid(values, lineReadings, speed);
+      return;
+    }
 
-      if (lineReadings.left == LC_BLACK && lineReadings.center == LC_BLACK && lineReadings.right == LC_WHITE) {
-        dxSpeed += _speedCompensation;
-      }
+    // Remember where the line is, so that fixPath knows where to look for it if it gets lost
+    if (lineReadings.left == LC_BLACK || lineReadings.center == LC_BLACK || lineReadings.right == LC_BLACK) {
+      _lastLineError = lineError(values);
+    }
+
+    if (lineReadings.left == LC_WHITE && lineReadings.center == LC_BLACK && lineReadings.right == LC_WHITE) {
+      _leftSpeed = speed;
+      _rightSpeed = speed;
+      return;
+    }
 
-      if (lineReadings.left == LC_WHITE && lineReadings.center == LC_BLACK && lineReadings.right == LC_BLACK) {
-        sxSpeed += _speedCompensation;
+    if (lineReadings.center == LC_WHITE) {
+      fixPath();
+      return;
+    }
+
+    if (lineReadings.left == LC_BLACK && lineReadings.center == LC_BLACK && lineReadings.right == LC_WHITE) {
+      _rightSpeed += _speedCompensation;
+    }
+
+    if (lineReadings.left == LC_WHITE && lineReadings.center == LC_BLACK && lineReadings.right == LC_BLACK) {
+      _leftSpeed += _speedCompensation;
+    }
+  }
+
+  void robot::steerWithPid(const int* values, const struct line_readings& lineReadings, int16_t speed) {
+
+    // The line is lost: turn on the spot towards the side where it was seen last,
+    // or look for it on both sides if it was under the center sensor
+    if (lineReadings.left == LC_WHITE && lineReadings.center == LC_WHITE && lineReadings.right == LC_WHITE) {
+      if (_lastLineError == 0) {
+        fixPath();
+      } else {
+        int sign = (_lastLineError > 0) ? 1 : -1;
+        _leftSpeed = sign * speed;
+        _rightSpeed = -sign * speed;
       }
-      
+      return;
     }
 
-    //stop motors
-    Zumo32U4Motors::setSpeeds(0, 0);
+    int16_t error = lineError(values);
 
-    return blockFound;
+    _lineErrorSum = constrain(_lineErrorSum + error, -MAX_LINE_ERROR_SUM, MAX_LINE_ERROR_SUM);
+    int32_t correction = ((int32_t) _proportionalGain * error + (int32_t) _integralGain * _lineErrorSum + (int32_t) _derivativeGain * (error - _lastLineError)) / PID_GAIN_SCALE;
+    _lastLineError = error;
+
+    // A line on the right (positive error) needs the left motor to go faster
+    _leftSpeed = constrain(speed + correction, -MAX_MOTOR_SPEED, MAX_MOTOR_SPEED);
+    _rightSpeed = constrain(speed - correction, -MAX_MOTOR_SPEED, MAX_MOTOR_SPEED);
   }
 
   void robot::fixPath() {
 
-    int i = _lookLineRight ? (-1) : 1;
-    _lookLineRight = _lookLineRight ? false : true; // Invert _lookLineRight value: from true to false and viceversa
+    if (_lastLineError == 0) {
+      // No idea of where the line is: look for it alternating the side the search starts from
+      int i = _lookLineRight ? (-1) : 1;
+      _lookLineRight = _lookLineRight ? false : true; // Invert _lookLineRight value: from true to false and viceversa
+      _seekDegrees = i * _pathSeekCompensation;
+      beginRotation(_seekDegrees, true, MS_SEEKING_LINE);
+      return;
+    }
 
-    while (true) {
-      bool foundBlack = rotate(i * _pathSeekCompensation, true);
-      if (foundBlack) {
-        break;
-      }
+    // Turn towards the side where the line was seen last, as much as the robot heads away from it plus a small margin,
+    // instead of stopping on its edge: the robot goes on almost parallel to the line and does not lose it again at once.
+    // A line on the right (positive error) needs a clockwise (negative) rotation
+    int side = (_lastLineError > 0) ? 1 : -1;
+    int16_t away = side * lineHeading() / turnAngle1;
+    _seekDegrees = -side * constrain(away + LINE_RECOVERY_MARGIN, LINE_RECOVERY_MARGIN, LINE_RECOVERY_MAX_DEGREES);
+
+    // If the center sensor is not on the line at the end, update() sweeps the other side, see continueSeekingLine
+    beginRotation(_seekDegrees, false, MS_SEEKING_LINE);
+  }
+
+  void robot::continueSeekingLine() {
 
-      i = -(i * 2);
+    int16_t heading = lineHeading() / turnAngle1;
+    int16_t next;
+    int16_t target;
+
+    if (!_rotationStopIfCenterBlack) {
+      // The turn of fixPath towards the line was not enough: the line is still on the same side
+      next = (_seekDegrees > 0) ? _pathSeekCompensation : -_pathSeekCompensation;
+    } else {
+      // Double the rotation and invert its direction, sweeping both sides of the line
+      next = -(_seekDegrees * 2);
     }
-    
+
+    // The sweep never goes further than LINE_RECOVERY_MAX_DEGREES from the direction of the line: the robot lost it
+    // going ahead, so it cannot head much further from it (and it would find the lines crossing it instead)
+    target = constrain(heading + next, -LINE_RECOVERY_MAX_DEGREES, LINE_RECOVERY_MAX_DEGREES);
+    if (target == heading) {
+      target = (next > 0) ? -LINE_RECOVERY_MAX_DEGREES : LINE_RECOVERY_MAX_DEGREES;
+    }
+    _seekDegrees = target - heading;
+    beginRotation(_seekDegrees, true, MS_SEEKING_LINE);
+  }
+
+  int32_t robot::lineHeading() {
+    return _headingOffset + (int32_t) turnAngle;
+  }
+
+  bool robot::update() {
+
+#   ifdef TRACE
+    traceMotionState();
+#   endif
+
+    switch (_motionState) {
+
+      case MS_IDLE:           break;
+
+      case MS_ROTATING:       if (updateRotation()) {
+                                _motionResult = _rotationFoundBlack;
+                                endMotion();
+                              }
+                              break;
+
+      case MS_SEEKING_LINE:   if (updateRotation()) {
+                                if (_rotationFoundBlack || readLineSensors().center == LC_BLACK) {
+                                  // the robot was turning on the spot: it starts moving forward from still
+                                  beginProfile();
+                                  _motionState = MS_FOLLOWING_LINE;
+                                } else {
+                                  continueSeekingLine();
+                                }
+                              }
+                              break;
+
+      case MS_FOLLOWING_LINE: updateFollowLine();
+                              break;
+
+      case MS_CENTERING:
+      case MS_STRAIGHT_MOVE:  if (updateStraightMove()) {
+                                _motionResult = (_motionState == MS_CENTERING) ? _blockFound : false;
+                                endMotion();
+                              }
+                              break;
+
+      case MS_ARC_TURNING:    if (updateArc()) {
+                                _motionResult = false;
+                                endMotion();
+                              }
+                              break;
+    }
+
+#   ifdef TRACE
+    traceMotionState();
+#   endif
+
+    return isMoving();
+  }
+
+  void robot::endMotion() {
+
+    enum motion_command command = _motionCommand;
+
+    _motionState = MS_IDLE;
+    _motionCommand = MC_NONE;
+
+    switch (command) {
+
+      case MC_TURN:           _orientation = (object_movement) ((_orientation + _turnQuarters) % 4);
+                              _motionResult = _checkAfterTurn ? checkForBlock() : false;
+                              break;
+
+      case MC_GO_AHEAD:
+      case MC_PUSH_BLOCK:     // The robot is centered on the last intersection: the ones before have been counted on the fly
+                              move(_orientation, 1);
+                              _cellsLeft--;
+                              if (command == MC_PUSH_BLOCK) {
+                                // Push the block a little further to center it on the intersection
+                                _motionCommand = MC_PUSH_CENTERING;
+                                beginStraightMove(_blockCenteringDistance, _speed, false);
+                              }
+                              else if (_blockFound) {
+                                Zumo32U4Buzzer::playNote(NOTE_A(4), 300, 15);
+                              }
+                              else if (_arcQuarters == 2) {
+                                // There is no arc to turn back: the robot turns on the spot
+                                startTurn(179, 2, false);
+                              }
+                              break;
+
+      case MC_ARC_TURN:       // The robot follows the new line at once: it is still moving
+                              _orientation = (object_movement) ((_orientation + _turnQuarters) % 4);
+                              _rolling = true;
+                              break;
+
+      case MC_PUSH_CENTERING: // It goes back as far as the robot pushed the block for centering
+                              _motionCommand = MC_PUSH_BACK;
+                              beginStraightMove(_blockCenteringDistance, -_speed, true);
+                              break;
+
+      case MC_PUSH_BACK:
+      case MC_NONE:           break;
+    }
+  }
+
+#ifdef TRACE
+  void robot::traceMotionState() {
+    // The operation traced for each motion state, in the order of enum motion_state
+    static const enum trace_event MOTION_TRACE_EVENTS[] = {
+      TE_COUNT, TE_ROTATION, TE_FOLLOW_LINE, TE_SEEK_LINE, TE_CENTERING, TE_STRAIGHT_MOVE, TE_ARC_TURN,
+    };
+
+    if (_motionState == _tracedState) {
+      return;
+    }
+    if (_tracedState != MS_IDLE) {
+      traceRecord(MOTION_TRACE_EVENTS[_tracedState], _tracedSince);
+    }
+    _tracedState = _motionState;
+    _tracedSince = micros();
+  }
+#endif
+
+#ifdef TELEMETRY
+  void robot::recordTelemetry() {
+    telemetryRecord(_motionState, _lineValues, _leftMotorSpeed, _rightMotorSpeed, (int32_t) turnAngle / (turnAngle1 / 10));
+  }
+#endif
+
+  void robot::setMotorSpeeds(int16_t left, int16_t right) {
+    _leftMotorSpeed = left;
+    _rightMotorSpeed = right;
+    Zumo32U4Motors::setSpeeds(left, right);
+  }
+
+  void robot::waitMotion() {
+    while (update()) ;
+  }
+
+  bool robot::isMoving() {
+    return _motionState != MS_IDLE;
+  }
+
+  bool robot::getMotionResult() {
+    return _motionResult;
   }
 
   bool robot::followLineAndCheck() {
@@ -222,13 +633,65 @@ namespace robotieee {
       lcd.print(frontRight);
 #   endif
     
-    if (frontLeft + frontRight >= 11) { //case sensors: 6 6; 6 5; 5 6
+    if (frontLeft + frontRight >= PROXIMITY_ONE_CELL_COUNTS) { //case sensors: 6 6; 6 5; 5 6
       return true;
     }
 
     return false;
   }
 
+  uint8_t robot::locateBlocks(point* blocks, uint8_t maxBlocks) {
+    uint8_t found = 0;
+
+    proxSensors.read();
+    uint8_t frontLeft = proxSensors.countsFrontWithLeftLeds();
+    uint8_t frontRight = proxSensors.countsFrontWithRightLeds();
+
+    // An object seen much better with the leds of one side is not on the line in front of the robot, but on a diagonal
+    if (abs(frontLeft - frontRight) <= PROXIMITY_MAX_LEVEL_DIFFERENCE) {
+      found = addBlockCandidate(blocks, found, maxBlocks, _orientation, cellsAway(frontLeft + frontRight));
+    }
+    // The side sensors are lit by the leds of their side only: their counts are doubled to compare them with the front ones
+    found = addBlockCandidate(blocks, found, maxBlocks, (object_movement) ((_orientation + 3) % 4), cellsAway(2 * proxSensors.countsLeftWithLeftLeds()));
+    found = addBlockCandidate(blocks, found, maxBlocks, (object_movement) ((_orientation + 1) % 4), cellsAway(2 * proxSensors.countsRightWithRightLeds()));
+
+    return found;
+  }
+
+  uint8_t robot::addBlockCandidate(point* blocks, uint8_t found, uint8_t maxBlocks, object_movement direction, uint8_t cells) {
+    block candidate(0, position);
+
+    if (cells == 0 || found == maxBlocks) {
+      return found;
+    }
+    candidate.move(direction, cells);
+    // Outside the grid: the sensors see something beyond its border
+    if (candidate.position.x < 0 || candidate.position.y < 0) {
+      return found;
+    }
+    blocks[found] = candidate.position;
+    return found + 1;
+  }
+
+  bool robot::sampleProximity() {
+
+    // A reading of the proximity sensors pulses the IR LEDs at every brightness level and takes a few milliseconds,
+    // while the line moves under the robot in one: read them only every _proximityInterval milliseconds
+    uint32_t now = millis();
+    if (now - _lastProximitySample < _proximityInterval) {
+      return false;
+    }
+    _lastProximitySample = now;
+
+    // A single reading may be a reflection: the block is there only if it is seen by PROXIMITY_DEBOUNCE readings in a row
+    if (checkForBlock()) {
+      _proximityHits++;
+    } else {
+      _proximityHits = 0;
+    }
+    return _proximityHits >= PROXIMITY_DEBOUNCE;
+  }
+
   void robot::calibrateLineSensors() {
 
 #   ifdef DEBUG_LCD
@@ -266,36 +729,36 @@ namespace robotieee {
   }
 
   bool robot::turnRightAndCheck() {
-    rotateAndCheck(-90);
-
-    _orientation = (_orientation + 1) % 4;
+    startTurn(-90, 1, true);
+    waitMotion();
+    return _motionResult;
   }
 
   bool robot::turnLeftAndCheck() {
-    rotateAndCheck(90);
-
-    _orientation = (_orientation + 3) % 4;
+    startTurn(90, 3, true);
+    waitMotion();
+    return _motionResult;
   }
 
   bool robot::turnBackAndCheck() {
     // A value of 179 degrees is used due to the way TurnSensor.cpp encodes degrees: a value of 180 would overflow and therefore not work
     // This isn't that bad after all: rotating 179 degrees + error should lead to a almost perfect 180 degrees turn anyway
-    rotateAndCheck(179);
-
-    _orientation = (_orientation + 2) % 4;
+    startTurn(179, 2, true);
+    waitMotion();
+    return _motionResult;
   }
 
   void robot::turnRight() {
     
-    rotate(-90);
-    _orientation = (_orientation + 1) % 4;
+    startTurn(-90, 1, false);
+    waitMotion();
     
   }
 
   void robot::turnLeft() {
     
-    rotate(90);
-    _orientation = (_orientation + 3) % 4;
+    startTurn(90, 3, false);
+    waitMotion();
     
   }
 
@@ -320,45 +783,89 @@ namespace robotieee {
     
     // A value of 179 degrees is used due to the way TurnSensor.cpp encodes degrees: a value of 180 would overflow and therefore not work
     // This isn't that bad after all: rotating 179 degrees + error should lead to a almost perfect 180 degrees turn anyway
-    rotate(179);
-    _orientation = (_orientation + 2) % 4;
+    startTurn(179, 2, false);
+    waitMotion();
     
   }
 
   bool robot::goAhead(unsigned int cells, bool lookingForBlocks = false) {
-    bool blockFound = false;
+    startGoAhead(cells, lookingForBlocks);
+    waitMotion();
+    return _motionResult;
+  }
+
+  void robot::startGoAhead(unsigned int cells, bool lookingForBlocks) {
+
+    _motionCommand = MC_NONE;
+    _searchBlock = lookingForBlocks;
+    _blockFound = false;
+    _cellsLeft = cells;
+    _arcQuarters = 0;
 
     // Before starting we check if the block is immediately in front of us to avoid colliding
     if (lookingForBlocks) {
       
-      blockFound = checkForBlock();
+      _blockFound = checkForBlock();
       
     }
-    
-    for (int i = 0; i < cells && !blockFound; i++) {
-      
-      blockFound = followLine(lookingForBlocks);
-      move(_orientation, 1);
-      
+
+    if (cells == 0 || _blockFound) {
+
+      if (_blockFound) {
+        Zumo32U4Buzzer::playNote(NOTE_A(4), 300, 15);
+      }
+      if (_rolling) {
+        setMotorSpeeds(0, 0);
+        _rolling = false;
+      }
+      _motionResult = _blockFound;
+      return;
     }
 
-    if (blockFound) {
-      
-      Zumo32U4Buzzer::playNote(NOTE_A(4), 300, 15);
-      
+    // endMotion() moves the robot through the other cells
+    _motionCommand = MC_GO_AHEAD;
+    beginOrContinueProfile();
+    beginFollowLine(lookingForBlocks);
+  }
+
+  void robot::goAheadAndTurn(unsigned int cells, object_movement nextDirection) {
+    startGoAheadAndTurn(cells, nextDirection);
+    waitMotion();
+  }
+
+  void robot::startGoAheadAndTurn(unsigned int cells, object_movement nextDirection) {
+    startGoAhead(cells);
+    if (!isMoving()) {
+      startFaceDirection(nextDirection);
+      return;
     }
-    
-    return blockFound;
+    // Quarters of turn clockwise, like in startFaceDirection
+    _arcQuarters = (nextDirection - _orientation + 4) % 4;
   }
 
   void robot::setSpeed(int16_t speed) {
     _speed = speed;
   }
 
+  void robot::setAcceleration(uint16_t acceleration, uint16_t deceleration) {
+    _acceleration = acceleration;
+    _deceleration = deceleration;
+  }
+
   void robot::setSpeedCompensation(int16_t speedCompensation) {
     _speedCompensation = speedCompensation;
   }
 
+  void robot::setLineFollowMode(enum line_follow_mode mode) {
+    _lineFollowMode = mode;
+  }
+
+  void robot::setLineFollowGains(int16_t proportional, int16_t integral, int16_t derivative) {
+    _proportionalGain = proportional;
+    _integralGain = integral;
+    _derivativeGain = derivative;
+  }
+
   static enum line_color convertValueToLineColor(int value, bool invertWhite) {
 
     if (invertWhite) {
@@ -395,6 +902,14 @@ namespace robotieee {
    */
   static struct line_readings readLineSensors() {
     int tmp[3];
+
+    return readLineSensors(tmp);
+  }
+
+  /**
+   * Read the values of left, center and right line tracking, keeping the calibrated readings as well
+   */
+  static struct line_readings readLineSensors(int* tmp) {
     struct line_readings retVal;
     
     lineSensors.readCalibrated(tmp);
@@ -424,10 +939,173 @@ namespace robotieee {
     return retVal;
   }
   
-  void robot::timeMove(uint16_t delayMillis) {
-    Zumo32U4Motors::setSpeeds(_speed, _speed);
-    delay(delayMillis);
-    Zumo32U4Motors::setSpeeds(0,0);
+  /**
+   * Distance of a block from the counts of the proximity sensors, summed over the leds of both sides.
+   * Beyond two cells the counts change too little to tell the distance
+   *
+   * @return the cells between the robot and the block, 0 if there is no block within two cells
+   */
+  static uint8_t cellsAway(uint8_t counts) {
+    if (counts >= PROXIMITY_ONE_CELL_COUNTS) {
+      return 1;
+    }
+    if (counts >= PROXIMITY_TWO_CELLS_COUNTS) {
+      return 2;
+    }
+    return 0;
+  }
+
+  /**
+   * Position of the line under the sensors: the average of -1000 (left), 0 (center) and 1000 (right) weighted by the readings.
+   * At least one reading must not be white
+   */
+  static int16_t lineError(const int* values) {
+    int32_t total = (int32_t) values[LEFT_SENSOR] + values[CENTER_SENSOR] + values[RIGHT_SENSOR];
+    return ((int32_t) values[RIGHT_SENSOR] - values[LEFT_SENSOR]) * 1000 / total;
+  }
+
+  void robot::moveStraight(uint16_t millimeters) {
+    startMoveStraight(millimeters);
+    waitMotion();
+  }
+
+  void robot::startMoveStraight(uint16_t millimeters) {
+    _motionCommand = MC_NONE;
+    beginStraightMove(millimeters, _speed, true);
+  }
+
+  void robot::beginStraightMove(uint16_t millimeters, int16_t speed, bool fromStill) {
+    if (fromStill) {
+      beginProfile();
+    }
+    _straightSpeed = speed;
+    _profileTarget = millimeters;
+    _profileBraking = true;
+    _motionState = MS_STRAIGHT_MOVE;
+    odometryReset();
+    speed = updateProfile(_straightSpeed, toProfileDistance(_profileTarget));
+    setMotorSpeeds(speed, speed);
+  }
+
+  bool robot::updateStraightMove() {
+
+    int32_t remaining = -1;
+    int16_t speed;
+    int16_t travelled;
+
+    // The distance is measured along the direction the robot faced at the beginning: the one of the line
+    odometryUpdate();
+    travelled = abs(odometryForward());
+
+    if (_profileBraking) {
+      remaining = (travelled < _profileTarget) ? toProfileDistance(_profileTarget - travelled) : 0;
+    }
+    speed = updateProfile(_straightSpeed, remaining);
+
+    if (travelled >= _profileTarget) {
+      if (_profileBraking) {
+        setMotorSpeeds(0, 0);
+      }
+      return true;
+    }
+    setMotorSpeeds(speed, speed);
+    return false;
+  }
+
+  bool robot::passesThroughIntersection() {
+    if (_motionCommand != MC_GO_AHEAD && _motionCommand != MC_PUSH_BLOCK) {
+      return false;
+    }
+    return _cellsLeft > 1 && !_blockFound;
+  }
+
+  bool robot::stopsAfterCentering() {
+    // After the last cell of a push, the robot goes on pushing the block to center it on the intersection
+    return _motionCommand != MC_PUSH_BLOCK;
+  }
+
+  void robot::beginArc(uint8_t quarters) {
+    _motionCommand = MC_ARC_TURN;
+    _motionState = MS_ARC_TURNING;
+    _turnQuarters = quarters;
+    turnSensorReset();
+    updateArc();
+  }
+
+  bool robot::updateArc() {
+
+    // Counter clockwise rotations are positive, like in startFaceDirection
+    int sign = (_turnQuarters == 3) ? 1 : -1;
+    int32_t target = 90 * turnAngle1;
+    int32_t rotated;
+    int16_t speed = updateProfile(_speed, -1);
+
+    turnSensorUpdate();
+    rotated = sign * (int32_t) turnAngle;
+
+    // The robot keeps turning for a while after the motors go straight again, see updateRotation
+    int32_t coast = (int32_t) abs(turnRate) * 7 * MOTOR_TIME_CONSTANT / 1000 * (turnAngle1 / 100);
+    if (rotated + coast >= target) {
+      setMotorSpeeds(speed, speed);
+      return true;
+    }
+
+    // The robot finds the intersection as far from its center as the centering distance: an arc of that radius
+    // brings it from there onto the crossing line, as far beyond the center
+    int32_t diameter = 2 * (int32_t) _centeringDistance;
+    int32_t outer = (int32_t) speed * (diameter + WHEEL_BASE_MM) / diameter;
+    int32_t inner = (int32_t) speed * (diameter - WHEEL_BASE_MM) / diameter;
+    if (outer > MAX_MOTOR_SPEED) {
+      inner = inner * MAX_MOTOR_SPEED / outer;
+      outer = MAX_MOTOR_SPEED;
+    }
+    if (sign > 0) {
+      setMotorSpeeds(inner, outer);
+    } else {
+      setMotorSpeeds(outer, inner);
+    }
+    return false;
+  }
+
+  void robot::beginProfile() {
+    _profileStart = micros();
+    _profileSpeed = 0;
+    _rolling = false;
+  }
+
+  void robot::beginOrContinueProfile() {
+    if (!_rolling) {
+      beginProfile();
+    }
+    _rolling = false;
+  }
+
+  int16_t robot::updateProfile(int16_t cruise, int32_t remaining) {
+
+    int16_t maximum = abs(cruise);
+    int16_t minimum = (maximum < PROFILE_MINIMUM_SPEED) ? maximum : PROFILE_MINIMUM_SPEED;
+    int16_t speed = maximum;
+    unsigned long now = micros();
+
+    // Acceleration: the speed grows linearly from the minimum one
+    if (_acceleration > 0) {
+      uint32_t elapsed = (now - _profileStart) / 1000;
+      uint32_t ramp = minimum + (uint32_t) _acceleration * (elapsed < 0xFFFF ? elapsed : 0xFFFF) / 1000;
+      if (ramp < (uint32_t) speed) {
+        speed = ramp;
+      }
+    }
+
+    // Deceleration: the speed that reaches the minimum one exactly when the remaining distance ends
+    if (_deceleration > 0 && remaining >= 0) {
+      int16_t braking = sqrt((float) minimum * minimum + 2.0 * _deceleration * remaining / 1000);
+      if (braking < speed) {
+        speed = braking;
+      }
+    }
+
+    _profileSpeed = speed;
+    return (cruise < 0) ? -speed : speed;
   }
 
   void robot::invertSpeed(){
@@ -435,23 +1113,39 @@ namespace robotieee {
     setSpeedCompensation(-(_speedCompensation)); // Not useful at the moment
   }
 
-  void robot::setCenteringDelay(uint16_t centeringDelay){
-    _centeringDelay = centeringDelay;
+  void robot::setCenteringDistance(uint16_t centeringDistance){
+    _centeringDistance = centeringDistance;
   }
-  
-  void robot::pushBlock(unsigned int cells){
 
-    // Push the block on the desired location
-    goAhead(cells);
-    timeMove(_blockCenteringDelay);
-
-    // Invert the speed used for consequent movements, in order to move backwards
-    invertSpeed();
+  void robot::setProximityInterval(uint16_t milliseconds) {
+    _proximityInterval = milliseconds;
+  }
 
-    //It goes back the same time as the robot push the block for centering
-    timeMove(_blockCenteringDelay);
+  int32_t robot::toProfileDistance(uint16_t millimeters) {
+    // Only the braking depends on this conversion: the distances are measured by the encoders
+    return (int32_t) millimeters * 1000 / FULL_SPEED_MM_PER_SECOND * MAX_MOTOR_SPEED;
+  }
+  
+  void robot::pushBlock(unsigned int cells){
+    startPushBlock(cells);
+    waitMotion();
+  }
 
-    // Invert speed again to reset forward movement
-    invertSpeed();
+  void robot::startPushBlock(unsigned int cells) {
+
+    _searchBlock = false;
+    _blockFound = false;
+    _cellsLeft = cells;
+    _arcQuarters = 0;
+
+    // Push the block on the desired location, then endMotion() centers it on the intersection
+    if (cells == 0) {
+      _motionCommand = MC_PUSH_CENTERING;
+      beginStraightMove(_blockCenteringDistance, _speed, true);
+    } else {
+      _motionCommand = MC_PUSH_BLOCK;
+      beginOrContinueProfile();
+      beginFollowLine(false);
+    }
   }
 }
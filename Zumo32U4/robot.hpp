@@ -13,8 +13,11 @@
 
 #include <Zumo32U4.h>
 #include <matrix.hpp>
+#include "calibration.hpp"
 #include "moveable.hpp"
 #include "typedefs.hpp"
+#include "trace.hpp"
+#include "telemetry.hpp"
 
 namespace robotieee {
 
@@ -40,6 +43,89 @@ struct line_readings {
   enum line_color right;
 };
 
+/**
+ * How robotieee::robot::followLine keeps the robot on the line
+ */
+enum line_follow_mode {
+  /**
+   * the readings of the line sensors are quantised to black and white and each pattern nudges the speed of a motor
+   */
+  LFM_PATTERN,
+  /**
+   * a PID controller steers the robot using the position of the line computed from the calibrated readings (0-1000).
+   * It follows the line smoothly, so the robot can run at a higher speed between the intersections
+   */
+  LFM_PID,
+};
+
+/**
+ * The elementary movement the robot is performing. Each call of robotieee::robot::update advances it a little
+ */
+enum motion_state {
+  /**
+   * the robot is still
+   */
+  MS_IDLE,
+  /**
+   * the robot is rotating on itself
+   */
+  MS_ROTATING,
+  /**
+   * the robot is following the black line towards the next intersection
+   */
+  MS_FOLLOWING_LINE,
+  /**
+   * the robot lost the line and it is rotating back and forth to find it again
+   */
+  MS_SEEKING_LINE,
+  /**
+   * the robot found the intersection and it is going ahead a little to reach its center
+   */
+  MS_CENTERING,
+  /**
+   * the robot is going straight for a given distance
+   */
+  MS_STRAIGHT_MOVE,
+  /**
+   * the robot is turning along an arc from the line it followed to the crossing one, without stopping
+   */
+  MS_ARC_TURNING,
+};
+
+/**
+ * The movement command the elementary movements belong to. It tells what to do when an elementary movement ends
+ */
+enum motion_command {
+  /**
+   * a single elementary movement
+   */
+  MC_NONE,
+  /**
+   * a rotation changing the orientation of the robot
+   */
+  MC_TURN,
+  /**
+   * following the line through some cells
+   */
+  MC_GO_AHEAD,
+  /**
+   * following the line through some cells while pushing a block
+   */
+  MC_PUSH_BLOCK,
+  /**
+   * going a bit further after pushing a block, to center it on the intersection
+   */
+  MC_PUSH_CENTERING,
+  /**
+   * going back after centering the block, to center the robot on the intersection
+   */
+  MC_PUSH_BACK,
+  /**
+   * turning along an arc at the end of robotieee::robot::goAheadAndTurn
+   */
+  MC_ARC_TURN,
+};
+
 /**
  * Represents Zumo32U4 robot itself
  */
@@ -145,8 +231,11 @@ public:
   void faceDirection(object_movement targetDirection);
 
   /**
-   * Makes the robot go through a given number of cells.
-   * 
+   * Makes the robot go through a given number of cells. It returns when the robot has stopped.
+   *
+   * The robot counts the intersections without stopping: robotieee::robot::position is updated as soon as each one is
+   * crossed, and the robot slows down and centers itself only on the last one (or on the one after the block, if any).
+   *
    * \note 
    *    \li Before calling this function for the first time, robotieee::robot::harwareInit must have been already run
    * 
@@ -156,6 +245,24 @@ public:
    */
   bool goAhead(unsigned int cells, bool lookingForBlocks = false);
 
+  /**
+   * Makes the robot go through a given number of cells and then face another direction, without stopping in between.
+   *
+   * For a quarter of turn, the robot starts turning along an arc as soon as it finds the last intersection, so that it
+   * leaves it already following the new line: it is much faster than robotieee::robot::goAhead followed by
+   * robotieee::robot::faceDirection, which stops and turns on the spot. To turn back (or if the robot already faces
+   * the direction) the robot stops on the last intersection and turns on the spot as usual.
+   *
+   * \note
+   *    \li after an arc the robot is still moving: the next movement must be a robotieee::robot::goAhead or a
+   *        robotieee::robot::pushBlock in the new direction, which go on at the current speed;
+   *    \li the proximity sensors are not checked: this is meant to execute plans, once the blocks are known.
+   *
+   * @param[in] cells The number of cells to go through
+   * @param[in] nextDirection The direction that the robot needs to face at the end
+   */
+  void goAheadAndTurn(unsigned int cells, object_movement nextDirection);
+
   /**
    * Make the robot folow a black line while checking for a block in the following cell
    * 
@@ -186,6 +293,9 @@ public:
   /**
    * Initializes, configures and calibrates when needed the hardware of
    * the Zumo32U3 robot.
+   *
+   * The calibration is saved in the EEPROM and reused at the next boot, which then takes a few milliseconds.
+   * Keep button A pressed while the robot boots to calibrate again.
    * \note This function needs to be called explicitly before calling any
    * hardware related function of the robotieee::robot class
    */
@@ -198,6 +308,18 @@ public:
    */
   void setSpeed(int16_t speed);
 
+  /**
+   * Sets how fast the robot speeds up and slows down in future movements.
+   *
+   * Rotations and straight movements follow a trapezoidal profile: the speed grows from a low speed to the one set with
+   * robotieee::robot::setSpeed, then falls back to the low speed just before the movement ends, with the deceleration
+   * started from the angle or the distance left. 0 changes the speed at once, as it happened before the profiles.
+   *
+   * @param[in] acceleration the speed increase per second (e.g. 2000 reaches a speed of 400 in 0.2s)
+   * @param[in] deceleration the speed decrease per second
+   */
+  void setAcceleration(uint16_t acceleration, uint16_t deceleration);
+
   /**
    * Sets the speed compensation to be used by the movement-related function.
    * 
@@ -205,6 +327,26 @@ public:
    */
   void setSpeedCompensation(int16_t speedCompensation);
 
+  /**
+   * Sets how the robot follows the line in future movement-related functions
+   *
+   * @param[in] mode robotieee::LFM_PATTERN (default) or robotieee::LFM_PID
+   */
+  void setLineFollowMode(enum line_follow_mode mode);
+
+  /**
+   * Sets the gains of the PID controller used with robotieee::LFM_PID.
+   *
+   * The gains are in thousandths: the speed difference between the motors is
+   * <tt>(proportional * error + integral * sum of errors + derivative * change of error) / 1000</tt>,
+   * where the error is the position of the line under the sensors, from -1000 (left sensor) to 1000 (right sensor)
+   *
+   * @param[in] proportional the proportional gain
+   * @param[in] integral the integral gain
+   * @param[in] derivative the derivative gain
+   */
+  void setLineFollowGains(int16_t proportional, int16_t integral, int16_t derivative);
+
   /**
    * Inverts the speed to be used by every future movement-related function
    */
@@ -228,16 +370,39 @@ public:
    void setExecuteMode();
 
   /**
-   * Sets the value of the centering delay needed in future movement-related functions
+   * Sets how far the robot goes after finding an intersection to center itself on it, in future movement-related functions
+   *
+   * @param[in] centeringDistance the distance in millimeters, measured by the wheel encoders
    */
-  void setCenteringDelay(uint16_t centeringDelay);
+  void setCenteringDistance(uint16_t centeringDistance);
 
   /**
-   * Moves the robot for a given amount of time
-   * 
-   * @param[in] delayMillis The amount of time for the movement in milliseconds
+   * Sets how often the proximity sensors are read while the robot follows the line looking for blocks.
+   *
+   * A block is found only when two readings in a row see it near enough. A reading takes a few milliseconds:
+   * the longer the interval, the nearer the line following gets to the one of the EXECUTE mode
+   *
+   * @param[in] milliseconds the time between two readings (20 by default), 0 to read them at every update
+   */
+  void setProximityInterval(uint16_t milliseconds);
+
+  /**
+   * Looks for blocks with the proximity sensors: in front of the robot, up to two cells away, and in the cells on its sides.
+   *
+   * \note call it with the robot still on an intersection: a block in front of the robot hides the ones behind it
+   *
+   * @param[out] blocks where to put the positions of the blocks found
+   * @param[in] maxBlocks the size of \c blocks: 3 are enough for every block the robot can see
+   * @return the number of blocks found
+   */
+  uint8_t locateBlocks(point* blocks, uint8_t maxBlocks);
+
+  /**
+   * Moves the robot straight for a given distance, measured by the wheel encoders
+   *
+   * @param[in] millimeters The length of the movement
    */
-  void timeMove(uint16_t time);
+  void moveStraight(uint16_t millimeters);
 
   /**
    * Pushes the block forwards by a given amount of cells
@@ -247,30 +412,340 @@ public:
    * @param[in] cells The number of cells to push the block
    */
   void pushBlock(unsigned int cells);
- 
+
+  /**
+   * Starts a rotation without waiting for it to end. See robotieee::robot::rotate
+   *
+   * \note
+   *    \li the movement goes on only when robotieee::robot::update is called;
+   *    \li at the end, robotieee::robot::getMotionResult tells if the rotation stopped on a black line;
+   *
+   * @param[in] degrees The amount of desired rotation in degrees
+   * @param[in] stopIfCenterBlack If true, the rotation will prematurely terminate if the center line sensor finds a black surface
+   */
+  void startRotate(int16_t degrees, bool stopIfCenterBlack = false);
+
+  /**
+   * Starts turning the robot towards a direction without waiting for it to end. See robotieee::robot::faceDirection
+   *
+   * @param[in] targetDirection The direction that the robot needs to face
+   */
+  void startFaceDirection(object_movement targetDirection);
+
+  /**
+   * Starts following the black line without waiting for the robot to reach the intersection. See robotieee::robot::followLine
+   *
+   * \note at the end, robotieee::robot::getMotionResult tells if a block was found
+   *
+   * @param[in] searchBlock Flag to activate the block searching routine while following the black line
+   */
+  void startFollowLine(bool searchBlock = false);
+
+  /**
+   * Starts going through some cells without waiting for the robot to reach the last one. See robotieee::robot::goAhead
+   *
+   * \note at the end, robotieee::robot::getMotionResult tells if the robot stopped after finding a block
+   *
+   * @param[in] cells The number of cells to go through
+   * @param[in] lookingForBlocks If true, the robot will stop early if a block is found
+   */
+  void startGoAhead(unsigned int cells, bool lookingForBlocks = false);
+
+  /**
+   * Starts going through some cells and turning towards another direction, without waiting for the robot to end.
+   * See robotieee::robot::goAheadAndTurn
+   *
+   * @param[in] cells The number of cells to go through
+   * @param[in] nextDirection The direction that the robot needs to face at the end
+   */
+  void startGoAheadAndTurn(unsigned int cells, object_movement nextDirection);
+
+  /**
+   * Starts pushing a block without waiting for the push to end. See robotieee::robot::pushBlock
+   *
+   * @param[in] cells The number of cells to push the block
+   */
+  void startPushBlock(unsigned int cells);
+
+  /**
+   * Starts moving the robot straight, without waiting for it to stop. See robotieee::robot::moveStraight
+   *
+   * @param[in] millimeters The length of the movement
+   */
+  void startMoveStraight(uint16_t millimeters);
+
+  /**
+   * Advances the current movement: reads the sensors it needs and updates the motors accordingly.
+   *
+   * Call it as often as possible (e.g. at every loop()) while the robot is moving: every call takes about the time
+   * needed to read the line sensors, so the rest of the firmware (e.g. the bluetooth communication) can run between
+   * two calls. The blocking functions (robotieee::robot::goAhead, robotieee::robot::rotate, ...) simply call it until the movement ends.
+   *
+   * @return true if the robot is still moving, false if the movement has ended
+   */
+  bool update();
+
+#ifdef TELEMETRY
+  /**
+   * Records the current state of the robot in the telemetry (see telemetry.hpp).
+   *
+   * Call it every TELEMETRY_INTERVAL milliseconds, e.g. from a task of the scheduler
+   */
+  void recordTelemetry();
+#endif
+
+  /**
+   * @return true if a movement started with one of the start functions has not ended yet
+   */
+  bool isMoving();
+
+  /**
+   * @return the result of the last movement ended. Its meaning depends on the movement (e.g. block found for robotieee::robot::startGoAhead)
+   */
+  bool getMotionResult();
+
 private:
   bool _hardwareInitialized;          // Used to avoid multiple hardware initializations.
   int16_t _speed;                     // The speed to be used by the robot in both rotations and straight movement. This values must be in range [-400, 400]
-  uint16_t _centeringDelay;           // The amount of milliseconds to wait after finding an intersection. This is needed to center the robot on the cross
+  uint16_t _centeringDistance;        // The millimeters to go after finding an intersection. This is needed to center the robot on the cross
   uint8_t _pathSeekCompensation;      // The initial number of degrees to rotate when the robot is searching the lost black line. See fixPath function
   int8_t _speedCompensation;          // The speed increase used to make the robot slightly rotate when it arrives at an intersection but it is not parallel to it
-  uint16_t _blockCenteringDelay;      // The amount of milliseconds do wait after finding an intersection. This is needed to center the block on the cross after pushing it
+  uint16_t _blockCenteringDistance;   // The millimeters to go after finding an intersection. This is needed to center the block on the cross after pushing it
   enum object_movement _orientation;  // The direction that the robot is facing
   bool _scanning;                     // A boolean switch representing whether the robot is in SCAN or EXECUTE mode;
   bool _lookLineRight;                // fixPath() optimization: the robot searches for the line alternating between starting turning clockwise and counter-clockwise
-  
+  enum motion_state _motionState;     // The elementary movement the robot is performing
+  enum motion_command _motionCommand; // The command the current elementary movement belongs to
+  bool _motionResult;                 // The result of the last movement ended
+  int16_t _rotationDegrees;           // The amount of degrees of the current rotation
+  bool _rotationStopIfCenterBlack;    // True if the current rotation ends as soon as the center line sensor finds a black surface
+  bool _rotationFoundBlack;           // True if the last rotation ended on a black line
+  int16_t _seekDegrees;               // The rotation fixPath() is trying to find the line again
+  int16_t _leftSpeed;                 // The speed of the left motor while following the line
+  int16_t _rightSpeed;                // The speed of the right motor while following the line
+  bool _searchBlock;                  // True if the proximity sensors are checked while following the line
+  bool _blockFound;                   // True if a block has been found while following the line
+  uint16_t _proximityInterval;        // The milliseconds between two readings of the proximity sensors while following the line
+  uint32_t _lastProximitySample;      // The time of the last reading of the proximity sensors, in milliseconds
+  uint8_t _proximityHits;             // The number of the last readings in a row that saw a block
+  int16_t _leftMotorSpeed;            // The speed last set on the left motor
+  int16_t _rightMotorSpeed;           // The speed last set on the right motor
+#ifdef TELEMETRY
+  int _lineValues[3];                 // The last calibrated readings of the line sensors while following the line
+#endif
+#ifdef TRACE
+  enum motion_state _tracedState;     // The motion state being timed for the traces
+  uint32_t _tracedSince;              // When the robot entered _tracedState, in microseconds
+#endif
+  bool _onIntersection;               // True from when an intermediate intersection is counted until the side sensors leave it
+  int16_t _straightSpeed;             // The speed of the current straight movement (centering or moveStraight)
+  unsigned int _cellsLeft;            // The cells the current goAhead or pushBlock still has to go through
+  uint8_t _turnQuarters;              // The number of clockwise quarters of turn the orientation changes by at the end of the current turn
+  uint8_t _arcQuarters;               // The number of clockwise quarters of turn the robot makes at the end of the current goAhead. 0 if it stops there
+  bool _rolling;                      // True if the last movement ended with the robot moving along a line: the next one goes on at its speed
+  bool _checkAfterTurn;               // True if the proximity sensors are checked at the end of the current turn
+  enum line_follow_mode _lineFollowMode; // How the robot follows the line
+  int16_t _proportionalGain;          // The proportional gain of the line following PID, in thousandths
+  int16_t _integralGain;              // The integral gain of the line following PID, in thousandths
+  int16_t _derivativeGain;            // The derivative gain of the line following PID, in thousandths
+  int16_t _lastLineError;             // The position of the line at the previous reading, from -1000 (left) to 1000 (right)
+  int32_t _lineErrorSum;              // The sum of the positions of the line since the robot started following it
+  int32_t _headingOffset;             // The heading of the robot from the line it follows when the gyro was last reset, in turnAngle units
+  uint16_t _acceleration;             // How fast the speed grows in the motion profiles, in speed units per second. 0 means at once
+  uint16_t _deceleration;             // How fast the speed falls in the motion profiles, in speed units per second. 0 means at once
+  unsigned long _profileStart;        // When the current motion profile has started, in microseconds
+  int16_t _profileSpeed;              // The speed (without sign) commanded by the current motion profile
+  uint16_t _profileTarget;            // The distance the current straight movement has to travel, in millimeters
+  bool _profileBraking;               // True if the robot stops at the end of the current straight movement
+
   /**
    * This function is used internally by the other robot methods to adjust its trajectory
-   * when an error is detected.
+   * when an error is detected: it starts rotating towards the side where the line was seen last,
+   * as far as the gyro says the robot heads away from it.
    */
   void fixPath();
 
+  /**
+   * Starts the next rotation looking for the line, after the previous one failed: it sweeps the other side of the line
+   */
+  void continueSeekingLine();
+
+  /**
+   * @return the heading of the robot from the direction of the line it follows, in turnAngle units. Positive means counter clockwise
+   */
+  int32_t lineHeading();
+
+  /**
+   * Starts an elementary rotation
+   *
+   * @param[in] degrees The amount of desired rotation in degrees
+   * @param[in] stopIfCenterBlack If true, the rotation will prematurely terminate if the center line sensor finds a black surface
+   * @param[in] state either robotieee::MS_ROTATING or robotieee::MS_SEEKING_LINE
+   */
+  void beginRotation(int16_t degrees, bool stopIfCenterBlack, enum motion_state state);
+
+  /**
+   * Advances the current rotation
+   *
+   * @return true if the rotation has ended. robotieee::robot::_rotationFoundBlack tells why
+   */
+  bool updateRotation();
+
+  /**
+   * Starts following the line, keeping the current movement command
+   */
+  void beginFollowLine(bool searchBlock);
+
+  /**
+   * Advances the line following by a single reading of the line sensors
+   */
+  void updateFollowLine();
+
+  /**
+   * Sets the speed of the motors with the PID controller, given the readings of the line sensors
+   *
+   * @param[in] values the calibrated readings of the line sensors
+   * @param[in] lineReadings the same readings, quantised
+   * @param[in] speed the speed of the robot along the line, given by the motion profile
+   */
+  void steerWithPid(const int* values, const struct line_readings& lineReadings, int16_t speed);
+
+  /**
+   * Starts going straight for some distance, keeping the current movement command
+   *
+   * @param[in] millimeters The length of the movement
+   * @param[in] speed The speed of both motors
+   * @param[in] fromStill True if the robot is still, false if it goes on with the speed of the previous movement
+   */
+  void beginStraightMove(uint16_t millimeters, int16_t speed, bool fromStill);
+
+  /**
+   * Advances the current straight movement (centering or moveStraight)
+   *
+   * @return true if the robot has travelled the distance of the movement
+   */
+  bool updateStraightMove();
+
+  /**
+   * @return true if the intersection just found is not the last one of the current command: the robot goes through it
+   */
+  bool passesThroughIntersection();
+
+  /**
+   * Starts turning by a quarter of turn along an arc, from the intersection found to the center of the crossing line
+   *
+   * @param[in] quarters 1 to turn clockwise, 3 to turn counter clockwise
+   */
+  void beginArc(uint8_t quarters);
+
+  /**
+   * Advances the current arc
+   *
+   * @return true if the robot faces the crossing line
+   */
+  bool updateArc();
+
+  /**
+   * Starts a straight movement along the line: from still or, if the last movement ended while moving, at the current speed
+   */
+  void beginOrContinueProfile();
+
+  /**
+   * @return true if the robot stops at the end of the centering on the intersection, false if the current command goes on
+   */
+  bool stopsAfterCentering();
+
+  /**
+   * Starts a new motion profile: the robot is still and has to accelerate
+   */
+  void beginProfile();
+
+  /**
+   * Computes the speed of the current motion profile
+   *
+   * @param[in] cruise the speed to reach
+   * @param[in] remaining the distance left before the end of the movement, in speed units times milliseconds. -1 if there's no need to slow down
+   * @return the speed to command, with the sign of the cruise speed
+   */
+  int16_t updateProfile(int16_t cruise, int32_t remaining);
+
+  /**
+   * @param[in] millimeters a distance
+   * @return about the same distance in the units of the motion profiles, speed units times milliseconds
+   */
+  int32_t toProfileDistance(uint16_t millimeters);
+
+  /**
+   * Starts a rotation changing the orientation of the robot
+   *
+   * @param[in] degrees The amount of desired rotation in degrees
+   * @param[in] quarters The clockwise quarters of turn to add to the orientation when the rotation ends
+   * @param[in] check True to check for a block when the rotation ends
+   */
+  void startTurn(int16_t degrees, uint8_t quarters, bool check);
+
+  /**
+   * Called when an elementary movement ends: starts the next elementary movement of the current command, if any
+   */
+  void endMotion();
+
+  /**
+   * Calls robotieee::robot::update until the current movement ends
+   */
+  void waitMotion();
+
+  /**
+   * Sets the speeds of the motors, remembering them for the telemetry
+   *
+   * @param[in] left the speed of the left motor, in range [-400, 400]
+   * @param[in] right the speed of the right motor, in range [-400, 400]
+   */
+  void setMotorSpeeds(int16_t left, int16_t right);
+
+#ifdef TRACE
+  /**
+   * Records the duration of the last motion state in the traces when the robot enters a new one
+   */
+  void traceMotionState();
+#endif
+
   /**
    * This fuction is used internally by the other robot methods to check, with proximity sensors,
    * if there is a block in front of the robot with the nearest level.
    */
   bool checkForBlock();
+
+  /**
+   * Reads the proximity sensors if robotieee::robot::setProximityInterval milliseconds have passed since the last reading
+   *
+   * @return true if the last readings in a row saw a block
+   */
+  bool sampleProximity();
+
+  /**
+   * Adds a block seen by the proximity sensors to the ones found by robotieee::robot::locateBlocks
+   *
+   * @param[in,out] blocks the positions of the blocks found
+   * @param[in] found the number of blocks in \c blocks
+   * @param[in] maxBlocks the size of \c blocks
+   * @param[in] direction where the block is seen
+   * @param[in] cells how many cells away the block is, 0 if none is seen
+   * @return the number of blocks in \c blocks
+   */
+  uint8_t addBlockCandidate(point* blocks, uint8_t found, uint8_t maxBlocks, object_movement direction, uint8_t cells);
   
+  /**
+   * Calibrates the gyro and the line sensors and saves the calibration in the EEPROM
+   */
+  void calibrate();
+
+  /**
+   * Uses a calibration saved in the EEPROM instead of calibrating the sensors again
+   *
+   * @param[in] calibration the calibration read from the EEPROM
+   */
+  void restoreCalibration(const struct calibration_data& calibration);
+
   /**
    * This function is used to manually calibrate the Zumo32U4 line sensors.
    * This is done by first moving the robot manually on a light surface and
@@ -0,0 +1,38 @@
+/*
+   scheduler.cpp
+
+    Created on: Oct 19, 2026
+        Author: agent
+*/
+#include "scheduler.hpp"
+
+namespace robotieee {
+
+  void schedulerStart(struct scheduled_task* tasks, uint8_t count) {
+    uint32_t now = millis();
+
+    for (uint8_t i = 0; i < count; i++) {
+      tasks[i].nextRun = now;
+      tasks[i].missed = 0;
+    }
+  }
+
+  void schedulerRun(struct scheduled_task* tasks, uint8_t count) {
+    for (uint8_t i = 0; i < count; i++) {
+      struct scheduled_task& task = tasks[i];
+      uint32_t now = millis();
+      // The difference is signed, so the comparisons hold when millis() wraps around
+      int32_t late = (int32_t) (now - task.nextRun);
+
+      if (late < 0) {
+        continue;
+      }
+      if (late > task.deadline) {
+        task.missed++;
+      }
+      task.nextRun = (late >= task.period) ? now + task.period : task.nextRun + task.period;
+      task.run();
+    }
+  }
+
+}
@@ -0,0 +1,87 @@
+/**
+ * @file
+ *
+ * A cooperative scheduler for the main loop: the firmware is split into tasks that run periodically and never wait,
+ * so the control of the motors goes on at a steady rate while the robot talks with the host.
+ *
+ * The tasks are a fixed table, defined by the sketch. The last two fields belong to the scheduler: they are written as
+ * 0, and schedulerStart() sets them:
+ *
+ * @code
+ * struct scheduled_task tasks[] = {
+ *   // run, period, deadline, nextRun, missed
+ *   { updateMotion, 0, 2, 0, 0 },
+ *   { streamTelemetry, 20, 100, 0, 0 },
+ * };
+ *
+ * void setup() {
+ *   schedulerStart(tasks, 2);
+ * }
+ *
+ * void loop() {
+ *   schedulerRun(tasks, 2);
+ * }
+ * @endcode
+ *
+ * The order of the table is the priority of the tasks: in each pass, the tasks that are due run in that order.
+ *
+ * @date Oct 19, 2026
+ * @author agent
+ */
+
+#ifndef SCHEDULER_HPP_
+#define SCHEDULER_HPP_
+
+#include <Arduino.h>
+#include <stdint.h>
+
+namespace robotieee {
+
+/**
+ * A task of the scheduler
+ */
+struct scheduled_task {
+  /**
+   * the function run by the task. It must return quickly: the other tasks wait for it
+   */
+  void (*run)();
+  /**
+   * the milliseconds between two runs, 0 to run it at every pass of the scheduler
+   */
+  uint16_t period;
+  /**
+   * the milliseconds a run can start late before it counts as missed
+   */
+  uint16_t deadline;
+  /**
+   * when the task is due next, in milliseconds. Set by the scheduler
+   */
+  uint32_t nextRun;
+  /**
+   * the runs that started after their deadline. Set by the scheduler
+   */
+  uint16_t missed;
+};
+
+/**
+ * Makes every task of the table due at once
+ *
+ * @param[in,out] tasks the table of the tasks
+ * @param[in] count the number of tasks
+ */
+void schedulerStart(struct scheduled_task* tasks, uint8_t count);
+
+/**
+ * Runs once every task that is due, in the order of the table.
+ *
+ * A task is due again a period after it was due last, so its runs do not drift. If it is late by more than a whole
+ * period, the runs it missed are skipped and it is due a period after now
+ *
+ * @param[in,out] tasks the table of the tasks
+ * @param[in] count the number of tasks
+ */
+void schedulerRun(struct scheduled_task* tasks, uint8_t count);
+
+}
+
+#endif /* SCHEDULER_HPP_ */
@@ -0,0 +1,241 @@
+/*
+   Arduino.cpp
+
+    Created on: Oct 19, 2026
+        Author: agent
+*/
+#include "Arduino.h"
+#include "Wire.h"
+#include "EEPROM.h"
+#include "ZumoSimulator.hpp"
+#include <stdio.h>
+
+/**
+ * how long it takes to read the timer, in microseconds.
+ *
+ * Every busy loop of the firmware reads the time, so this makes sure the simulated time passes even in loops doing nothing else
+ */
+#define TIME_READ_US            4
+/**
+ * how long it takes to access the serial buffers, in microseconds
+ */
+#define SERIAL_ACCESS_US        4
+/**
+ * the clock of the I2C bus after Wire.begin()
+ */
+#define I2C_DEFAULT_CLOCK       100000
+/**
+ * the bits sent on the I2C bus for each byte, acknowledge included
+ */
+#define I2C_BITS_PER_BYTE       9
+/**
+ * the time spent by the start and stop conditions of an I2C transfer, in microseconds
+ */
+#define I2C_START_STOP_US       20
+
+using namespace robotieee;
+
+HardwareSerial Serial1;
+TwoWire Wire;
+EEPROMClass EEPROM;
+
+unsigned long millis() {
+  ZumoSimulator::getInstance()->advance(TIME_READ_US);
+  return ZumoSimulator::getInstance()->now() / 1000;
+}
+
+unsigned long micros() {
+  ZumoSimulator::getInstance()->advance(TIME_READ_US);
+  return ZumoSimulator::getInstance()->now();
+}
+
+void delay(unsigned long ms) {
+  ZumoSimulator::getInstance()->advance((uint64_t)ms * 1000);
+}
+
+void delayMicroseconds(unsigned int us) {
+  ZumoSimulator::getInstance()->advance(us);
+}
+
+void HardwareSerial::begin(unsigned long /* baud */) {
+}
+
+void HardwareSerial::end() {
+  flush();
+}
+
+int HardwareSerial::available() {
+  ZumoSimulator::getInstance()->advance(SERIAL_ACCESS_US);
+  return ZumoSimulator::getInstance()->serialAvailable();
+}
+
+int HardwareSerial::read() {
+  ZumoSimulator::getInstance()->advance(SERIAL_ACCESS_US);
+  return ZumoSimulator::getInstance()->serialRead();
+}
+
+int HardwareSerial::peek() {
+  ZumoSimulator::getInstance()->advance(SERIAL_ACCESS_US);
+  return ZumoSimulator::getInstance()->serialPeek();
+}
+
+int HardwareSerial::availableForWrite() {
+  ZumoSimulator::getInstance()->advance(SERIAL_ACCESS_US);
+  return ZumoSimulator::getInstance()->serialAvailableForWrite();
+}
+
+void HardwareSerial::flush() {
+  ZumoSimulator::getInstance()->serialFlush();
+}
+
+size_t HardwareSerial::write(uint8_t b) {
+  ZumoSimulator::getInstance()->advance(SERIAL_ACCESS_US);
+  ZumoSimulator::getInstance()->serialWrite(b);
+  return 1;
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) {
+  for (size_t i = 0; i < size; i++) {
+    write(buffer[i]);
+  }
+  return size;
+}
+
+size_t HardwareSerial::print(char c) {
+  return write((uint8_t)c);
+}
+
+size_t HardwareSerial::print(const char* s) {
+  return write((const uint8_t*)s, strlen(s));
+}
+
+size_t HardwareSerial::print(int n, int base) {
+  return print((long)n, base);
+}
+
+size_t HardwareSerial::print(unsigned int n, int base) {
+  return print((unsigned long)n, base);
+}
+
+size_t HardwareSerial::print(long n, int base) {
+  char buffer[24];
+
+  if (base == HEX) {
+    snprintf(buffer, sizeof(buffer), "%lX", (unsigned long)n);
+  } else {
+    snprintf(buffer, sizeof(buffer), "%ld", n);
+  }
+  return print(buffer);
+}
+
+size_t HardwareSerial::print(unsigned long n, int base) {
+  char buffer[24];
+
+  snprintf(buffer, sizeof(buffer), base == HEX ? "%lX" : "%lu", n);
+  return print(buffer);
+}
+
+size_t HardwareSerial::println() {
+  return print("\r\n");
+}
+
+size_t HardwareSerial::println(const char* s) {
+  return print(s) + println();
+}
+
+size_t HardwareSerial::println(int n, int base) {
+  return print(n, base) + println();
+}
+
+size_t HardwareSerial::println(unsigned int n, int base) {
+  return print(n, base) + println();
+}
+
+size_t HardwareSerial::println(long n, int base) {
+  return print(n, base) + println();
+}
+
+size_t HardwareSerial::println(unsigned long n, int base) {
+  return print(n, base) + println();
+}
+
+TwoWire::TwoWire() : _clock(I2C_DEFAULT_CLOCK), _address(0), _length(0), _index(0) {
+}
+
+void TwoWire::begin() {
+  _clock = I2C_DEFAULT_CLOCK;
+}
+
+void TwoWire::setClock(uint32_t clock) {
+  _clock = clock;
+}
+
+void TwoWire::beginTransmission(uint8_t address) {
+  _address = address;
+  _length = 0;
+}
+
+size_t TwoWire::write(uint8_t b) {
+  if (_length >= BUFFER_LENGTH) {
+    return 0;
+  }
+  _buffer[_length++] = b;
+  return 1;
+}
+
+size_t TwoWire::write(const uint8_t* data, size_t size) {
+  size_t written = 0;
+
+  while (written < size && write(data[written]) == 1) {
+    written++;
+  }
+  return written;
+}
+
+uint8_t TwoWire::endTransmission(bool /* sendStop */) {
+  // the address byte and the data
+  transfer(1 + _length);
+  uint8_t result = ZumoSimulator::getInstance()->i2cWrite(_address, _buffer, _length);
+  _length = 0;
+  return result;
+}
+
+uint8_t TwoWire::requestFrom(uint8_t address, uint8_t quantity, bool /* sendStop */) {
+  if (quantity > BUFFER_LENGTH) {
+    quantity = BUFFER_LENGTH;
+  }
+  transfer(1 + quantity);
+  _length = ZumoSimulator::getInstance()->i2cRead(address, _buffer, quantity);
+  _index = 0;
+  return _length;
+}
+
+int TwoWire::available() {
+  return _length - _index;
+}
+
+int TwoWire::read() {
+  return _index < _length ? _buffer[_index++] : -1;
+}
+
+void TwoWire::transfer(unsigned int bytes) {
+  ZumoSimulator::getInstance()->advance(I2C_START_STOP_US + (uint64_t)bytes * I2C_BITS_PER_BYTE * 1000000 / _clock);
+}
+
+uint8_t EEPROMClass::read(int address) {
+  return ZumoSimulator::getInstance()->readEeprom(address);
+}
+
+void EEPROMClass::write(int address, uint8_t value) {
+  ZumoSimulator::getInstance()->writeEeprom(address, value);
+}
+
+void EEPROMClass::update(int address, uint8_t value) {
+  if (read(address) != value) {
+    write(address, value);
+  }
+}
+
+uint16_t EEPROMClass::length() {
+  return 1024;
+}
@@ -0,0 +1,235 @@
+/*
+   Zumo32U4.cpp
+
+    Created on: Oct 19, 2026
+        Author: agent
+*/
+#include "Zumo32U4.h"
+#include "Wire.h"
+#include "ZumoSimulator.hpp"
+
+/**
+ * how long it takes to set the speed of the motors, in microseconds
+ */
+#define MOTORS_US               10
+/**
+ * how long it takes to read the encoders, in microseconds
+ */
+#define ENCODERS_US             4
+/**
+ * how long it takes to read the three line sensors with the emitters on, in microseconds
+ */
+#define LINE_SENSORS_US         1000
+/**
+ * how long it takes to read the proximity sensors with both the leds, in microseconds
+ */
+#define PROXIMITY_US            3000
+/**
+ * how long it takes to read the accelerometer over I2C, in microseconds
+ */
+#define ACCELEROMETER_US        200
+/**
+ * how long the user needs to press a button, in microseconds
+ */
+#define BUTTON_US               500000
+/**
+ * I2C address of the L3GD20H of the Zumo32U4 (SA0 high)
+ */
+#define GYRO_ADDRESS            0x6B
+/**
+ * the sub address bit asking the gyro to increment the register address after each byte
+ */
+#define GYRO_AUTO_INCREMENT     0x80
+
+using namespace robotieee;
+
+static int32_t leftEncoderReset = 0;
+static int32_t rightEncoderReset = 0;
+
+void ledRed(bool /* on */) {
+}
+
+void ledGreen(bool /* on */) {
+}
+
+void ledYellow(bool /* on */) {
+}
+
+void Zumo32U4Motors::setSpeeds(int16_t leftSpeed, int16_t rightSpeed) {
+  ZumoSimulator::getInstance()->advance(MOTORS_US);
+  ZumoSimulator::getInstance()->setMotorSpeeds(leftSpeed, rightSpeed);
+}
+
+void Zumo32U4Motors::setLeftSpeed(int16_t speed) {
+  setSpeeds(speed, ZumoSimulator::getInstance()->getRightMotorSpeed());
+}
+
+void Zumo32U4Motors::setRightSpeed(int16_t speed) {
+  setSpeeds(ZumoSimulator::getInstance()->getLeftMotorSpeed(), speed);
+}
+
+int16_t Zumo32U4Encoders::getCountsLeft() {
+  ZumoSimulator::getInstance()->advance(ENCODERS_US);
+  return (int16_t)(ZumoSimulator::getInstance()->getLeftEncoder() - leftEncoderReset);
+}
+
+int16_t Zumo32U4Encoders::getCountsRight() {
+  ZumoSimulator::getInstance()->advance(ENCODERS_US);
+  return (int16_t)(ZumoSimulator::getInstance()->getRightEncoder() - rightEncoderReset);
+}
+
+int16_t Zumo32U4Encoders::getCountsAndResetLeft() {
+  int16_t result = getCountsLeft();
+  leftEncoderReset = ZumoSimulator::getInstance()->getLeftEncoder();
+  return result;
+}
+
+int16_t Zumo32U4Encoders::getCountsAndResetRight() {
+  int16_t result = getCountsRight();
+  rightEncoderReset = ZumoSimulator::getInstance()->getRightEncoder();
+  return result;
+}
+
+Zumo32U4LineSensors::Zumo32U4LineSensors() : calibratedMinimumOn(nullptr), calibratedMaximumOn(nullptr) {
+}
+
+void Zumo32U4LineSensors::initThreeSensors() {
+}
+
+void Zumo32U4LineSensors::initFiveSensors() {
+}
+
+void Zumo32U4LineSensors::calibrate(uint8_t /* readMode */) {
+  ZumoSimulator::getInstance()->advance(10 * LINE_SENSORS_US);
+  // like the real library, the arrays are allocated only if the sketch didn't provide them
+  if (calibratedMinimumOn == nullptr) {
+    calibratedMinimumOn = _minimum;
+  }
+  if (calibratedMaximumOn == nullptr) {
+    calibratedMaximumOn = _maximum;
+  }
+  for (int i = 0; i < 3; i++) {
+    calibratedMinimumOn[i] = 0;
+    calibratedMaximumOn[i] = 1000;
+  }
+}
+
+void Zumo32U4LineSensors::read(unsigned int* sensorValues, uint8_t readMode) {
+  readCalibrated(sensorValues, readMode);
+  // raw readings of the real sensors go from about 100 (white) to 2000 (black)
+  for (int i = 0; i < 3; i++) {
+    sensorValues[i] = 100 + sensorValues[i] * 19 / 10;
+  }
+}
+
+void Zumo32U4LineSensors::readCalibrated(unsigned int* sensorValues, uint8_t /* readMode */) {
+  ZumoSimulator::getInstance()->advance(LINE_SENSORS_US);
+  ZumoSimulator::getInstance()->readLineSensors(sensorValues);
+}
+
+void Zumo32U4ProximitySensors::initThreeSensors() {
+  _frontLeft = 0;
+  _frontRight = 0;
+  _left = 0;
+  _right = 0;
+}
+
+void Zumo32U4ProximitySensors::initFrontSensor() {
+  _frontLeft = 0;
+  _frontRight = 0;
+  _left = 0;
+  _right = 0;
+}
+
+void Zumo32U4ProximitySensors::read() {
+  ZumoSimulator::getInstance()->advance(PROXIMITY_US);
+  ZumoSimulator::getInstance()->readProximity(_frontLeft, _frontRight);
+  ZumoSimulator::getInstance()->readSideProximity(_left, _right);
+}
+
+uint8_t Zumo32U4ProximitySensors::countsFrontWithLeftLeds() const {
+  return _frontLeft;
+}
+
+uint8_t Zumo32U4ProximitySensors::countsFrontWithRightLeds() const {
+  return _frontRight;
+}
+
+uint8_t Zumo32U4ProximitySensors::countsLeftWithLeftLeds() const {
+  return _left;
+}
+
+uint8_t Zumo32U4ProximitySensors::countsRightWithRightLeds() const {
+  return _right;
+}
+
+void Zumo32U4ButtonA::waitForButton() {
+  ZumoSimulator::getInstance()->advance(BUTTON_US);
+}
+
+void Zumo32U4ButtonA::waitForPress() {
+  ZumoSimulator::getInstance()->advance(BUTTON_US);
+}
+
+bool Zumo32U4ButtonA::getSingleDebouncedPress() {
+  ZumoSimulator::getInstance()->advance(BUTTON_US);
+  return true;
+}
+
+bool Zumo32U4ButtonA::isPressed() {
+  return ZumoSimulator::getInstance()->isButtonAHeld();
+}
+
+L3G::L3G() : address(GYRO_ADDRESS) {
+}
+
+bool L3G::init(deviceType /* device */, sa0State /* sa0 */) {
+  g.x = 0;
+  g.y = 0;
+  g.z = 0;
+  return readReg(WHO_AM_I) == 0xD7;
+}
+
+void L3G::writeReg(uint8_t reg, uint8_t value) {
+  Wire.beginTransmission(address);
+  Wire.write(reg);
+  Wire.write(value);
+  Wire.endTransmission();
+}
+
+uint8_t L3G::readReg(uint8_t reg) {
+  Wire.beginTransmission(address);
+  Wire.write(reg);
+  Wire.endTransmission();
+  Wire.requestFrom(address, (uint8_t)1);
+  return Wire.read();
+}
+
+void L3G::read() {
+  Wire.beginTransmission(address);
+  Wire.write(OUT_X_L | GYRO_AUTO_INCREMENT);
+  Wire.endTransmission();
+  Wire.requestFrom(address, (uint8_t)6);
+
+  uint8_t xl = Wire.read();
+  uint8_t xh = Wire.read();
+  uint8_t yl = Wire.read();
+  uint8_t yh = Wire.read();
+  uint8_t zl = Wire.read();
+  uint8_t zh = Wire.read();
+  g.x = (int16_t)(xh << 8 | xl);
+  g.y = (int16_t)(yh << 8 | yl);
+  g.z = (int16_t)(zh << 8 | zl);
+}
+
+void LSM303::read() {
+  readAcc();
+}
+
+void LSM303::readAcc() {
+  ZumoSimulator::getInstance()->advance(ACCELEROMETER_US);
+  // the robot stands on a flat floor: 1g on the z axis
+  a.x = 0;
+  a.y = 0;
+  a.z = 16384;
+}
@@ -0,0 +1,522 @@
+/*
+   ZumoSimulator.cpp
+
+    Created on: Oct 19, 2026
+        Author: agent
+*/
+#include "ZumoSimulator.hpp"
+#include <algorithm>
+#include <math.h>
+
+/**
+ * the longest time simulated in a single integration step, in microseconds
+ */
+#define MAX_STEP_US             1000
+/**
+ * how long it takes to send a byte at 9600 baud, in microseconds
+ */
+#define SERIAL_BYTE_US          1042
+/**
+ * size of the transmit buffer of Serial1: a write waits for a free byte when it is full
+ */
+#define SERIAL_TX_BUFFER        64
+/**
+ * bytes the host can receive before its buffer grows: the allocations of the host stay out of the ones of the firmware
+ */
+#define HOST_RECEIVE_CAPACITY   4096
+/**
+ * sensitivity of the gyro at 2000 dps full scale
+ */
+#define GYRO_DPS_PER_DIGIT      0.07
+/**
+ * time between two samples of the gyro (800Hz output data rate), in microseconds
+ */
+#define GYRO_SAMPLE_US          1250
+/**
+ * I2C address of the L3GD20H (SA0 high)
+ */
+#define GYRO_ADDRESS            0x6B
+/**
+ * size of the FIFO of the gyro, in samples
+ */
+#define GYRO_FIFO_SIZE          32
+#define GYRO_WHO_AM_I           0x0F
+#define GYRO_CTRL5              0x24
+#define GYRO_STATUS_REG         0x27
+#define GYRO_OUT_X_L            0x28
+#define GYRO_OUT_Z_H            0x2D
+#define GYRO_FIFO_CTRL          0x2E
+#define GYRO_FIFO_SRC           0x2F
+/**
+ * the sub address bit asking for the register address to increment after each byte
+ */
+#define I2C_AUTO_INCREMENT      0x80
+/**
+ * how long it takes to write a byte of the EEPROM, in microseconds
+ */
+#define EEPROM_WRITE_US         3300
+/**
+ * the proximity sensors see a block only within this angle from the front of the robot, in degrees
+ */
+#define PROXIMITY_HALF_ANGLE    25
+/**
+ * the levels seen by the proximity sensors are lowered by one when the block is beyond this angle on the other side
+ */
+#define PROXIMITY_SIDE_ANGLE    10
+
+namespace robotieee {
+
+  /**
+   * a block nearer than PROXIMITY_THRESHOLDS[i] millimeters from the front of the robot is seen with level 6 - i
+   */
+  static const double PROXIMITY_THRESHOLDS[] = {200, 260, 330, 420, 520, 640};
+
+  SimulatorConfig defaultSimulatorConfig() {
+    SimulatorConfig config;
+
+    config.rows                       = 5;
+    config.columns                    = 5;
+    config.cellSize                   = 200;
+    config.lineWidth                  = 19;
+    config.maxWheelSpeed              = 600;
+    config.motorImbalance             = 0.02;
+    config.wheelBase                  = 85;
+    config.motorTimeConstant          = 0.02;
+    config.frontDistance              = 50;
+    config.halfWidth                  = 49;
+    config.lineSensorForward          = 40;
+    config.lineSensorSide             = 22;
+    config.lineSensorRadius           = 6;
+    config.blockSize                  = 50;
+    config.gyroBias                   = 25;
+    config.gyroDrift                  = 0.5;
+    config.gyroNoise                  = 3;
+    config.lineSensorNoise            = 20;
+    // 75:1 gearbox, 12 counts per motor revolution, 39mm wheels
+    config.encoderCountsPerMillimeter = 909.7 / (M_PI * 39);
+    config.seed                       = 1;
+    return config;
+  }
+
+  ZumoSimulator::ZumoSimulator() {
+    reset(defaultSimulatorConfig());
+  }
+
+  ZumoSimulator* ZumoSimulator::getInstance() {
+    static ZumoSimulator instance; /* The single instance */
+
+    return &instance;
+  }
+
+  void ZumoSimulator::reset(const SimulatorConfig& config) {
+    _config = config;
+    _random.seed(config.seed);
+    _now = 0;
+    _leftWheel = 0;
+    _rightWheel = 0;
+    _leftCommand = 0;
+    _rightCommand = 0;
+    _angularRate = 0;
+    _leftTravel = 0;
+    _rightTravel = 0;
+    _distance = 0;
+    _blocks.clear();
+    _toRobot.clear();
+    _fromRobot.clear();
+    // the firmware must not see the host allocate while it writes on Serial1
+    _fromRobot.reserve(HOST_RECEIVE_CAPACITY);
+    _serialPending = 0;
+    _serialClock = 0;
+    memset(_gyroRegisters, 0, sizeof(_gyroRegisters));
+    _gyroRegisters[GYRO_WHO_AM_I] = 0xD7;
+    _gyroPointer = 0;
+    _gyroAutoIncrement = false;
+    _gyroFifo.clear();
+    _gyroOverrun = false;
+    _gyroOutput = 0;
+    _gyroNewData = false;
+    _nextGyroSample = GYRO_SAMPLE_US;
+    memset(_eeprom, 0xFF, sizeof(_eeprom));
+    _eepromWrites = 0;
+    _buttonAHeld = false;
+    placeRobot(0, 0, 2);
+  }
+
+  const SimulatorConfig& ZumoSimulator::getConfig() const {
+    return _config;
+  }
+
+  void ZumoSimulator::placeRobot(unsigned int row, unsigned int column, unsigned int direction) {
+    static const double headings[] = {M_PI / 2, 0, -M_PI / 2, M_PI};
+
+    _x = (column + 0.5) * _config.cellSize;
+    _y = (row + 0.5) * _config.cellSize;
+    _heading = headings[direction % 4];
+    _leftWheel = 0;
+    _rightWheel = 0;
+    _angularRate = 0;
+  }
+
+  void ZumoSimulator::addBlock(unsigned int row, unsigned int column) {
+    _blocks.push_back(SimulatedBlock{(column + 0.5) * _config.cellSize, (row + 0.5) * _config.cellSize});
+  }
+
+  double ZumoSimulator::getX() const {
+    return _x;
+  }
+
+  double ZumoSimulator::getY() const {
+    return _y;
+  }
+
+  double ZumoSimulator::getHeading() const {
+    return _heading * 180 / M_PI;
+  }
+
+  int ZumoSimulator::getRow() const {
+    return (int)floor(_y / _config.cellSize);
+  }
+
+  int ZumoSimulator::getColumn() const {
+    return (int)floor(_x / _config.cellSize);
+  }
+
+  const std::vector<SimulatedBlock>& ZumoSimulator::getBlocks() const {
+    return _blocks;
+  }
+
+  double ZumoSimulator::getDistanceTravelled() const {
+    return _distance;
+  }
+
+  uint64_t ZumoSimulator::now() const {
+    return _now;
+  }
+
+  void ZumoSimulator::advance(uint64_t micros) {
+    while (micros > 0) {
+      uint64_t dt = micros < MAX_STEP_US ? micros : MAX_STEP_US;
+      step(dt / 1e6);
+      _now += dt;
+      micros -= dt;
+      sampleGyro();
+    }
+  }
+
+  void ZumoSimulator::step(double seconds) {
+    double leftTarget = _leftCommand * _config.maxWheelSpeed * (1 - _config.motorImbalance) / 400;
+    double rightTarget = _rightCommand * _config.maxWheelSpeed * (1 + _config.motorImbalance) / 400;
+    double response = _config.motorTimeConstant > 0 ? 1 - exp(-seconds / _config.motorTimeConstant) : 1;
+
+    _leftWheel += (leftTarget - _leftWheel) * response;
+    _rightWheel += (rightTarget - _rightWheel) * response;
+
+    double speed = (_leftWheel + _rightWheel) / 2;
+    _angularRate = (_rightWheel - _leftWheel) / _config.wheelBase;
+
+    // integrate with the heading in the middle of the step
+    double heading = _heading + _angularRate * seconds / 2;
+    _x += speed * cos(heading) * seconds;
+    _y -= speed * sin(heading) * seconds;
+    _heading += _angularRate * seconds;
+    _leftTravel += _leftWheel * seconds;
+    _rightTravel += _rightWheel * seconds;
+    _distance += fabs(speed) * seconds;
+
+    // the front of the robot pushes every block it touches
+    double forwardX = cos(_heading);
+    double forwardY = -sin(_heading);
+    double contact = _config.frontDistance + _config.blockSize / 2;
+    for (unsigned int i = 0; i < _blocks.size(); i++) {
+      double dx = _blocks[i].x - _x;
+      double dy = _blocks[i].y - _y;
+      double along = dx * forwardX + dy * forwardY;
+      double lateral = dx * forwardY - dy * forwardX;
+      if (along > 0 && along < contact && fabs(lateral) < _config.halfWidth + _config.blockSize / 2) {
+        _blocks[i].x += (contact - along) * forwardX;
+        _blocks[i].y += (contact - along) * forwardY;
+      }
+    }
+  }
+
+  double ZumoSimulator::lineCoverage(double x, double y) const {
+    double size = _config.cellSize;
+    int row = (int)floor(y / size);
+    int column = (int)floor(x / size);
+
+    // the lines cross the whole arena, so the sensors see a full intersection on the borders as well
+    if (row < 0 || row >= (int)_config.rows || column < 0 || column >= (int)_config.columns) {
+      return 0;
+    }
+    // distance from the nearest line: the horizontal one of the row or the vertical one of the column
+    double distance = std::min(fabs(y - (row + 0.5) * size), fabs(x - (column + 0.5) * size));
+    double radius = _config.lineSensorRadius;
+    double coverage = radius > 0 ? (_config.lineWidth / 2 + radius - distance) / (2 * radius) : (distance <= _config.lineWidth / 2 ? 1 : 0);
+
+    return coverage < 0 ? 0 : (coverage > 1 ? 1 : coverage);
+  }
+
+  void ZumoSimulator::setMotorSpeeds(int16_t left, int16_t right) {
+    _leftCommand = left > 400 ? 400 : (left < -400 ? -400 : left);
+    _rightCommand = right > 400 ? 400 : (right < -400 ? -400 : right);
+  }
+
+  int16_t ZumoSimulator::getLeftMotorSpeed() const {
+    return _leftCommand;
+  }
+
+  int16_t ZumoSimulator::getRightMotorSpeed() const {
+    return _rightCommand;
+  }
+
+  void ZumoSimulator::readLineSensors(unsigned int values[3]) {
+    std::normal_distribution<double> noise(0, _config.lineSensorNoise);
+    double forwardX = cos(_heading);
+    double forwardY = -sin(_heading);
+    // left of the robot
+    double sideX = -sin(_heading);
+    double sideY = -cos(_heading);
+
+    for (int i = 0; i < 3; i++) {
+      double offset = (1 - i) * _config.lineSensorSide;
+      double x = _x + forwardX * _config.lineSensorForward + sideX * offset;
+      double y = _y + forwardY * _config.lineSensorForward + sideY * offset;
+      double value = lineCoverage(x, y) * 1000 + noise(_random);
+      values[i] = value < 0 ? 0 : (value > 1000 ? 1000 : (unsigned int)value);
+    }
+  }
+
+  int16_t ZumoSimulator::readGyroZ() {
+    std::normal_distribution<double> noise(0, _config.gyroNoise);
+    double degreesPerSecond = _angularRate * 180 / M_PI;
+    double value = degreesPerSecond / GYRO_DPS_PER_DIGIT + _config.gyroBias + _config.gyroDrift * (_now / 1e6) + noise(_random);
+
+    return value > 32767 ? 32767 : (value < -32768 ? -32768 : (int16_t)lround(value));
+  }
+
+  void ZumoSimulator::sampleGyro() {
+    while (_now >= _nextGyroSample) {
+      _gyroOutput = readGyroZ();
+      _gyroNewData = true;
+      // FIFO_EN in CTRL5 and a mode different from bypass in FIFO_CTRL
+      if ((_gyroRegisters[GYRO_CTRL5] & 0x40) != 0 && (_gyroRegisters[GYRO_FIFO_CTRL] & 0xE0) != 0) {
+        if (_gyroFifo.size() == GYRO_FIFO_SIZE) {
+          // stream mode drops the oldest sample, FIFO mode stops collecting
+          if ((_gyroRegisters[GYRO_FIFO_CTRL] & 0xE0) == 0x40) {
+            _gyroFifo.pop_front();
+            _gyroFifo.push_back(_gyroOutput);
+          }
+          _gyroOverrun = true;
+        } else {
+          _gyroFifo.push_back(_gyroOutput);
+        }
+      }
+      _nextGyroSample += GYRO_SAMPLE_US;
+    }
+  }
+
+  uint8_t ZumoSimulator::readGyroRegister(uint8_t reg) {
+    bool fifo = (_gyroRegisters[GYRO_CTRL5] & 0x40) != 0 && !_gyroFifo.empty();
+    int16_t z = fifo ? _gyroFifo.front() : _gyroOutput;
+
+    switch (reg) {
+      case GYRO_STATUS_REG:
+        return _gyroNewData ? 0x08 : 0;
+      case GYRO_FIFO_SRC: {
+        uint8_t level = _gyroFifo.size() >= GYRO_FIFO_SIZE ? GYRO_FIFO_SIZE - 1 : _gyroFifo.size();
+        return (_gyroOverrun ? 0x40 : 0) | (_gyroFifo.empty() ? 0x20 : 0) | level;
+      }
+      case GYRO_OUT_X_L + 4:
+        return z & 0xFF;
+      case GYRO_OUT_Z_H:
+        _gyroNewData = false;
+        if (fifo) {
+          _gyroFifo.pop_front();
+          _gyroOverrun = false;
+        }
+        return (z >> 8) & 0xFF;
+      default:
+        // the x and y axis always read 0
+        return reg >= GYRO_OUT_X_L && reg < GYRO_OUT_Z_H ? 0 : _gyroRegisters[reg & 0x3F];
+    }
+  }
+
+  uint8_t ZumoSimulator::i2cWrite(uint8_t address, const uint8_t* data, unsigned int size) {
+    if (address != GYRO_ADDRESS) {
+      return 2;
+    }
+    if (size > 0) {
+      _gyroPointer = data[0] & ~I2C_AUTO_INCREMENT;
+      _gyroAutoIncrement = (data[0] & I2C_AUTO_INCREMENT) != 0;
+    }
+    for (unsigned int i = 1; i < size; i++) {
+      _gyroRegisters[_gyroPointer & 0x3F] = data[i];
+      // going back to bypass mode empties the FIFO
+      if ((_gyroPointer & 0x3F) == GYRO_FIFO_CTRL && (data[i] & 0xE0) == 0) {
+        _gyroFifo.clear();
+        _gyroOverrun = false;
+      }
+      if (_gyroAutoIncrement) {
+        _gyroPointer++;
+      }
+    }
+    return 0;
+  }
+
+  unsigned int ZumoSimulator::i2cRead(uint8_t address, uint8_t* data, unsigned int size) {
+    if (address != GYRO_ADDRESS) {
+      return 0;
+    }
+    for (unsigned int i = 0; i < size; i++) {
+      bool fifo = (_gyroRegisters[GYRO_CTRL5] & 0x40) != 0;
+      data[i] = readGyroRegister(_gyroPointer);
+      if (_gyroAutoIncrement) {
+        // with the FIFO enabled the address rolls back to OUT_X_L after OUT_Z_H, so the samples can be read in a single burst
+        _gyroPointer = (fifo && _gyroPointer == GYRO_OUT_Z_H) ? GYRO_OUT_X_L : _gyroPointer + 1;
+      }
+    }
+    return size;
+  }
+
+  uint8_t ZumoSimulator::proximityLevel(const SimulatedBlock& block, double direction, double sensorDistance, double& angle) const {
+    double forwardX = cos(_heading + direction);
+    double forwardY = -sin(_heading + direction);
+    double dx = block.x - _x;
+    double dy = block.y - _y;
+    double along = dx * forwardX + dy * forwardY;
+    // positive when the block is on the left
+    double lateral = dx * forwardY - dy * forwardX;
+    double gap = along - sensorDistance - _config.blockSize / 2;
+
+    angle = atan2(lateral, along) * 180 / M_PI;
+    if (along <= 0 || fabs(angle) > PROXIMITY_HALF_ANGLE) {
+      return 0;
+    }
+    for (unsigned int t = 0; t < sizeof(PROXIMITY_THRESHOLDS) / sizeof(PROXIMITY_THRESHOLDS[0]); t++) {
+      if (gap < PROXIMITY_THRESHOLDS[t]) {
+        return 6 - t;
+      }
+    }
+    return 0;
+  }
+
+  void ZumoSimulator::readProximity(uint8_t& left, uint8_t& right) {
+    left = 0;
+    right = 0;
+    for (unsigned int i = 0; i < _blocks.size(); i++) {
+      double angle;
+      uint8_t level = proximityLevel(_blocks[i], 0, _config.frontDistance, angle);
+      uint8_t l = (level > 0 && angle < -PROXIMITY_SIDE_ANGLE) ? level - 1 : level;
+      uint8_t r = (level > 0 && angle > PROXIMITY_SIDE_ANGLE) ? level - 1 : level;
+      left = l > left ? l : left;
+      right = r > right ? r : right;
+    }
+  }
+  void ZumoSimulator::readSideProximity(uint8_t& left, uint8_t& right) {
+    left = 0;
+    right = 0;
+    for (unsigned int i = 0; i < _blocks.size(); i++) {
+      double angle;
+      uint8_t l = proximityLevel(_blocks[i], M_PI / 2, _config.halfWidth, angle);
+      uint8_t r = proximityLevel(_blocks[i], -M_PI / 2, _config.halfWidth, angle);
+      left = l > left ? l : left;
+      right = r > right ? r : right;
+    }
+  }
+
+
+  int32_t ZumoSimulator::getLeftEncoder() const {
+    return (int32_t)lround(_leftTravel * _config.encoderCountsPerMillimeter);
+  }
+
+  int32_t ZumoSimulator::getRightEncoder() const {
+    return (int32_t)lround(_rightTravel * _config.encoderCountsPerMillimeter);
+  }
+
+  uint8_t ZumoSimulator::readEeprom(unsigned int address) const {
+    return _eeprom[address % sizeof(_eeprom)];
+  }
+
+  void ZumoSimulator::writeEeprom(unsigned int address, uint8_t value) {
+    advance(EEPROM_WRITE_US);
+    _eeprom[address % sizeof(_eeprom)] = value;
+    _eepromWrites++;
+  }
+
+  unsigned int ZumoSimulator::getEepromWrites() const {
+    return _eepromWrites;
+  }
+
+  void ZumoSimulator::setButtonAHeld(bool held) {
+    _buttonAHeld = held;
+  }
+
+  bool ZumoSimulator::isButtonAHeld() const {
+    return _buttonAHeld;
+  }
+
+  void ZumoSimulator::hostSend(const uint8_t* data, unsigned int size) {
+    _toRobot.insert(_toRobot.end(), data, data + size);
+  }
+
+  std::vector<uint8_t> ZumoSimulator::hostReceive() {
+    std::vector<uint8_t> result(_fromRobot);
+
+    _fromRobot.clear();
+    return result;
+  }
+
+  int ZumoSimulator::serialAvailable() const {
+    return _toRobot.size();
+  }
+
+  int ZumoSimulator::serialRead() {
+    if (_toRobot.empty()) {
+      return -1;
+    }
+    uint8_t result = _toRobot.front();
+    _toRobot.pop_front();
+    return result;
+  }
+
+  int ZumoSimulator::serialPeek() const {
+    return _toRobot.empty() ? -1 : _toRobot.front();
+  }
+
+  int ZumoSimulator::serialAvailableForWrite() {
+    drainSerial();
+    return SERIAL_TX_BUFFER - _serialPending;
+  }
+
+  void ZumoSimulator::serialWrite(uint8_t b) {
+    drainSerial();
+    if (_serialPending == SERIAL_TX_BUFFER) {
+      // wait for the oldest byte to leave
+      advance(_serialClock + SERIAL_BYTE_US - _now);
+      drainSerial();
+    }
+    _fromRobot.push_back(b);
+    _serialPending++;
+  }
+
+  void ZumoSimulator::serialFlush() {
+    drainSerial();
+    if (_serialPending > 0) {
+      advance(_serialClock + (uint64_t)_serialPending * SERIAL_BYTE_US - _now);
+      drainSerial();
+    }
+  }
+
+  void ZumoSimulator::drainSerial() {
+    uint64_t sent = (_now - _serialClock) / SERIAL_BYTE_US;
+
+    if (sent >= _serialPending) {
+      _serialPending = 0;
+      _serialClock = _now;
+    } else {
+      _serialPending -= sent;
+      _serialClock += sent * SERIAL_BYTE_US;
+    }
+  }
+
+}
@@ -0,0 +1,421 @@
+/**
+ * @file
+ *
+ * A simulated Zumo32U4 moving on a virtual grid of black lines, used to run the firmware on the host.
+ *
+ * The fake Arduino and Zumo32U4 headers in simulator/include forward every hardware access here:
+ * \li the motors drive a differential drive model (with a first order response of the motors);
+ * \li the line sensors read the black lines of the grid (one line per row and per column, crossing in the center of each cell);
+ * \li the gyro reports the angular rate of the robot, plus a bias, a drift and some noise. It is an L3GD20H on the I2C bus,
+ *     sampling at 800Hz, with its FIFO and the registers the firmware uses;
+ * \li the proximity sensors see the blocks in front of the robot and on its sides. Blocks are pushed by the front of the robot;
+ * \li the encoders count the revolutions of the wheels;
+ * \li Serial1 is a pair of byte queues the test program can fill and empty;
+ * \li the EEPROM keeps its content until the simulation is reset, so a test can reboot the firmware on the same robot.
+ *
+ * Time is simulated: it advances only with delay() and with the cost of each hardware access (e.g. reading the gyro
+ * over I2C takes a few hundreds microseconds), so the firmware busy loops run much faster than real time and the
+ * simulation is deterministic for a given seed.
+ *
+ * @date Oct 19, 2026
+ * @author agent
+ */
+
+#ifndef ZUMO_SIMULATOR_HPP_
+#define ZUMO_SIMULATOR_HPP_
+
+#include <deque>
+#include <string.h>
+#include <random>
+#include <stdint.h>
+#include <vector>
+
+namespace robotieee {
+
+/**
+ * The physical parameters of the simulation. Distances are in millimeters, angles in degrees
+ */
+struct SimulatorConfig {
+  /**
+   * number of rows of the grid
+   */
+  unsigned int rows;
+  /**
+   * number of columns of the grid
+   */
+  unsigned int columns;
+  /**
+   * distance between two adjacent intersections
+   */
+  double cellSize;
+  /**
+   * width of the black lines
+   */
+  double lineWidth;
+  /**
+   * speed of a wheel when the motor is set to 400, in mm/s
+   */
+  double maxWheelSpeed;
+  /**
+   * relative difference between the motors: the left wheel goes (1 - motorImbalance) times the nominal speed, the right one (1 + motorImbalance) times
+   */
+  double motorImbalance;
+  /**
+   * distance between the wheels
+   */
+  double wheelBase;
+  /**
+   * time constant of the motors response, in seconds
+   */
+  double motorTimeConstant;
+  /**
+   * distance between the center of the robot and its front
+   */
+  double frontDistance;
+  /**
+   * half the width of the robot
+   */
+  double halfWidth;
+  /**
+   * distance between the center of the robot and the line sensors, going forward
+   */
+  double lineSensorForward;
+  /**
+   * distance between the central line sensor and the side ones
+   */
+  double lineSensorSide;
+  /**
+   * radius of the spot of floor each line sensor sees: a sensor partially over a line reads a value between white and black
+   */
+  double lineSensorRadius;
+  /**
+   * side of a block
+   */
+  double blockSize;
+  /**
+   * constant error of the gyro, in digits
+   */
+  double gyroBias;
+  /**
+   * how fast the error of the gyro changes, in digits per second
+   */
+  double gyroDrift;
+  /**
+   * standard deviation of the noise of the gyro, in digits
+   */
+  double gyroNoise;
+  /**
+   * standard deviation of the noise of the line sensors, in calibrated units (0-1000)
+   */
+  double lineSensorNoise;
+  /**
+   * encoder counts per millimeter travelled by a wheel
+   */
+  double encoderCountsPerMillimeter;
+  /**
+   * seed of the random generator
+   */
+  uint32_t seed;
+};
+
+/**
+ * @return a configuration of a Zumo32U4 with 75:1 motors on a grid of 20cm cells
+ */
+SimulatorConfig defaultSimulatorConfig();
+
+/**
+ * A block in the arena. Coordinates are in millimeters: (0,0) is the top left corner, y grows downwards
+ */
+struct SimulatedBlock {
+  double x;
+  double y;
+};
+
+/**
+ * The simulated world: robot, blocks, grid and simulated time.
+ *
+ * This class is a Singleton, like the hardware it replaces: use ZumoSimulator::getInstance() to access it.
+ *
+ * @code
+ * ZumoSimulator* sim = ZumoSimulator::getInstance();
+ * sim->reset(defaultSimulatorConfig());
+ * sim->placeRobot(0, 0, DOWN);
+ * sim->addBlock(2, 0);
+ * zumo_robot.goAhead(1, true); //runs the firmware on the simulated hardware
+ * @endcode
+ */
+class ZumoSimulator {
+public:
+  /**
+   * @return the only instance of the simulator
+   */
+  static ZumoSimulator* getInstance();
+  ZumoSimulator(const ZumoSimulator& other) = delete;
+  ZumoSimulator& operator=(const ZumoSimulator& other) = delete;
+
+  /**
+   * Restart the simulation: time goes back to 0, the robot is put still in the center of cell (0,0) facing down,
+   * every block and byte in the serial queues is removed, the EEPROM is erased and no button is held
+   *
+   * @param[in] config the parameters of the new simulation
+   */
+  void reset(const SimulatorConfig& config);
+  /**
+   * @return the parameters of the current simulation
+   */
+  const SimulatorConfig& getConfig() const;
+
+  /**
+   * Put the robot, still, in the center of a cell
+   *
+   * @param[in] row the row of the cell
+   * @param[in] column the column of the cell
+   * @param[in] direction where the robot faces: 0 up, 1 right, 2 down, 3 left (like robotieee::object_movement)
+   */
+  void placeRobot(unsigned int row, unsigned int column, unsigned int direction);
+  /**
+   * Put a block in the center of a cell
+   */
+  void addBlock(unsigned int row, unsigned int column);
+
+  /**
+   * @return the x coordinate of the center of the robot, in millimeters
+   */
+  double getX() const;
+  /**
+   * @return the y coordinate of the center of the robot, in millimeters
+   */
+  double getY() const;
+  /**
+   * @return the orientation of the robot in degrees, counter clockwise. 0 means facing right, 90 facing up
+   */
+  double getHeading() const;
+  /**
+   * @return the row of the intersection nearest to the robot
+   */
+  int getRow() const;
+  /**
+   * @return the column of the intersection nearest to the robot
+   */
+  int getColumn() const;
+  /**
+   * @return the blocks in the arena
+   */
+  const std::vector<SimulatedBlock>& getBlocks() const;
+  /**
+   * @return the total distance travelled by the center of the robot, in millimeters
+   */
+  double getDistanceTravelled() const;
+
+  /**
+   * @return the simulated time, in microseconds
+   */
+  uint64_t now() const;
+  /**
+   * Let the simulated time pass, moving the robot and the blocks accordingly
+   *
+   * @param[in] micros the microseconds to simulate
+   */
+  void advance(uint64_t micros);
+
+  /**
+   * Set the speed of the motors, in the Zumo32U4Motors units (-400, 400)
+   */
+  void setMotorSpeeds(int16_t left, int16_t right);
+  int16_t getLeftMotorSpeed() const;
+  int16_t getRightMotorSpeed() const;
+
+  /**
+   * Read the left, central and right line sensors
+   *
+   * @param[out] values the calibrated readings: 0 is white, 1000 is black
+   */
+  void readLineSensors(unsigned int values[3]);
+  /**
+   * @return the angular rate around the z axis the gyro measures now, in digits of 0.07 dps. Positive means counter clockwise
+   */
+  int16_t readGyroZ();
+  /**
+   * Write bytes to a device on the I2C bus, like a Wire transmission: the first byte is the register address
+   *
+   * @param[in] address the 7 bit address of the device
+   * @param[in] data the bytes to write
+   * @param[in] size the number of bytes to write
+   * @return 0 if the device acknowledged, 2 if there is no device at the address (like Wire.endTransmission)
+   */
+  uint8_t i2cWrite(uint8_t address, const uint8_t* data, unsigned int size);
+  /**
+   * Read bytes from a device on the I2C bus, starting from the register set by the last write
+   *
+   * @param[in] address the 7 bit address of the device
+   * @param[out] data where to put the bytes read
+   * @param[in] size the number of bytes to read
+   * @return the number of bytes read, 0 if there is no device at the address
+   */
+  unsigned int i2cRead(uint8_t address, uint8_t* data, unsigned int size);
+  /**
+   * Compute the brightness levels (0-6) the front proximity sensor sees
+   *
+   * @param[out] left the level seen with the left leds
+   * @param[out] right the level seen with the right leds
+   */
+  void readProximity(uint8_t& left, uint8_t& right);
+  /**
+   * Compute the brightness levels (0-6) the side proximity sensors see, each one lit by the leds on its side
+   *
+   * @param[out] left the level seen by the left sensor
+   * @param[out] right the level seen by the right sensor
+   */
+  void readSideProximity(uint8_t& left, uint8_t& right);
+  /**
+   * @return the encoder counts of the left wheel since the beginning of the simulation
+   */
+  int32_t getLeftEncoder() const;
+  /**
+   * @return the encoder counts of the right wheel since the beginning of the simulation
+   */
+  int32_t getRightEncoder() const;
+
+  /**
+   * @param[in] address an address of the EEPROM (1024 bytes, like the ATmega32U4). Addresses beyond the end wrap around
+   * @return the byte stored in the EEPROM at the given address, 0xFF if it was never written
+   */
+  uint8_t readEeprom(unsigned int address) const;
+  /**
+   * Store a byte in the EEPROM. It takes the 3.3ms of a real EEPROM write
+   */
+  void writeEeprom(unsigned int address, uint8_t value);
+  /**
+   * @return the number of bytes written in the EEPROM since the simulation was reset
+   */
+  unsigned int getEepromWrites() const;
+
+  /**
+   * Hold or release button A
+   *
+   * @param[in] held true if the user keeps button A pressed
+   */
+  void setButtonAHeld(bool held);
+  /**
+   * @return true if button A is held
+   */
+  bool isButtonAHeld() const;
+
+  /**
+   * Queue bytes the robot will receive from Serial1
+   */
+  void hostSend(const uint8_t* data, unsigned int size);
+  /**
+   * Fetch the bytes the robot sent with Serial1
+   *
+   * @return the bytes sent, removed from the queue
+   */
+  std::vector<uint8_t> hostReceive();
+  /**
+   * @return the number of bytes the robot can read
+   */
+  int serialAvailable() const;
+  /**
+   * @return the next byte the robot reads, -1 if there's nothing to read
+   */
+  int serialRead();
+  /**
+   * @return the next byte the robot reads without removing it, -1 if there's nothing to read
+   */
+  int serialPeek() const;
+  /**
+   * @return the number of bytes the robot can send without waiting: the free space in the transmit buffer
+   */
+  int serialAvailableForWrite();
+  /**
+   * Send a byte to the host. The byte waits in the transmit buffer until the previous ones have left at 9600 baud:
+   * if the buffer is full, the robot waits for a free place
+   */
+  void serialWrite(uint8_t b);
+  /**
+   * Wait until every byte sent by the robot has left the serial port (at 9600 baud)
+   */
+  void serialFlush();
+private:
+  ZumoSimulator();
+  void step(double seconds);
+  /**
+   * @return how much of the spot seen by a line sensor in (x,y) is covered by a black line, from 0 to 1
+   */
+  double lineCoverage(double x, double y) const;
+  /**
+   * Produce the samples of the gyro up to the current time
+   */
+  void sampleGyro();
+  /**
+   * Read a register of the gyro, popping a sample from the FIFO when the last output register is read
+   */
+  uint8_t readGyroRegister(uint8_t reg);
+  /**
+   * Remove from the transmit buffer of Serial1 the bytes sent to the host up to the current time
+   */
+  void drainSerial();
+  /**
+   * Compute the brightness level (0-6) a proximity sensor sees a block with
+   *
+   * @param[in] block the block
+   * @param[in] direction where the sensor looks, in radians counter clockwise from the front of the robot
+   * @param[in] sensorDistance the distance between the center of the robot and the sensor
+   * @param[out] angle the angle between where the sensor looks and the block, in degrees, positive on the left
+   * @return the level, 0 if the sensor does not see the block
+   */
+  uint8_t proximityLevel(const SimulatedBlock& block, double direction, double sensorDistance, double& angle) const;
+private:
+  SimulatorConfig _config;
+  std::mt19937 _random;
+  uint64_t _now;
+  double _x;
+  double _y;
+  /**
+   * heading in radians, counter clockwise from the x axis
+   */
+  double _heading;
+  double _angularRate;
+  double _leftWheel;
+  double _rightWheel;
+  int16_t _leftCommand;
+  int16_t _rightCommand;
+  double _leftTravel;
+  double _rightTravel;
+  double _distance;
+  std::vector<SimulatedBlock> _blocks;
+  std::deque<uint8_t> _toRobot;
+  std::vector<uint8_t> _fromRobot;
+  /**
+   * the bytes in the transmit buffer of Serial1, still to be sent
+   */
+  unsigned int _serialPending;
+  /**
+   * when the transmission of the first byte in the transmit buffer started
+   */
+  uint64_t _serialClock;
+  uint8_t _gyroRegisters[0x40];
+  /**
+   * the register the next I2C access of the gyro reads or writes
+   */
+  uint8_t _gyroPointer;
+  bool _gyroAutoIncrement;
+  /**
+   * the z axis of the samples in the FIFO of the gyro, the oldest first
+   */
+  std::deque<int16_t> _gyroFifo;
+  bool _gyroOverrun;
+  /**
+   * the z axis of the last sample, read when the FIFO is disabled
+   */
+  int16_t _gyroOutput;
+  bool _gyroNewData;
+  uint64_t _nextGyroSample;
+  uint8_t _eeprom[1024];
+  unsigned int _eepromWrites;
+  bool _buttonAHeld;
+};
+
+}
+
+#endif /* ZUMO_SIMULATOR_HPP_ */
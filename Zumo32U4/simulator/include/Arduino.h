@@ -0,0 +1,91 @@
+/**
+ * @file
+ *
+ * The subset of the Arduino core API used by the firmware, implemented on top of ZumoSimulator.
+ *
+ * Only for the host build of the firmware: the Arduino IDE never sees this file.
+ *
+ * @date Oct 19, 2026
+ * @author agent
+ */
+
+#ifndef SIMULATOR_ARDUINO_H_
+#define SIMULATOR_ARDUINO_H_
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+/**
+ * Strings are never moved into flash on the host
+ */
+#define F(string) (string)
+/**
+ * Nor are the constants: reading them from flash is reading them from memory
+ */
+#define PROGMEM
+#define pgm_read_byte(address) (*(const uint8_t*) (address))
+#define pgm_read_word(address) (*(const uint16_t*) (address))
+
+#define DEC 10
+#define HEX 16
+
+#define constrain(amount, low, high) ((amount) < (low) ? (low) : ((amount) > (high) ? (high) : (amount)))
+
+/**
+ * @return the simulated milliseconds elapsed since the simulation started
+ */
+unsigned long millis();
+/**
+ * @return the simulated microseconds elapsed since the simulation started
+ */
+unsigned long micros();
+/**
+ * Let the simulated time pass
+ *
+ * @param[in] ms milliseconds to wait
+ */
+void delay(unsigned long ms);
+/**
+ * Let the simulated time pass
+ *
+ * @param[in] us microseconds to wait
+ */
+void delayMicroseconds(unsigned int us);
+
+/**
+ * The serial port connected to the bluetooth module. Bytes go to and come from ZumoSimulator
+ */
+class HardwareSerial {
+public:
+  void begin(unsigned long baud);
+  void end();
+  int available();
+  int read();
+  int peek();
+  int availableForWrite();
+  void flush();
+  size_t write(uint8_t b);
+  size_t write(const uint8_t* buffer, size_t size);
+  size_t print(char c);
+  size_t print(const char* s);
+  size_t print(int n, int base = DEC);
+  size_t print(unsigned int n, int base = DEC);
+  size_t print(long n, int base = DEC);
+  size_t print(unsigned long n, int base = DEC);
+  size_t println();
+  size_t println(const char* s);
+  size_t println(int n, int base = DEC);
+  size_t println(unsigned int n, int base = DEC);
+  size_t println(long n, int base = DEC);
+  size_t println(unsigned long n, int base = DEC);
+  operator bool() const { return true; }
+};
+
+extern HardwareSerial Serial1;
+
+#endif /* SIMULATOR_ARDUINO_H_ */
@@ -0,0 +1,46 @@
+/**
+ * @file
+ *
+ * The EEPROM library of the Arduino core, on top of the EEPROM of ZumoSimulator.
+ *
+ * Only for the host build of the firmware: the Arduino IDE never sees this file.
+ *
+ * @date Oct 19, 2026
+ * @author agent
+ */
+
+#ifndef SIMULATOR_EEPROM_H_
+#define SIMULATOR_EEPROM_H_
+
+#include <stdint.h>
+
+class EEPROMClass {
+public:
+  uint8_t read(int address);
+  void write(int address, uint8_t value);
+  /**
+   * Write a byte only if it is different from the one stored, like the real library
+   */
+  void update(int address, uint8_t value);
+  uint16_t length();
+
+  template<typename T> T& get(int address, T& t) {
+    uint8_t* bytes = (uint8_t*) &t;
+    for (unsigned int i = 0; i < sizeof(T); i++) {
+      bytes[i] = read(address + i);
+    }
+    return t;
+  }
+
+  template<typename T> const T& put(int address, const T& t) {
+    const uint8_t* bytes = (const uint8_t*) &t;
+    for (unsigned int i = 0; i < sizeof(T); i++) {
+      update(address + i, bytes[i]);
+    }
+    return t;
+  }
+};
+
+extern EEPROMClass EEPROM;
+
+#endif /* SIMULATOR_EEPROM_H_ */
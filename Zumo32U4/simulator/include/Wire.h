@@ -0,0 +1,47 @@
+/**
+ * @file
+ *
+ * The I2C bus of the Arduino core, connected to the devices of ZumoSimulator. Every transfer takes the time it would take at
+ * the clock of the bus (100kHz unless changed with setClock).
+ *
+ * Only for the host build of the firmware: the Arduino IDE never sees this file.
+ *
+ * @date Oct 19, 2026
+ * @author agent
+ */
+
+#ifndef SIMULATOR_WIRE_H_
+#define SIMULATOR_WIRE_H_
+
+#include "Arduino.h"
+
+/**
+ * size of the buffers of Wire: a transmission or a request can't be longer
+ */
+#define BUFFER_LENGTH 32
+
+class TwoWire {
+public:
+  TwoWire();
+  void begin();
+  void setClock(uint32_t clock);
+  void beginTransmission(uint8_t address);
+  size_t write(uint8_t b);
+  size_t write(const uint8_t* data, size_t size);
+  uint8_t endTransmission(bool sendStop = true);
+  uint8_t requestFrom(uint8_t address, uint8_t quantity, bool sendStop = true);
+  int available();
+  int read();
+private:
+  void transfer(unsigned int bytes);
+private:
+  uint32_t _clock;
+  uint8_t _address;
+  uint8_t _buffer[BUFFER_LENGTH];
+  uint8_t _length;
+  uint8_t _index;
+};
+
+extern TwoWire Wire;
+
+#endif /* SIMULATOR_WIRE_H_ */
@@ -0,0 +1,189 @@
+/**
+ * @file
+ *
+ * The subset of the Pololu Zumo32U4 library used by the firmware, implemented on top of ZumoSimulator.
+ *
+ * Names and signatures follow the real library, so the firmware sources compile unchanged. Like in the real library, the
+ * gyro is accessed through Wire.
+ * Only for the host build of the firmware: the Arduino IDE never sees this file.
+ *
+ * @date Oct 19, 2026
+ * @author agent
+ */
+
+#ifndef SIMULATOR_ZUMO32U4_H_
+#define SIMULATOR_ZUMO32U4_H_
+
+#include "Arduino.h"
+
+#define QTR_EMITTERS_ON 1
+
+#define NOTE_C(x)  ( 0 + (x) * 12)
+#define NOTE_D(x)  ( 2 + (x) * 12)
+#define NOTE_E(x)  ( 4 + (x) * 12)
+#define NOTE_F(x)  ( 5 + (x) * 12)
+#define NOTE_G(x)  ( 7 + (x) * 12)
+#define NOTE_A(x)  ( 9 + (x) * 12)
+#define NOTE_B(x)  (11 + (x) * 12)
+
+void ledRed(bool on);
+void ledGreen(bool on);
+void ledYellow(bool on);
+
+class Zumo32U4Motors {
+public:
+  static void setSpeeds(int16_t leftSpeed, int16_t rightSpeed);
+  static void setLeftSpeed(int16_t speed);
+  static void setRightSpeed(int16_t speed);
+  static void flipLeftMotor(bool /* flip */) {}
+  static void flipRightMotor(bool /* flip */) {}
+};
+
+class Zumo32U4Encoders {
+public:
+  static void init() {}
+  static int16_t getCountsLeft();
+  static int16_t getCountsRight();
+  static int16_t getCountsAndResetLeft();
+  static int16_t getCountsAndResetRight();
+  static bool checkErrorLeft() { return false; }
+  static bool checkErrorRight() { return false; }
+};
+
+class Zumo32U4LineSensors {
+public:
+  /**
+   * minimum values read during calibration by the three sensors. 0 since the simulated sensors are calibrated already
+   */
+  unsigned int* calibratedMinimumOn;
+  /**
+   * maximum values read during calibration by the three sensors. 1000 since the simulated sensors are calibrated already
+   */
+  unsigned int* calibratedMaximumOn;
+public:
+  Zumo32U4LineSensors();
+  void initThreeSensors();
+  void initFiveSensors();
+  void calibrate(uint8_t readMode = QTR_EMITTERS_ON);
+  void read(unsigned int* sensorValues, uint8_t readMode = QTR_EMITTERS_ON);
+  void readCalibrated(unsigned int* sensorValues, uint8_t readMode = QTR_EMITTERS_ON);
+private:
+  unsigned int _minimum[3];
+  unsigned int _maximum[3];
+};
+
+class Zumo32U4ProximitySensors {
+public:
+  void initThreeSensors();
+  void initFrontSensor();
+  void read();
+  uint8_t countsFrontWithLeftLeds() const;
+  uint8_t countsFrontWithRightLeds() const;
+  uint8_t countsLeftWithLeftLeds() const;
+  uint8_t countsRightWithRightLeds() const;
+private:
+  uint8_t _frontLeft;
+  uint8_t _frontRight;
+  uint8_t _left;
+  uint8_t _right;
+};
+
+class Zumo32U4ButtonA {
+public:
+  void waitForButton();
+  void waitForPress();
+  void waitForRelease() {}
+  bool getSingleDebouncedPress();
+  bool getSingleDebouncedRelease() { return false; }
+  /**
+   * @return true if the button is held (see ZumoSimulator::setButtonAHeld)
+   */
+  bool isPressed();
+};
+
+class Zumo32U4ButtonB : public Zumo32U4ButtonA {
+public:
+  bool isPressed() { return false; }
+};
+class Zumo32U4ButtonC : public Zumo32U4ButtonA {
+public:
+  bool isPressed() { return false; }
+};
+
+class Zumo32U4Buzzer {
+public:
+  static void playNote(unsigned char /* note */, unsigned int /* duration */, unsigned char /* volume */) {}
+  static void playFrequency(unsigned int /* frequency */, unsigned int /* duration */, unsigned char /* volume */) {}
+  static void play(const char* /* notes */) {}
+  static bool isPlaying() { return false; }
+  static void stopPlaying() {}
+};
+
+class Zumo32U4LCD {
+public:
+  void init() {}
+  void clear() {}
+  void gotoXY(uint8_t /* x */, uint8_t /* y */) {}
+  template<typename T> size_t print(T value) { return 0; }
+  template<typename T> size_t print(T value, int base) { return 0; }
+};
+
+class L3G {
+public:
+  enum deviceType { device_4200D, device_D20, device_D20H, device_auto };
+  enum sa0State { sa0_low, sa0_high, sa0_auto };
+  enum regAddr {
+    WHO_AM_I = 0x0F,
+    CTRL1 = 0x20,
+    CTRL2 = 0x21,
+    CTRL3 = 0x22,
+    CTRL4 = 0x23,
+    CTRL5 = 0x24,
+    STATUS_REG = 0x27,
+    OUT_X_L = 0x28,
+    OUT_X_H = 0x29,
+    OUT_Y_L = 0x2A,
+    OUT_Y_H = 0x2B,
+    OUT_Z_L = 0x2C,
+    OUT_Z_H = 0x2D,
+    FIFO_CTRL = 0x2E,
+    FIFO_SRC = 0x2F,
+  };
+  template <typename T> struct vector {
+    T x, y, z;
+  };
+  /**
+   * last angular rates read, in digits. With the 2000 dps full scale a digit is 0.07 degrees per second
+   */
+  vector<int16_t> g;
+public:
+  L3G();
+  bool init(deviceType device = device_auto, sa0State sa0 = sa0_auto);
+  void enableDefault() {}
+  void writeReg(uint8_t reg, uint8_t value);
+  uint8_t readReg(uint8_t reg);
+  void read();
+  void setTimeout(unsigned int /* timeout */) {}
+  bool timeoutOccurred() { return false; }
+private:
+  uint8_t address;
+};
+
+class LSM303 {
+public:
+  template <typename T> struct vector {
+    T x, y, z;
+  };
+  vector<int16_t> a;
+  vector<int16_t> m;
+public:
+  bool init() { return true; }
+  void enableDefault() {}
+  void read();
+  void readAcc();
+  void readMag() {}
+  void setTimeout(unsigned int /* timeout */) {}
+  bool timeoutOccurred() { return false; }
+};
+
+#endif /* SIMULATOR_ZUMO32U4_H_ */
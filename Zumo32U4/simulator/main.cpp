@@ -0,0 +1,139 @@
+/*
+   main.cpp
+
+    Created on: Oct 19, 2026
+        Author: agent
+*/
+
+/*
+ * Runs a mission of the firmware on the simulated robot.
+ *
+ * The mission is written in the usual sokoban notation: 'u', 'r', 'd', 'l' move the robot one cell up, right, down and left;
+ * the uppercase letters push the block in front of the robot one cell in that direction. A run of equal letters is executed
+ * as a single goAhead or pushBlock through several cells, like the repetitions of the plans sent by the host.
+ * With --smooth-turns, a goAhead followed by a change of direction turns along an arc (see robot::goAheadAndTurn).
+ *
+ * usage: ZumoSimulator [--rows N] [--columns N] [--robot ROW,COLUMN] [--block ROW,COLUMN]... [--seed N] [--smooth-turns] [MISSION]
+ */
+#include <chrono>
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+#include "robot.hpp"
+#include "ZumoSimulator.hpp"
+
+using namespace robotieee;
+
+extern robot zumo_robot;
+
+/**
+ * the mission run when none is given: go down two cells, push the block at (2,1) to (2,3) and go back to (0,0)
+ */
+#define DEFAULT_MISSION "ddRRuull"
+
+static bool parseCell(const char* s, unsigned int& row, unsigned int& column) {
+  return sscanf(s, "%u,%u", &row, &column) == 2;
+}
+
+static bool parseDirection(char c, object_movement& direction) {
+  switch (tolower(c)) {
+    case 'u': direction = UP; return true;
+    case 'r': direction = RIGHT; return true;
+    case 'd': direction = DOWN; return true;
+    case 'l': direction = LEFT; return true;
+  }
+  return false;
+}
+
+int main(int argc, const char* argv[]) {
+  SimulatorConfig config = defaultSimulatorConfig();
+  unsigned int robotRow = 0;
+  unsigned int robotColumn = 0;
+  std::vector<std::pair<unsigned int, unsigned int>> blocks;
+  const char* mission = DEFAULT_MISSION;
+  bool defaultBlocks = true;
+  bool smoothTurns = false;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--rows") == 0 && i + 1 < argc) {
+      config.rows = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--columns") == 0 && i + 1 < argc) {
+      config.columns = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+      config.seed = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--robot") == 0 && i + 1 < argc) {
+      if (!parseCell(argv[++i], robotRow, robotColumn)) {
+        fprintf(stderr, "invalid cell %s\n", argv[i]);
+        return 1;
+      }
+    } else if (strcmp(argv[i], "--block") == 0 && i + 1 < argc) {
+      unsigned int row, column;
+      if (!parseCell(argv[++i], row, column)) {
+        fprintf(stderr, "invalid cell %s\n", argv[i]);
+        return 1;
+      }
+      blocks.push_back(std::make_pair(row, column));
+      defaultBlocks = false;
+    } else if (strcmp(argv[i], "--smooth-turns") == 0) {
+      smoothTurns = true;
+    } else if (argv[i][0] != '-') {
+      mission = argv[i];
+    } else {
+      fprintf(stderr, "usage: %s [--rows N] [--columns N] [--robot ROW,COLUMN] [--block ROW,COLUMN]... [--seed N] [--smooth-turns] [MISSION]\n", argv[0]);
+      return 1;
+    }
+  }
+  if (defaultBlocks && strcmp(mission, DEFAULT_MISSION) == 0) {
+    blocks.push_back(std::make_pair(2u, 1u));
+  }
+
+  ZumoSimulator* sim = ZumoSimulator::getInstance();
+  sim->reset(config);
+  // the firmware assumes the robot starts facing down
+  sim->placeRobot(robotRow, robotColumn, DOWN);
+  zumo_robot.position = point{(int)robotRow, (int)robotColumn};
+  for (unsigned int i = 0; i < blocks.size(); i++) {
+    sim->addBlock(blocks[i].first, blocks[i].second);
+  }
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  zumo_robot.hardwareInit();
+  uint64_t missionStart = sim->now();
+
+  for (const char* c = mission; *c != '\0'; ) {
+    object_movement direction;
+    if (!parseDirection(*c, direction)) {
+      fprintf(stderr, "invalid action '%c'\n", *c);
+      return 1;
+    }
+    // a run of equal actions is a single movement through several cells
+    unsigned int cells = 1;
+    while (c[cells] == *c) {
+      cells++;
+    }
+    object_movement nextDirection;
+    zumo_robot.faceDirection(direction);
+    if (isupper(*c)) {
+      zumo_robot.pushBlock(cells);
+    } else if (smoothTurns && parseDirection(c[cells], nextDirection)) {
+      // the robot already faces the next direction at the end: the faceDirection above does nothing
+      zumo_robot.goAheadAndTurn(cells, nextDirection);
+    } else {
+      zumo_robot.goAhead(cells);
+    }
+    printf("%c x%u: firmware cell (%d,%d), simulated cell (%d,%d), heading %.1f\n", *c, cells, zumo_robot.position.y, zumo_robot.position.x, sim->getRow(), sim->getColumn(), sim->getHeading());
+    c += cells;
+  }
+  double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  double simulated = sim->now() / 1e6;
+
+  printf("mission time: %.3f s (setup %.3f s)\n", (sim->now() - missionStart) / 1e6, missionStart / 1e6);
+  printf("simulated %.3f s in %.3f s of wall time (%.0fx real time)\n", simulated, wall, wall > 0 ? simulated / wall : 0);
+  printf("distance travelled: %.0f mm\n", sim->getDistanceTravelled());
+  printf("robot: x=%.1f y=%.1f heading=%.1f\n", sim->getX(), sim->getY(), sim->getHeading());
+  for (unsigned int i = 0; i < sim->getBlocks().size(); i++) {
+    const SimulatedBlock& block = sim->getBlocks()[i];
+    printf("block %u: cell (%d,%d) x=%.1f y=%.1f\n", i, (int)(block.y / config.cellSize), (int)(block.x / config.cellSize), block.x, block.y);
+  }
+  return 0;
+}
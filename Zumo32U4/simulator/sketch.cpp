@@ -0,0 +1,31 @@
+/*
+   sketch.cpp
+
+    Created on: Oct 19, 2026
+        Author: agent
+*/
+
+/*
+ * The global hardware objects Zumo32U4.ino defines on the robot. The firmware sources declare them extern,
+ * so the host build needs them as well
+ */
+#include <Zumo32U4.h>
+#include "robot.hpp"
+
+using namespace robotieee;
+
+L3G gyro;
+LSM303 accel;
+Zumo32U4Buzzer buzzer;
+Zumo32U4ButtonA buttonA;
+Zumo32U4ButtonB buttonB;
+Zumo32U4ButtonC buttonC;
+Zumo32U4LineSensors lineSensors;
+Zumo32U4ProximitySensors proxSensors;
+
+#ifdef DEBUG_LCD
+Zumo32U4LCD lcd;
+#endif
+
+// THE POINT INITIALIZATION SYNTAX IS (Y,X)
+robot zumo_robot{(point) {0, 0}};
@@ -0,0 +1,9 @@
+/*
+   main.cpp
+
+    Created on: Oct 19, 2026
+        Author: agent
+*/
+
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
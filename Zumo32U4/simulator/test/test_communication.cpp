@@ -0,0 +1,545 @@
+/*
+   test_communication.cpp
+
+    Created on: Oct 19, 2026
+        Author: agent
+*/
+
+#include <cstdlib>
+#include <new>
+#include "catch.hpp"
+#include "BluetoothAsSerial.hpp"
+#include "PackageParser.hpp"
+#include "framing.hpp"
+#include "ZumoSimulator.hpp"
+
+using namespace robotieee;
+
+static unsigned long heapAllocations; // The blocks allocated on the heap so far, by anyone
+
+void* operator new(size_t size) {
+  heapAllocations++;
+  void* pointer = malloc(size == 0 ? 1 : size);
+  if (pointer == nullptr) {
+    throw std::bad_alloc{};
+  }
+  return pointer;
+}
+
+void operator delete(void* pointer) noexcept {
+  free(pointer);
+}
+
+SCENARIO("the packages live in a static pool") {
+
+  GIVEN("no package allocated") {
+
+    WHEN("more packages than the pool holds are allocated") {
+      IPackage* packages[PACKAGE_POOL_SIZE];
+      for (int i = 0; i < PACKAGE_POOL_SIZE; i++) {
+        packages[i] = new CommunicationPackage();
+      }
+      IPackage* extra = new CommunicationPackage();
+
+      THEN("the packages which don't fit are not allocated, until a package is deleted") {
+        for (int i = 0; i < PACKAGE_POOL_SIZE; i++) {
+          REQUIRE(packages[i] != nullptr);
+        }
+        REQUIRE(extra == nullptr);
+
+        delete(packages[0]);
+        extra = new CommunicationPackage();
+        REQUIRE(extra == packages[0]);
+      }
+
+      delete(extra);
+      for (int i = 1; i < PACKAGE_POOL_SIZE; i++) {
+        delete(packages[i]);
+      }
+    }
+  }
+}
+
+SCENARIO("a package keeps only the payloads the link carries") {
+
+  GIVEN("an empty package") {
+    CommunicationPackage package(PROTOCOL_VERSION, 0, 0, PACKAGE_TYPE_COMMUNICATION);
+
+    WHEN("characters are appended until the payload is full") {
+      int appended = 0;
+      while (appended < MAX_PAYLOAD_LENGTH && package.appendToPayload('a' + appended % 26)) {
+        appended++;
+      }
+
+      THEN("it holds a message, and nothing more") {
+        REQUIRE(appended == MAX_MESSAGE_LENGTH);
+        REQUIRE(package.getPayload()->getSize() == MAX_MESSAGE_LENGTH);
+        REQUIRE(package.getPayload()->getBuffer()[MAX_MESSAGE_LENGTH] == '\0');
+      }
+    }
+  }
+}
+
+SCENARIO("a package is serialized in place") {
+
+  GIVEN("an instruction with id 1 and a payload") {
+    CommunicationPackage package(PROTOCOL_VERSION, 1, 3, PACKAGE_TYPE_INSTRUCTION);
+    package.appendToPayload(MESSAGE_TYPE_MOVE);
+    package.appendToPayload('F');
+    package.appendToPayload('1');
+
+    WHEN("it is serialized into a buffer") {
+      uint8_t buffer[MAX_PACKAGE_LENGTH];
+      uint16_t length = package.serialize(buffer);
+      string<MAX_PACKAGE_LENGTH> coded;
+      package.toString(&coded);
+
+      THEN("the buffer holds the same bytes as the package coded into a string") {
+        const uint8_t expected[] = {0x20, 0x01, 0x03, PACKAGE_TYPE_INSTRUCTION, MESSAGE_TYPE_MOVE, 'F', '1'};
+        REQUIRE(std::vector<uint8_t>(buffer, buffer + length) == std::vector<uint8_t>(expected, expected + sizeof(expected)));
+        REQUIRE(std::vector<uint8_t>(coded.getBuffer(), coded.getBuffer() + coded.getSize()) == std::vector<uint8_t>(expected, expected + sizeof(expected)));
+      }
+
+      THEN("the header written without building the package is the same") {
+        uint8_t header[PACKAGE_HEADER_BYTE_LENGTH];
+        CommunicationPackage::writeHeader(header, PROTOCOL_VERSION, 1, 3, PACKAGE_TYPE_INSTRUCTION);
+        REQUIRE(std::vector<uint8_t>(header, header + PACKAGE_HEADER_BYTE_LENGTH) == std::vector<uint8_t>(buffer, buffer + PACKAGE_HEADER_BYTE_LENGTH));
+      }
+    }
+  }
+}
+
+SCENARIO("the robot acknowledges a package without using the heap") {
+
+  GIVEN("the robot waiting for a package") {
+    ZumoSimulator* sim = ZumoSimulator::getInstance();
+    sim->reset(defaultSimulatorConfig());
+    BluetoothAsSerial* bluetooth = BluetoothAsSerial::getInstance();
+    Serial1.begin(9600);
+    CommunicationPackage packageRead;
+    compositeAction message;
+
+    WHEN("the host sends a move and the robot acknowledges it") {
+      const uint8_t data[] = {0x20, 0x01, 0x04, PACKAGE_TYPE_INSTRUCTION, MESSAGE_TYPE_MOVE, 'F', '1', '\0'};
+      sim->hostSend(data, sizeof(data));
+      unsigned long before = heapAllocations;
+
+      bool read = bluetooth->waitForPackage(&packageRead);
+      packageRead.getPayloadAsMessage(&message);
+      IPackage* ack = BluetoothAsSerial::initAcknowledge(&packageRead, &message);
+      bool sent = bluetooth->sendPackage(ack);
+      delete(ack);
+
+      unsigned long allocations = heapAllocations - before;
+      Serial1.flush();
+      std::vector<uint8_t> received = sim->hostReceive();
+
+      THEN("the host receives the ack with the same id and message") {
+        REQUIRE(read);
+        REQUIRE(sent);
+        REQUIRE(message.getType() == MESSAGE_TYPE_MOVE);
+        const uint8_t expected[] = {0x20, 0x01, 0x03, PACKAGE_TYPE_ACKNOWLEDGE, MESSAGE_TYPE_MOVE, 'F', '1'};
+        REQUIRE(received == std::vector<uint8_t>(expected, expected + sizeof(expected)));
+      }
+
+      THEN("nothing is allocated on the heap") {
+        REQUIRE(allocations == 0);
+      }
+    }
+
+    WHEN("the robot sends a package while the sketch holds both slots of the pool") {
+      // whether it is read or taken for a copy of the last one, the last package received has ID 0 afterwards
+      const uint8_t data[] = {0x20, 0x00, 0x04, PACKAGE_TYPE_INSTRUCTION, MESSAGE_TYPE_MOVE, 'F', '1', '\0'};
+      sim->hostSend(data, sizeof(data));
+      bluetooth->waitForPackage(&packageRead);
+      Serial1.flush();
+      sim->hostReceive();
+
+      IPackage* held[PACKAGE_POOL_SIZE];
+      for (int i = 0; i < PACKAGE_POOL_SIZE; i++) {
+        held[i] = new CommunicationPackage();
+      }
+      const char text[] = "La cipolla";
+      CommunicationPackage package(PROTOCOL_VERSION, 1, sizeof(text) - 1, PACKAGE_TYPE_COMMUNICATION);
+      for (unsigned int i = 0; i < sizeof(text) - 1; i++) {
+        package.appendToPayload(text[i]);
+      }
+      const uint8_t ack[] = {0x20, 0x01, 0x00, PACKAGE_TYPE_ACKNOWLEDGE};
+      sim->hostSend(ack, sizeof(ack));
+
+      bool sent = bluetooth->sendPackage(&package);
+      Serial1.flush();
+      std::vector<uint8_t> received = sim->hostReceive();
+      // the robot answers the package it read, as the sketch does: a package received again gets the answer, not a copy of the last one sent
+      CommunicationPackage answer(PROTOCOL_VERSION, 0, 0, PACKAGE_TYPE_ACKNOWLEDGE);
+      bluetooth->sendPackage(&answer);
+      Serial1.flush();
+      sim->hostReceive();
+      for (int i = 0; i < PACKAGE_POOL_SIZE; i++) {
+        delete(held[i]);
+      }
+
+      THEN("the package is sent and its ack is read without a slot") {
+        REQUIRE(held[PACKAGE_POOL_SIZE - 1] != nullptr);
+        REQUIRE(sent);
+        const uint8_t expected[] = {0x20, 0x01, 0x0A, PACKAGE_TYPE_COMMUNICATION, 'L', 'a', ' ', 'c', 'i', 'p', 'o', 'l', 'l', 'a'};
+        REQUIRE(received == std::vector<uint8_t>(expected, expected + sizeof(expected)));
+      }
+    }
+  }
+}
+
+SCENARIO("a FOUND acknowledge carries every coordinate") {
+
+  GIVEN("an instruction with id 1") {
+    CommunicationPackage packageRead(PROTOCOL_VERSION, 1, 2, PACKAGE_TYPE_INSTRUCTION);
+
+    WHEN("the robot and a block lie on row and column 0") {
+      IPackage* ack = BluetoothAsSerial::initFoundAck(&packageRead, point(3, 0), point(0, 1));
+      uint8_t buffer[MAX_PACKAGE_LENGTH];
+      uint16_t length = ack->serialize(buffer);
+      delete(ack);
+
+      THEN("the zero coordinates are not taken for the end of the arguments") {
+        const uint8_t expected[] = {0x20, 0x01, 0x05, PACKAGE_TYPE_ACKNOWLEDGE, MESSAGE_TYPE_FOUND, 0, 3, 1, 0};
+        REQUIRE(std::vector<uint8_t>(buffer, buffer + length) == std::vector<uint8_t>(expected, expected + sizeof(expected)));
+      }
+    }
+
+    WHEN("more blocks than the arguments hold are found") {
+      point blocks[MAX_ACK_BLOCKS + 1] = { point(1, 1), point(2, 2), point(3, 3), point(4, 4), point(5, 5) };
+      IPackage* ack = BluetoothAsSerial::initFoundAck(&packageRead, point(6, 6), MAX_ACK_BLOCKS + 1, blocks);
+      uint8_t buffer[MAX_PACKAGE_LENGTH];
+      uint16_t length = ack->serialize(buffer);
+      delete(ack);
+
+      THEN("the robot position and the first MAX_ACK_BLOCKS blocks fill the arguments") {
+        const uint8_t expected[] = {0x20, 0x01, 1 + ARGS_LENGHT, PACKAGE_TYPE_ACKNOWLEDGE, MESSAGE_TYPE_FOUND, 6, 6, 1, 1, 2, 2, 3, 3, 4, 4};
+        REQUIRE(std::vector<uint8_t>(buffer, buffer + length) == std::vector<uint8_t>(expected, expected + sizeof(expected)));
+      }
+    }
+  }
+}
+
+/**
+ * Feeds the parser with some bytes
+ *
+ * @return the packages the bytes completed
+ */
+static int feedAll(PackageParser& parser, const uint8_t* data, unsigned int size) {
+  int completed = 0;
+
+  for (unsigned int i = 0; i < size; i++) {
+    if (parser.feed(data[i])) {
+      completed++;
+    }
+  }
+  return completed;
+}
+
+SCENARIO("the parser splits the bytes from the host into packages") {
+
+  GIVEN("a parser waiting for a package") {
+    ZumoSimulator* sim = ZumoSimulator::getInstance();
+    sim->reset(defaultSimulatorConfig());
+    PackageParser parser;
+    CommunicationPackage package;
+    const uint8_t move[] = {0x20, 0x01, 0x03, PACKAGE_TYPE_INSTRUCTION, MESSAGE_TYPE_MOVE, 'F', '1'};
+    const uint8_t ack[] = {0x20, 0x00, 0x00, PACKAGE_TYPE_ACKNOWLEDGE};
+
+    WHEN("a package comes one byte at a time") {
+      int completed = feedAll(parser, move, sizeof(move) - 1);
+      bool receiving = parser.receiving();
+      completed += feedAll(parser, move + sizeof(move) - 1, 1);
+
+      THEN("the package is complete only with its last byte") {
+        REQUIRE(receiving);
+        REQUIRE(completed == 1);
+        REQUIRE(parser.available() == 1);
+        REQUIRE(parser.pop(&package));
+        REQUIRE(package.getID() == 1);
+        REQUIRE(package.getType() == PACKAGE_TYPE_INSTRUCTION);
+        REQUIRE(std::string(package.getPayload()->getBuffer()) == "MF1");
+        REQUIRE_FALSE(parser.pop(&package));
+      }
+    }
+
+    WHEN("garbage comes before two packages") {
+      const uint8_t garbage[] = {'B', 'T', ' ', 0x20, 0x00, 0xFF, 0x20};
+      int completed = feedAll(parser, garbage, sizeof(garbage));
+      completed += feedAll(parser, move, sizeof(move));
+      completed += feedAll(parser, ack, sizeof(ack));
+
+      THEN("the garbage is discarded and both packages are read in order") {
+        REQUIRE(completed == 2);
+        REQUIRE(parser.getDiscarded() == sizeof(garbage));
+        REQUIRE(parser.pop(&package));
+        REQUIRE(package.getType() == PACKAGE_TYPE_INSTRUCTION);
+        REQUIRE(parser.pop(&package));
+        REQUIRE(package.getType() == PACKAGE_TYPE_ACKNOWLEDGE);
+      }
+    }
+
+    WHEN("a byte of a package is lost and the next package comes later") {
+      feedAll(parser, move, sizeof(move) - 1);
+      delay(PARSER_BYTE_TIMEOUT + 1);
+      int completed = feedAll(parser, ack, sizeof(ack));
+
+      THEN("the partial package is discarded and the next one is read") {
+        REQUIRE(completed == 1);
+        REQUIRE(parser.pop(&package));
+        REQUIRE(package.getType() == PACKAGE_TYPE_ACKNOWLEDGE);
+      }
+    }
+
+    WHEN("more packages than the queue holds come before any is read") {
+      for (int i = 0; i < PARSER_QUEUE_SIZE + 1; i++) {
+        feedAll(parser, move, sizeof(move));
+      }
+      feedAll(parser, ack, sizeof(ack));
+
+      THEN("the packages which don't fit are discarded, and the parser keeps its framing") {
+        REQUIRE(parser.available() == PARSER_QUEUE_SIZE);
+        REQUIRE(parser.getDiscarded() == 2 * sizeof(move) + sizeof(ack) - sizeof(move));
+        for (int i = 0; i < PARSER_QUEUE_SIZE; i++) {
+          REQUIRE(parser.pop(&package));
+          REQUIRE(package.getType() == PACKAGE_TYPE_INSTRUCTION);
+        }
+        feedAll(parser, ack, sizeof(ack));
+        REQUIRE(parser.pop(&package));
+        REQUIRE(package.getType() == PACKAGE_TYPE_ACKNOWLEDGE);
+      }
+    }
+  }
+
+  GIVEN("the robot with nothing received yet") {
+    ZumoSimulator* sim = ZumoSimulator::getInstance();
+    sim->reset(defaultSimulatorConfig());
+    BluetoothAsSerial* bluetooth = BluetoothAsSerial::getInstance();
+    Serial1.begin(9600);
+    CommunicationPackage package;
+    // the single instance may still hold a partial package of a previous test
+    bluetooth->discardReceived();
+
+    WHEN("the host has sent only half a package") {
+      const uint8_t half[] = {0x20, 0x00, 0x03, PACKAGE_TYPE_INSTRUCTION};
+      sim->hostSend(half, sizeof(half));
+      uint64_t before = sim->now();
+      bool read = bluetooth->pollPackage(&package);
+
+      THEN("polling returns at once without a package, and the robot knows something is coming") {
+        REQUIRE_FALSE(read);
+        REQUIRE(sim->now() - before < 1000);
+        REQUIRE(bluetooth->somethingToRead());
+      }
+
+      const uint8_t rest[] = {MESSAGE_TYPE_STATE_CHANGE, 'S', '\0'};
+      sim->hostSend(rest, sizeof(rest));
+
+      THEN("polling returns the package once the host sends the rest") {
+        REQUIRE(bluetooth->pollPackage(&package));
+        REQUIRE(package.getPayload()->getBuffer()[0] == MESSAGE_TYPE_STATE_CHANGE);
+      }
+    }
+  }
+}
+
+SCENARIO("the robot and the host use a sliding window with protocol version 3") {
+
+  GIVEN("the robot on a new connection") {
+    ZumoSimulator* sim = ZumoSimulator::getInstance();
+    sim->reset(defaultSimulatorConfig());
+    BluetoothAsSerial* bluetooth = BluetoothAsSerial::getInstance();
+    Serial1.begin(9600);
+    bluetooth->discardReceived();
+    CommunicationPackage package;
+    const uint8_t instructions[] = {
+      0x30, 0x00, 0x03, PACKAGE_TYPE_INSTRUCTION, MESSAGE_TYPE_MOVE, 'F', '1',
+      0x30, 0x01, 0x03, PACKAGE_TYPE_INSTRUCTION, MESSAGE_TYPE_MOVE, 'F', '2',
+      0x30, 0x02, 0x03, PACKAGE_TYPE_INSTRUCTION, MESSAGE_TYPE_MOVE, 'F', '3',
+    };
+
+    WHEN("the host streams 3 instructions without waiting for their acks") {
+      sim->hostSend(instructions, sizeof(instructions));
+      bluetooth->update();
+      Serial1.flush();
+      std::vector<uint8_t> received = sim->hostReceive();
+
+      THEN("the robot acknowledges all of them with a single selective ack") {
+        const uint8_t expected[] = {0x30, 0xFF, 0x02, PACKAGE_TYPE_ACKNOWLEDGE, MESSAGE_TYPE_SELECTIVE_ACK, 0x07};
+        REQUIRE(received == std::vector<uint8_t>(expected, expected + sizeof(expected)));
+      }
+
+      THEN("the robot reads them in order") {
+        for (uint8_t i = 0; i < 3; i++) {
+          REQUIRE(bluetooth->pollPackage(&package));
+          REQUIRE(package.getVersion() == WINDOW_PROTOCOL_VERSION);
+          REQUIRE(package.getID() == i);
+          REQUIRE(package.getPayload()->getBuffer()[2] == '1' + i);
+        }
+        REQUIRE_FALSE(bluetooth->pollPackage(&package));
+      }
+    }
+
+    WHEN("the second instruction is lost") {
+      sim->hostSend(instructions, 7);
+      sim->hostSend(instructions + 14, 7);
+      bluetooth->update();
+      Serial1.flush();
+      std::vector<uint8_t> firstAck = sim->hostReceive();
+      bool readFirst = bluetooth->pollPackage(&package);
+      bool readThird = bluetooth->pollPackage(&package);
+
+      THEN("the selective ack tells the host which one is missing, and the robot waits for it") {
+        const uint8_t expected[] = {0x30, 0xFF, 0x02, PACKAGE_TYPE_ACKNOWLEDGE, MESSAGE_TYPE_SELECTIVE_ACK, 0x05};
+        REQUIRE(firstAck == std::vector<uint8_t>(expected, expected + sizeof(expected)));
+        REQUIRE(readFirst);
+        REQUIRE_FALSE(readThird);
+      }
+
+      THEN("once the host sends it again, the robot reads the second and the third one") {
+        sim->hostSend(instructions + 7, 7);
+        bluetooth->update();
+        Serial1.flush();
+        std::vector<uint8_t> secondAck = sim->hostReceive();
+        const uint8_t expected[] = {0x30, 0x00, 0x02, PACKAGE_TYPE_ACKNOWLEDGE, MESSAGE_TYPE_SELECTIVE_ACK, 0x03};
+        REQUIRE(secondAck == std::vector<uint8_t>(expected, expected + sizeof(expected)));
+        REQUIRE(bluetooth->pollPackage(&package));
+        REQUIRE(package.getID() == 1);
+        REQUIRE(bluetooth->pollPackage(&package));
+        REQUIRE(package.getID() == 2);
+      }
+    }
+
+    WHEN("the robot answers an instruction and the answer is lost") {
+      sim->hostSend(instructions, 7);
+      bluetooth->update();
+      REQUIRE(bluetooth->pollPackage(&package));
+      IPackage* answer = BluetoothAsSerial::initFoundAck(&package, point(1, 2), point(1, 3));
+      bool sent = bluetooth->sendPackage(answer);
+      uint8_t sequence = answer->getID();
+      delete(answer);
+      Serial1.flush();
+      sim->hostReceive();
+
+      delay(WINDOW_ACK_TIMEOUT);
+      bluetooth->update();
+      Serial1.flush();
+      std::vector<uint8_t> resent = sim->hostReceive();
+      const uint8_t ack[] = {0x30, sequence, 0x02, PACKAGE_TYPE_ACKNOWLEDGE, MESSAGE_TYPE_SELECTIVE_ACK, 0x00};
+      sim->hostSend(ack, sizeof(ack));
+      bluetooth->update();
+      delay(WINDOW_ACK_TIMEOUT);
+      bluetooth->update();
+      Serial1.flush();
+      std::vector<uint8_t> afterAck = sim->hostReceive();
+
+      THEN("the robot sends the answer again until the host acknowledges it") {
+        REQUIRE(sent);
+        const uint8_t expected[] = {0x30, sequence, 0x05, PACKAGE_TYPE_ACKNOWLEDGE, MESSAGE_TYPE_FOUND, 2, 1, 3, 1};
+        REQUIRE(resent == std::vector<uint8_t>(expected, expected + sizeof(expected)));
+        REQUIRE(afterAck.empty());
+      }
+    }
+
+    WHEN("the robot sends 2 packages and the host acknowledges only the second one") {
+      CommunicationPackage first(WINDOW_PROTOCOL_VERSION, 0, 1, PACKAGE_TYPE_COMMUNICATION);
+      first.appendToPayload('a');
+      CommunicationPackage second(WINDOW_PROTOCOL_VERSION, 0, 1, PACKAGE_TYPE_COMMUNICATION);
+      second.appendToPayload('b');
+      uint64_t before = sim->now();
+      bool sent = bluetooth->sendPackage(&first) && bluetooth->sendPackage(&second);
+      uint64_t sending = sim->now() - before;
+      Serial1.flush();
+      sim->hostReceive();
+
+      const uint8_t ack[] = {0x30, (uint8_t)(first.getID() - 1), 0x02, PACKAGE_TYPE_ACKNOWLEDGE, MESSAGE_TYPE_SELECTIVE_ACK, 0x02};
+      sim->hostSend(ack, sizeof(ack));
+      bluetooth->update();
+      delay(WINDOW_ACK_TIMEOUT);
+      bluetooth->update();
+      Serial1.flush();
+      std::vector<uint8_t> resent = sim->hostReceive();
+      // the host acknowledges both of them, so nothing is left to send again
+      const uint8_t allAcked[] = {0x30, second.getID(), 0x02, PACKAGE_TYPE_ACKNOWLEDGE, MESSAGE_TYPE_SELECTIVE_ACK, 0x00};
+      sim->hostSend(allAcked, sizeof(allAcked));
+      bluetooth->update();
+      Serial1.flush();
+      sim->hostReceive();
+
+      THEN("the robot doesn't wait for the acks, and sends again only the first package") {
+        REQUIRE(sent);
+        REQUIRE(sending < 1000);
+        REQUIRE(second.getID() == (uint8_t)(first.getID() + 1));
+        const uint8_t expected[] = {0x30, first.getID(), 0x01, PACKAGE_TYPE_COMMUNICATION, 'a'};
+        REQUIRE(resent == std::vector<uint8_t>(expected, expected + sizeof(expected)));
+      }
+    }
+  }
+}
+
+SCENARIO("the robot and the host exchange frames with protocol version 4") {
+
+  GIVEN("the robot on a new connection and 2 framed instructions") {
+    ZumoSimulator* sim = ZumoSimulator::getInstance();
+    sim->reset(defaultSimulatorConfig());
+    BluetoothAsSerial* bluetooth = BluetoothAsSerial::getInstance();
+    Serial1.begin(9600);
+    bluetooth->discardReceived();
+    CommunicationPackage package;
+    const uint8_t first[] = {0x40, 0x00, 0x03, PACKAGE_TYPE_INSTRUCTION, MESSAGE_TYPE_MOVE, 'F', '1'};
+    const uint8_t second[] = {0x40, 0x01, 0x03, PACKAGE_TYPE_INSTRUCTION, MESSAGE_TYPE_MOVE, 'F', '2'};
+    uint8_t firstFrame[FRAMED_LENGTH(sizeof(first))];
+    uint8_t secondFrame[FRAMED_LENGTH(sizeof(second))];
+    uint16_t firstLength = frameEncode(first, sizeof(first), firstFrame);
+    uint16_t secondLength = frameEncode(second, sizeof(second), secondFrame);
+
+    WHEN("the host sends the first one") {
+      sim->hostSend(firstFrame, firstLength);
+      bluetooth->update();
+      Serial1.flush();
+      std::vector<uint8_t> received = sim->hostReceive();
+
+      THEN("the robot reads it and answers with a framed selective ack") {
+        REQUIRE(bluetooth->pollPackage(&package));
+        REQUIRE(package.getVersion() == FRAMED_PROTOCOL_VERSION);
+        REQUIRE(package.getPayload()->getBuffer()[2] == '1');
+
+        REQUIRE(received.size() > 2);
+        REQUIRE(received.front() == FRAME_DELIMITER);
+        REQUIRE(received.back() == FRAME_DELIMITER);
+        uint16_t length = frameDecode(received.data() + 1, received.size() - 2);
+        const uint8_t expected[] = {0x40, 0xFF, 0x02, PACKAGE_TYPE_ACKNOWLEDGE, MESSAGE_TYPE_SELECTIVE_ACK, 0x01};
+        REQUIRE(std::vector<uint8_t>(received.begin() + 1, received.begin() + 1 + length) == std::vector<uint8_t>(expected, expected + sizeof(expected)));
+      }
+    }
+
+    WHEN("the first one is corrupted on the way") {
+      firstFrame[4] ^= 0x10;
+      sim->hostSend(firstFrame, firstLength);
+      sim->hostSend(secondFrame, secondLength);
+      bluetooth->update();
+      bool readSecond = bluetooth->pollPackage(&package);
+
+      THEN("the robot drops it, keeps the framing and waits for the first one again") {
+        REQUIRE_FALSE(readSecond);
+        uint16_t length = frameEncode(first, sizeof(first), firstFrame);
+        sim->hostSend(firstFrame, length);
+        bluetooth->update();
+        REQUIRE(bluetooth->pollPackage(&package));
+        REQUIRE(package.getID() == 0);
+        REQUIRE(bluetooth->pollPackage(&package));
+        REQUIRE(package.getID() == 1);
+      }
+    }
+
+    WHEN("a package of protocol version 4 comes without a frame") {
+      sim->hostSend(first, sizeof(first));
+      bluetooth->update();
+
+      THEN("the robot discards it") {
+        REQUIRE_FALSE(bluetooth->pollPackage(&package));
+      }
+    }
+  }
+}
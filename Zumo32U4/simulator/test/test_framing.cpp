@@ -0,0 +1,91 @@
+/*
+   test_framing.cpp
+
+    Created on: Oct 19, 2026
+        Author: agent
+*/
+
+#include <algorithm>
+#include <vector>
+#include "catch.hpp"
+#include "framing.hpp"
+
+using namespace robotieee;
+
+SCENARIO("the CRC-16 detects a corrupted package") {
+
+  GIVEN("the check string of CRC-16/CCITT-FALSE") {
+    const uint8_t check[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+
+    THEN("its CRC is the check value") {
+      REQUIRE(crc16(check, sizeof(check)) == 0x29B1);
+    }
+
+    THEN("the CRC computed in two parts is the same") {
+      REQUIRE(crc16(check + 4, sizeof(check) - 4, crc16(check, 4)) == 0x29B1);
+    }
+  }
+}
+
+SCENARIO("COBS removes the zeros from the bytes") {
+
+  GIVEN("bytes with zeros") {
+    const uint8_t data[] = {0x00, 0x11, 0x00, 0x00, 0x22, 0x33, 0x00};
+
+    WHEN("they are encoded") {
+      uint8_t encoded[sizeof(data) + 2];
+      uint16_t length = cobsEncode(data, sizeof(data), encoded);
+
+      THEN("the encoded bytes have no zeros and decode to the same bytes") {
+        const uint8_t expected[] = {0x01, 0x02, 0x11, 0x01, 0x03, 0x22, 0x33, 0x01};
+        REQUIRE(std::vector<uint8_t>(encoded, encoded + length) == std::vector<uint8_t>(expected, expected + sizeof(expected)));
+
+        uint8_t decoded[sizeof(data)];
+        REQUIRE(cobsDecode(encoded, length, decoded) == sizeof(data));
+        REQUIRE(std::vector<uint8_t>(decoded, decoded + sizeof(data)) == std::vector<uint8_t>(data, data + sizeof(data)));
+      }
+    }
+  }
+
+  GIVEN("more than 254 bytes without zeros") {
+    std::vector<uint8_t> data(300);
+    for (unsigned int i = 0; i < data.size(); i++) {
+      data[i] = 1 + i % 255;
+    }
+
+    WHEN("they are encoded and decoded in place") {
+      std::vector<uint8_t> encoded(data.size() + 2);
+      uint16_t length = cobsEncode(data.data(), data.size(), encoded.data());
+      bool noZeros = std::find(encoded.begin(), encoded.begin() + length, 0) == encoded.begin() + length;
+      uint16_t decoded = cobsDecode(encoded.data(), length, encoded.data());
+
+      THEN("the bytes are split in blocks and come back the same") {
+        REQUIRE(length == data.size() + 2);
+        REQUIRE(noZeros);
+        REQUIRE(decoded == data.size());
+        REQUIRE(std::vector<uint8_t>(encoded.begin(), encoded.begin() + decoded) == data);
+      }
+    }
+  }
+}
+
+SCENARIO("a package goes in a frame") {
+
+  GIVEN("a framed package") {
+    const uint8_t package[] = {0x40, 0x00, 0x03, 'I', 'M', 'F', '1'};
+    uint8_t frame[FRAMED_LENGTH(sizeof(package))];
+    uint16_t length = frameEncode(package, sizeof(package), frame);
+
+    THEN("the frame starts and ends with a delimiter and holds the package") {
+      REQUIRE(frame[0] == FRAME_DELIMITER);
+      REQUIRE(frame[length - 1] == FRAME_DELIMITER);
+      REQUIRE(frameDecode(frame + 1, length - 2) == sizeof(package));
+      REQUIRE(std::vector<uint8_t>(frame + 1, frame + 1 + sizeof(package)) == std::vector<uint8_t>(package, package + sizeof(package)));
+    }
+
+    THEN("a frame with a changed byte is rejected") {
+      frame[5] ^= 0x04;
+      REQUIRE(frameDecode(frame + 1, length - 2) == 0);
+    }
+  }
+}
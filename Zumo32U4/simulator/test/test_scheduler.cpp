@@ -0,0 +1,85 @@
+/*
+   test_scheduler.cpp
+
+    Created on: Oct 19, 2026
+        Author: agent
+*/
+
+#include "catch.hpp"
+#include "scheduler.hpp"
+#include "ZumoSimulator.hpp"
+
+using namespace robotieee;
+
+static unsigned int fastRuns;     // The runs of fastTask
+static unsigned int periodicRuns; // The runs of periodicTask
+static unsigned int slowRuns;     // The runs of slowTask
+
+static void fastTask() {
+  fastRuns++;
+}
+
+static void periodicTask() {
+  periodicRuns++;
+}
+
+static void slowTask() {
+  slowRuns++;
+  delay(30);
+}
+
+SCENARIO("the scheduler runs the tasks on their periods") {
+
+  GIVEN("a task to run at every pass and one to run every 10 milliseconds") {
+    ZumoSimulator* sim = ZumoSimulator::getInstance();
+    sim->reset(defaultSimulatorConfig());
+    struct scheduled_task tasks[] = {
+      { fastTask, 0, 5, 0, 0 },
+      { periodicTask, 10, 5, 0, 0 },
+    };
+    fastRuns = 0;
+    periodicRuns = 0;
+    schedulerStart(tasks, 2);
+
+    WHEN("the scheduler runs for 100 milliseconds") {
+      uint32_t start = millis();
+      unsigned int passes = 0;
+      while (millis() - start < 100) {
+        schedulerRun(tasks, 2);
+        passes++;
+      }
+
+      THEN("the first task runs at every pass, the second one every 10 milliseconds, and no deadline is missed") {
+        REQUIRE(fastRuns == passes);
+        REQUIRE(periodicRuns >= 10);
+        REQUIRE(periodicRuns <= 11);
+        REQUIRE(tasks[0].missed == 0);
+        REQUIRE(tasks[1].missed == 0);
+      }
+    }
+  }
+
+  GIVEN("a task that takes 30 milliseconds before one with a deadline of 5 milliseconds") {
+    ZumoSimulator* sim = ZumoSimulator::getInstance();
+    sim->reset(defaultSimulatorConfig());
+    struct scheduled_task tasks[] = {
+      { slowTask, 0, 50, 0, 0 },
+      { periodicTask, 10, 5, 0, 0 },
+    };
+    slowRuns = 0;
+    periodicRuns = 0;
+    schedulerStart(tasks, 2);
+
+    WHEN("the scheduler runs 5 passes") {
+      for (int i = 0; i < 5; i++) {
+        schedulerRun(tasks, 2);
+      }
+
+      THEN("the second task runs at every pass, skipping the periods it missed, and counts its missed deadlines") {
+        REQUIRE(slowRuns == 5);
+        REQUIRE(periodicRuns == 5);
+        REQUIRE(tasks[1].missed == 5);
+      }
+    }
+  }
+}
@@ -0,0 +1,436 @@
+/*
+   test_simulator.cpp
+
+    Created on: Oct 19, 2026
+        Author: agent
+*/
+
+#include <algorithm>
+#include "catch.hpp"
+#include "robot.hpp"
+#include "TurnSensor.h"
+#include "calibration.hpp"
+#include "ZumoSimulator.hpp"
+
+using namespace robotieee;
+
+/**
+ * @return the difference between two headings, in degrees between -180 and 180
+ */
+static double headingError(double actual, double expected) {
+  return remainder(actual - expected, 360);
+}
+
+SCENARIO("the firmware runs on the simulated robot") {
+
+  GIVEN("a robot in the top left corner of a 5x5 grid, facing down") {
+    ZumoSimulator* sim = ZumoSimulator::getInstance();
+    sim->reset(defaultSimulatorConfig());
+    sim->placeRobot(0, 0, DOWN);
+    robot r{(point) {0, 0}};
+    r.hardwareInit();
+
+    WHEN("the robot goes ahead 2 cells") {
+      bool blockFound = r.goAhead(2);
+
+      THEN("it stops on the intersection 2 cells below") {
+        REQUIRE_FALSE(blockFound);
+        REQUIRE(r.position == point{2, 0});
+        REQUIRE(sim->getRow() == 2);
+        REQUIRE(sim->getColumn() == 0);
+        REQUIRE(fabs(sim->getY() - 500) < 40);
+        REQUIRE(fabs(sim->getX() - 100) < 10);
+      }
+    }
+
+    WHEN("the robot goes ahead 2 cells without blocking") {
+      r.startGoAhead(2);
+      unsigned int ticks = 0;
+      uint64_t longestTick = 0;
+      uint64_t last = sim->now();
+      while (r.update()) {
+        ticks++;
+        longestTick = std::max(longestTick, sim->now() - last);
+        last = sim->now();
+      }
+
+      THEN("it stops on the intersection 2 cells below") {
+        REQUIRE_FALSE(r.isMoving());
+        REQUIRE_FALSE(r.getMotionResult());
+        REQUIRE(r.position == point{2, 0});
+        REQUIRE(sim->getRow() == 2);
+      }
+
+      THEN("every update returns quickly") {
+        REQUIRE(ticks > 100);
+        REQUIRE(longestTick < 10000);
+      }
+    }
+
+    WHEN("the robot looks for blocks while it goes ahead 2 cells without blocking") {
+      r.startGoAhead(2, true);
+      unsigned int ticks = 0;
+      unsigned int proximityTicks = 0;
+      uint64_t last = sim->now();
+      while (r.update()) {
+        ticks++;
+        // a reading of the proximity sensors takes longer than a whole update without it
+        if (sim->now() - last >= 3000) {
+          proximityTicks++;
+        }
+        last = sim->now();
+      }
+
+      THEN("it reads the proximity sensors only once every few updates") {
+        REQUIRE(r.position == point{2, 0});
+        REQUIRE(proximityTicks > 0);
+        REQUIRE(proximityTicks * 5 < ticks);
+      }
+    }
+
+    WHEN("the robot pushes a block without blocking") {
+      sim->addBlock(1, 0);
+      r.startPushBlock(1);
+
+      THEN("it is moving until the push ends") {
+        REQUIRE(r.isMoving());
+        while (r.update()) ;
+        REQUIRE(r.position == point{1, 0});
+        REQUIRE((int)(sim->getBlocks()[0].y / sim->getConfig().cellSize) == 2);
+      }
+    }
+
+    WHEN("the robot follows the line with the PID controller for 3 cells") {
+      r.setLineFollowMode(LFM_PID);
+      r.setSpeed(300);
+      r.startGoAhead(3);
+      bool countedOnTheFly = false;
+      int16_t slowest = 400;
+      while (r.update()) {
+        // between the first and the last intersection the robot is never at the center of a cell
+        if (sim->getY() > 350 && sim->getY() < 650) {
+          countedOnTheFly |= (r.position == point{2, 0}) && sim->getRow() == 2;
+          slowest = std::min(slowest, (int16_t) (sim->getLeftMotorSpeed() + sim->getRightMotorSpeed()));
+        }
+      }
+
+      THEN("it doesn't stop at the intersections in between") {
+        REQUIRE(slowest > 300);
+      }
+
+      THEN("its position is updated as each intersection is crossed") {
+        REQUIRE(countedOnTheFly);
+      }
+
+      THEN("it stops on the last intersection") {
+        REQUIRE(r.position == point{3, 0});
+        REQUIRE(sim->getRow() == 3);
+        REQUIRE(fabs(sim->getY() - 700) < 40);
+      }
+    }
+
+    WHEN("the robot turns right") {
+      r.turnRight();
+
+      THEN("it faces left") {
+        REQUIRE(fabs(headingError(sim->getHeading(), 180)) < 10);
+      }
+
+      THEN("it follows the line of the row") {
+        r.goAhead(1);
+        REQUIRE(sim->getRow() == 0);
+        REQUIRE(sim->getColumn() == 0);
+      }
+    }
+
+    WHEN("the robot rotates at full speed") {
+      r.setSpeed(400);
+      r.rotate(90);
+      delay(200);
+
+      THEN("it slows down in time not to overshoot") {
+        REQUIRE(fabs(headingError(sim->getHeading(), 0)) < 2);
+      }
+    }
+
+    WHEN("the robot starts going ahead") {
+      r.setSpeed(400);
+      r.startGoAhead(1);
+      r.update();
+
+      THEN("the motors speed up gradually") {
+        REQUIRE(sim->getLeftMotorSpeed() > 0);
+        REQUIRE(sim->getLeftMotorSpeed() < 200);
+        while (r.update()) ;
+        REQUIRE(sim->getRow() == 1);
+      }
+    }
+
+    WHEN("the robot turns left and goes ahead") {
+      r.faceDirection(RIGHT);
+      r.goAhead(3);
+
+      THEN("it reaches the intersection 3 cells on the right") {
+        REQUIRE(r.position == point{0, 3});
+        REQUIRE(sim->getRow() == 0);
+        REQUIRE(sim->getColumn() == 3);
+        REQUIRE(fabs(headingError(sim->getHeading(), 0)) < 10);
+      }
+    }
+
+    WHEN("the robot goes ahead 2 cells turning left along an arc, then 2 more cells") {
+      r.startGoAheadAndTurn(2, RIGHT);
+      int16_t slowest = 400;
+      do {
+        // around the corner, the intersection (2,0)
+        if (hypot(sim->getX() - 100, sim->getY() - 500) < 50) {
+          slowest = std::min(slowest, (int16_t) (sim->getLeftMotorSpeed() + sim->getRightMotorSpeed()));
+        }
+      } while (r.update());
+      r.goAhead(2);
+
+      THEN("it never stops at the corner") {
+        REQUIRE(slowest >= 100);
+      }
+
+      THEN("it reaches the intersection 2 cells on the right of the corner") {
+        REQUIRE(r.position == point{2, 2});
+        REQUIRE(sim->getRow() == 2);
+        REQUIRE(sim->getColumn() == 2);
+        REQUIRE(fabs(headingError(sim->getHeading(), 0)) < 10);
+      }
+    }
+
+    WHEN("the robot follows the line with the PID controller at high speed") {
+      r.setLineFollowMode(LFM_PID);
+      r.setSpeed(350);
+      r.goAhead(4);
+      r.turnLeft();
+      r.goAhead(4);
+
+      THEN("it reaches the opposite corner of the grid") {
+        REQUIRE(r.position == point{4, 4});
+        REQUIRE(sim->getRow() == 4);
+        REQUIRE(sim->getColumn() == 4);
+        REQUIRE(fabs(headingError(sim->getHeading(), 0)) < 15);
+      }
+    }
+
+    WHEN("a block is 2 cells below the robot") {
+      sim->addBlock(2, 0);
+
+      THEN("the robot looking for blocks stops in front of it") {
+        REQUIRE(r.goAhead(3, true));
+        REQUIRE(r.position == point{1, 0});
+        REQUIRE(sim->getRow() == 1);
+        REQUIRE((int)(sim->getBlocks()[0].y / sim->getConfig().cellSize) == 2);
+      }
+    }
+
+    WHEN("a block is 2 cells below the robot, one on its left and one 3 cells on its right") {
+      // facing down, the left of the robot is the right of the grid
+      sim->placeRobot(1, 3, DOWN);
+      r.position = point{1, 3};
+      sim->addBlock(3, 3);
+      sim->addBlock(1, 4);
+      sim->addBlock(1, 0);
+      point blocks[3] = { point(0, 0), point(0, 0), point(0, 0) };
+      uint8_t found = r.locateBlocks(blocks, 3);
+
+      THEN("the robot locates the first two, but not the farthest one") {
+        REQUIRE(found == 2);
+        REQUIRE(blocks[0] == point(3, 3));
+        REQUIRE(blocks[1] == point(1, 4));
+      }
+    }
+
+    WHEN("a block is right below the robot") {
+      sim->addBlock(1, 0);
+      r.pushBlock(1);
+
+      THEN("the robot pushes it one cell down") {
+        REQUIRE(r.position == point{1, 0});
+        REQUIRE(sim->getRow() == 1);
+        REQUIRE((int)(sim->getBlocks()[0].y / sim->getConfig().cellSize) == 2);
+        REQUIRE((int)(sim->getBlocks()[0].x / sim->getConfig().cellSize) == 0);
+      }
+    }
+  }
+
+  GIVEN("a robot with a weak battery, whose wheels go 30% slower") {
+    ZumoSimulator* sim = ZumoSimulator::getInstance();
+    SimulatorConfig config = defaultSimulatorConfig();
+    config.maxWheelSpeed *= 0.7;
+    sim->reset(config);
+    sim->placeRobot(0, 0, DOWN);
+    robot r{(point) {0, 0}};
+    r.hardwareInit();
+
+    WHEN("the robot moves straight for 10 centimeters") {
+      r.moveStraight(100);
+      delay(100);
+
+      THEN("it travels the same distance as with a charged battery") {
+        REQUIRE(fabs(sim->getY() - 200) < 5);
+      }
+    }
+
+    WHEN("the robot goes ahead 2 cells") {
+      r.goAhead(2);
+
+      THEN("it stops on the center of the intersection") {
+        REQUIRE(sim->getRow() == 2);
+        REQUIRE(fabs(sim->getY() - 500) < 20);
+      }
+    }
+  }
+
+  GIVEN("a robot whose motors are so unbalanced that it keeps losing the line") {
+    ZumoSimulator* sim = ZumoSimulator::getInstance();
+    SimulatorConfig config = defaultSimulatorConfig();
+    config.motorImbalance = 0.1;
+    sim->reset(config);
+    sim->placeRobot(0, 0, DOWN);
+    robot r{(point) {0, 0}};
+    r.hardwareInit();
+
+    WHEN("the robot goes ahead 4 cells") {
+      r.startGoAhead(4);
+      unsigned int rotations = 0;
+      bool rotating = false;
+      while (r.update()) {
+        bool now = sim->getLeftMotorSpeed() * sim->getRightMotorSpeed() < 0;
+        rotations += (now && !rotating) ? 1 : 0;
+        rotating = now;
+      }
+
+      THEN("it finds the line again turning straight towards it") {
+        REQUIRE(r.position == point{4, 0});
+        REQUIRE(sim->getRow() == 4);
+        REQUIRE(rotations < 40);
+      }
+    }
+  }
+
+  GIVEN("the same mission run twice") {
+    uint64_t durations[2];
+
+    for (int i = 0; i < 2; i++) {
+      ZumoSimulator* sim = ZumoSimulator::getInstance();
+      sim->reset(defaultSimulatorConfig());
+      sim->placeRobot(0, 0, DOWN);
+      robot r{(point) {0, 0}};
+      r.hardwareInit();
+      r.goAhead(1);
+      r.turnLeft();
+      r.goAhead(1);
+      durations[i] = sim->now();
+    }
+
+    THEN("the simulation is deterministic") {
+      REQUIRE(durations[0] == durations[1]);
+    }
+  }
+}
+
+SCENARIO("the calibration is kept in the EEPROM") {
+
+  GIVEN("a robot calibrated the first time it boots") {
+    ZumoSimulator* sim = ZumoSimulator::getInstance();
+    sim->reset(defaultSimulatorConfig());
+    sim->placeRobot(0, 0, DOWN);
+    robot first{(point) {0, 0}};
+    first.hardwareInit();
+    int16_t offset = gyroOffset;
+    struct calibration_data saved;
+
+    THEN("the calibration is saved") {
+      REQUIRE(loadCalibration(saved));
+      REQUIRE(saved.gyroOffset == offset);
+      REQUIRE(saved.lineMaximum[1] == 1000);
+    }
+
+    WHEN("the robot boots again") {
+      gyroOffset = 0;
+      uint64_t before = sim->now();
+      robot second{(point) {0, 0}};
+      second.hardwareInit();
+
+      THEN("it reuses the calibration and boots in less than a second") {
+        REQUIRE(gyroOffset == offset);
+        REQUIRE(sim->now() - before < 1000000);
+      }
+
+      THEN("it moves as well as after a full calibration") {
+        second.goAhead(2);
+        REQUIRE(sim->getRow() == 2);
+        REQUIRE(sim->getColumn() == 0);
+      }
+    }
+
+    WHEN("the robot boots again with button A held") {
+      unsigned int writes = sim->getEepromWrites();
+      uint64_t before = sim->now();
+      sim->setButtonAHeld(true);
+      robot second{(point) {0, 0}};
+      second.hardwareInit();
+      sim->setButtonAHeld(false);
+
+      THEN("it calibrates again") {
+        REQUIRE(sim->now() - before > 1000000);
+      }
+
+      THEN("only the bytes which changed are written in the EEPROM") {
+        REQUIRE(sim->getEepromWrites() > writes);
+        REQUIRE(sim->getEepromWrites() - writes < sizeof(struct calibration_data));
+      }
+    }
+
+    WHEN("a byte of the calibration gets corrupted") {
+      sim->writeEeprom(2, sim->readEeprom(2) ^ 0x01);
+
+      THEN("the calibration is rejected") {
+        REQUIRE_FALSE(loadCalibration(saved));
+      }
+    }
+  }
+}
+
+SCENARIO("Serial1 talks with the host") {
+
+  GIVEN("a fresh simulation") {
+    ZumoSimulator* sim = ZumoSimulator::getInstance();
+    sim->reset(defaultSimulatorConfig());
+    Serial1.begin(9600);
+
+    WHEN("the host sends some bytes") {
+      const uint8_t data[] = {'a', 'b', 'c'};
+      sim->hostSend(data, sizeof(data));
+
+      THEN("the robot reads them in order") {
+        REQUIRE(Serial1.available() == 3);
+        REQUIRE(Serial1.peek() == 'a');
+        REQUIRE(Serial1.read() == 'a');
+        REQUIRE(Serial1.read() == 'b');
+        REQUIRE(Serial1.read() == 'c');
+        REQUIRE(Serial1.read() == -1);
+      }
+    }
+
+    WHEN("the robot prints a message") {
+      Serial1.print("ID ");
+      Serial1.println(42);
+      uint64_t before = sim->now();
+      Serial1.flush();
+
+      THEN("the host receives it") {
+        std::vector<uint8_t> received = sim->hostReceive();
+        REQUIRE(std::string(received.begin(), received.end()) == "ID 42\r\n");
+      }
+
+      THEN("flushing waits for the bytes to leave at 9600 baud") {
+        REQUIRE(sim->now() - before >= 7 * 1000);
+      }
+    }
+  }
+}
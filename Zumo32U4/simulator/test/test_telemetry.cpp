@@ -0,0 +1,136 @@
+/*
+   test_telemetry.cpp
+
+    Created on: Oct 19, 2026
+        Author: agent
+*/
+
+#include <algorithm>
+#include "catch.hpp"
+#include "robot.hpp"
+#include "telemetry.hpp"
+#include "scheduler.hpp"
+#include "BluetoothAsSerial.hpp"
+#include "framing.hpp"
+#include "ZumoSimulator.hpp"
+
+using namespace robotieee;
+
+static robot* streamingRobot;    // The robot driven by the tasks
+static bool streamingMoving;     // False once the robot stops
+static uint64_t longestTick;     // The longest time between two updates of the robot, in microseconds
+static uint64_t lastTick;        // When the robot was last updated
+
+static void motionTask() {
+  uint64_t now = ZumoSimulator::getInstance()->now();
+  longestTick = std::max(longestTick, now - lastTick);
+  lastTick = now;
+  streamingMoving = streamingRobot->update();
+}
+
+static void samplingTask() {
+  streamingRobot->recordTelemetry();
+}
+
+static void telemetryTask() {
+  telemetryStream(PROTOCOL_VERSION);
+}
+
+SCENARIO("the robot streams its telemetry") {
+
+  GIVEN("a robot in the top left corner of a 5x5 grid, facing down") {
+    ZumoSimulator* sim = ZumoSimulator::getInstance();
+    sim->reset(defaultSimulatorConfig());
+    sim->placeRobot(0, 0, DOWN);
+    robot r{(point) {0, 0}};
+    r.hardwareInit();
+    Serial1.begin(9600);
+    // the records taken before the test
+    while (telemetryPending() > 0) {
+      telemetryStream(PROTOCOL_VERSION);
+    }
+    telemetryFinish();
+    Serial1.flush();
+    sim->hostReceive();
+
+    WHEN("the robot goes ahead 2 cells streaming the telemetry from the tasks of the scheduler") {
+      struct scheduled_task tasks[] = {
+        { motionTask, 0, 5, 0, 0 },
+        { samplingTask, TELEMETRY_INTERVAL, 10, 0, 0 },
+        { telemetryTask, 20, 100, 0, 0 },
+      };
+      streamingRobot = &r;
+      streamingMoving = true;
+      r.startGoAhead(2);
+      uint64_t start = sim->now();
+      longestTick = 0;
+      lastTick = sim->now();
+      schedulerStart(tasks, 3);
+      while (streamingMoving) {
+        schedulerRun(tasks, 3);
+      }
+      uint64_t duration = sim->now() - start;
+      while (telemetryPending() > 0) {
+        telemetryStream(PROTOCOL_VERSION);
+      }
+      telemetryFinish();
+      Serial1.flush();
+      std::vector<uint8_t> received = sim->hostReceive();
+
+      THEN("the streaming never stops the robot for long") {
+        REQUIRE(r.position == point{2, 0});
+        REQUIRE(longestTick < 10000);
+      }
+
+      THEN("the host receives a record every 50 milliseconds, in telemetry packages") {
+        unsigned int records = 0;
+        unsigned int following = 0;
+        unsigned int i = 0;
+        while (i + PACKAGE_HEADER_BYTE_LENGTH <= received.size()) {
+          uint8_t payloadLength = received[i + 2];
+          REQUIRE(received[i] >> 4 == 2);
+          REQUIRE(received[i + 3] == PACKAGE_TYPE_COMMUNICATION);
+          REQUIRE(received[i + PACKAGE_HEADER_BYTE_LENGTH] == TELEMETRY_MESSAGE_TYPE);
+          REQUIRE((payloadLength - 1) % TELEMETRY_RECORD_SIZE == 0);
+          for (unsigned int j = i + PACKAGE_HEADER_BYTE_LENGTH + 1; j < i + PACKAGE_HEADER_BYTE_LENGTH + payloadLength; j += TELEMETRY_RECORD_SIZE) {
+            records++;
+            // while following the line, the center sensor sees it and both motors go forwards
+            if (received[j + 2] == MS_FOLLOWING_LINE && received[j + 4] > 100 && (int8_t)received[j + 6] > 0 && (int8_t)received[j + 7] > 0) {
+              following++;
+            }
+          }
+          i += PACKAGE_HEADER_BYTE_LENGTH + payloadLength;
+        }
+
+        REQUIRE(i == received.size());
+        REQUIRE(records >= duration / 1000 / TELEMETRY_INTERVAL - 1);
+        REQUIRE(records <= duration / 1000 / TELEMETRY_INTERVAL + 1);
+        REQUIRE(following > records / 2);
+      }
+    }
+
+    WHEN("the link speaks protocol version 4 and the robot records 3 times") {
+      for (int i = 0; i < 3; i++) {
+        r.recordTelemetry();
+        delay(TELEMETRY_INTERVAL);
+      }
+      telemetryStream(FRAMED_PROTOCOL_VERSION);
+      telemetryFinish();
+      Serial1.flush();
+      std::vector<uint8_t> received = sim->hostReceive();
+
+      THEN("the host receives them in a single frame with a valid CRC") {
+        REQUIRE(received.size() > 2);
+        REQUIRE(received.front() == FRAME_DELIMITER);
+        REQUIRE(received.back() == FRAME_DELIMITER);
+        REQUIRE(std::count(received.begin(), received.end(), FRAME_DELIMITER) == 2);
+        uint16_t length = frameDecode(received.data() + 1, received.size() - 2);
+        REQUIRE(length == PACKAGE_HEADER_BYTE_LENGTH + 1 + 3 * TELEMETRY_RECORD_SIZE);
+        REQUIRE(received[1] >> 4 == FRAMED_PROTOCOL_VERSION);
+        REQUIRE(received[1 + 2] == 1 + 3 * TELEMETRY_RECORD_SIZE);
+        REQUIRE(received[1 + 3] == PACKAGE_TYPE_COMMUNICATION);
+        REQUIRE(received[1 + PACKAGE_HEADER_BYTE_LENGTH] == TELEMETRY_MESSAGE_TYPE);
+      }
+    }
+  }
+}
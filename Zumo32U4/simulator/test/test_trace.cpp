@@ -0,0 +1,82 @@
+/*
+   test_trace.cpp
+
+    Created on: Oct 19, 2026
+        Author: agent
+*/
+
+#include <algorithm>
+#include <string>
+#include "catch.hpp"
+#include "robot.hpp"
+#include "trace.hpp"
+#include "BluetoothAsSerial.hpp"
+#include "ZumoSimulator.hpp"
+
+using namespace robotieee;
+
+SCENARIO("the firmware traces where the time goes") {
+
+  GIVEN("a robot in the top left corner of a 5x5 grid, facing down") {
+    ZumoSimulator* sim = ZumoSimulator::getInstance();
+    sim->reset(defaultSimulatorConfig());
+    sim->placeRobot(0, 0, DOWN);
+    robot r{(point) {0, 0}};
+    r.hardwareInit();
+    Serial1.begin(9600);
+    traceReset();
+
+    WHEN("the robot goes ahead 2 cells and turns left") {
+      // the PID controller never stops following the line to seek it
+      r.setLineFollowMode(LFM_PID);
+      r.goAhead(2);
+      r.turnLeft();
+
+      THEN("the line following, the centering and the rotation are recorded once each") {
+        REQUIRE(traceCount(TE_FOLLOW_LINE) == 1);
+        REQUIRE(traceCount(TE_CENTERING) == 1);
+        REQUIRE(traceCount(TE_ROTATION) == 1);
+        REQUIRE(traceCount(TE_WAIT_PACKAGE) == 0);
+      }
+
+      THEN("the rotation, which takes a few hundreds of milliseconds, is in the matching bucket") {
+        uint32_t bucketStart = 256;
+        uint8_t bucket = 1;
+        while (traceHistogram(TE_ROTATION, bucket) == 0 && bucket < TRACE_BUCKETS - 1) {
+          bucket++;
+          bucketStart *= 2;
+        }
+        REQUIRE(traceHistogram(TE_ROTATION, bucket) == 1);
+        REQUIRE(bucketStart >= 100000);
+        REQUIRE(bucketStart <= 1000000);
+      }
+
+      THEN("the dump sends the histograms and the operations in packages the host doesn't acknowledge") {
+        traceDump(PROTOCOL_VERSION);
+        Serial1.flush();
+        std::vector<uint8_t> received = sim->hostReceive();
+        std::string dump;
+        unsigned int packages = 0;
+
+        for (unsigned int i = 0; i + PACKAGE_HEADER_BYTE_LENGTH <= received.size(); packages++) {
+          uint8_t length = received[i + 2];
+          REQUIRE(received[i + 3] == PACKAGE_TYPE_COMMUNICATION);
+          REQUIRE(length >= 2);
+          REQUIRE(length <= MAX_MESSAGE_LENGTH);
+          REQUIRE(received[i + PACKAGE_HEADER_BYTE_LENGTH] == TRACE_MESSAGE_TYPE);
+          dump.append(received.begin() + i + PACKAGE_HEADER_BYTE_LENGTH + 1, received.begin() + i + PACKAGE_HEADER_BYTE_LENGTH + length);
+          i += PACKAGE_HEADER_BYTE_LENGTH + length;
+        }
+
+        REQUIRE(packages > 1);
+        REQUIRE(dump.find("rotate 1 ") == 0);
+        REQUIRE(dump.find("\nfollow 1 ") != std::string::npos);
+        REQUIRE(dump.find("\ncenter 1 ") != std::string::npos);
+        REQUIRE(dump.find("\nwait ") == std::string::npos);
+        REQUIRE(dump.substr(dump.size() - 4) == "end\n");
+        // 3 histograms, 3 operations and the end
+        REQUIRE(std::count(dump.begin(), dump.end(), '\n') == 7);
+      }
+    }
+  }
+}
@@ -0,0 +1,117 @@
+/*
+   test_turn_sensor.cpp
+
+    Created on: Oct 19, 2026
+        Author: agent
+*/
+
+#include <random>
+#include "catch.hpp"
+#include "TurnSensor.h"
+#include "ZumoSimulator.hpp"
+
+using namespace robotieee;
+
+/**
+ * the conversion turnSensorUpdate used to do on every sample
+ */
+static int32_t referenceScale(int32_t d) {
+  return (int64_t)d * 14680064 / 17578125;
+}
+
+SCENARIO("fixed point gyro integration") {
+
+  GIVEN("the products of a gyro reading and the time between two readings") {
+    std::mt19937 random(7);
+    std::uniform_int_distribution<int32_t> rates(-32768, 32767);
+    std::uniform_int_distribution<int32_t> intervals(0, 65535);
+
+    THEN("each sample is converted with an error of at most 2 units") {
+      for (int i = 0; i < 20000; i++) {
+        int32_t d = rates(random) * intervals(random);
+        REQUIRE(abs(turnSensorScale(d) - referenceScale(d)) <= 2);
+      }
+    }
+
+    THEN("the extreme values are converted correctly") {
+      const int32_t extremes[] = {0, 1, -1, 65535, 65536, -65536, -32768 * 65535, 32767 * 65535};
+      for (unsigned int i = 0; i < sizeof(extremes) / sizeof(extremes[0]); i++) {
+        REQUIRE(abs(turnSensorScale(extremes[i]) - referenceScale(extremes[i])) <= 2);
+      }
+    }
+  }
+
+  GIVEN("a long turn sampled at 800Hz") {
+    std::mt19937 random(11);
+    std::normal_distribution<double> noise(0, 20);
+    uint32_t fixedPoint = 0;
+    uint32_t reference = 0;
+    int64_t total = 0;
+
+    // one minute of spinning at about 200 degrees per second
+    for (int i = 0; i < 48000; i++) {
+      int16_t rate = 2857 + (int16_t)noise(random);
+      uint16_t dt = 1250 + (int16_t)noise(random);
+      int32_t d = (int32_t)rate * dt;
+      fixedPoint += turnSensorScale(d);
+      reference += referenceScale(d);
+      total += d;
+    }
+    // the angle turned, converted once at the end
+    uint32_t exact = total * 14680064 / 17578125;
+
+    THEN("the accumulated angle is not less accurate than with the 64 bit division") {
+      int32_t error = abs((int32_t)(fixedPoint - exact));
+      int32_t referenceError = abs((int32_t)(reference - exact));
+      REQUIRE(error <= referenceError);
+      REQUIRE(error * 45.0 / turnAngle45 < 0.001);
+    }
+  }
+}
+
+/**
+ * Spin the robot in place for a second, updating the turn sensor every period milliseconds
+ *
+ * @return the difference between the angle measured by the turn sensor and the real one, in degrees
+ */
+static double spinError(unsigned long period) {
+  ZumoSimulator* sim = ZumoSimulator::getInstance();
+  SimulatorConfig config = defaultSimulatorConfig();
+  config.gyroNoise = 0;
+  config.gyroDrift = 0;
+  sim->reset(config);
+  turnSensorSetup();
+  double start = sim->getHeading();
+  double turned = 0;
+
+  sim->setMotorSpeeds(-200, 200);
+  for (unsigned long elapsed = 0; elapsed < 1000; elapsed += period) {
+    delay(period);
+    turnSensorUpdate();
+  }
+  sim->setMotorSpeeds(0, 0);
+  for (unsigned long elapsed = 0; elapsed < 300; elapsed += period) {
+    delay(period);
+    turnSensorUpdate();
+  }
+  turned = remainder(sim->getHeading() - start, 360);
+  return remainder((int32_t)turnAngle / (double)turnAngle1 - turned, 360);
+}
+
+SCENARIO("the gyro samples are queued in its FIFO") {
+
+  GIVEN("a robot spinning in place") {
+
+    WHEN("the turn sensor is updated every 30 ms") {
+      THEN("no sample is lost") {
+        REQUIRE(fabs(spinError(30)) < 0.5);
+      }
+    }
+
+    WHEN("the turn sensor is updated less often than the FIFO fills up") {
+      THEN("the lost samples are made up for") {
+        REQUIRE(fabs(spinError(100)) < 3);
+      }
+    }
+  }
+}
@@ -0,0 +1,120 @@
+/*
+   telemetry.cpp
+
+    Created on: Oct 19, 2026
+        Author: agent
+*/
+#include "telemetry.hpp"
+
+#ifdef TELEMETRY
+
+#include "BluetoothAsSerial.hpp"
+#include "framing.hpp"
+
+/* The bytes of a telemetry package: header, message type and records */
+#define TELEMETRY_PACKAGE_LENGTH  (PACKAGE_HEADER_BYTE_LENGTH + 1 + TELEMETRY_PACKAGE_RECORDS * TELEMETRY_RECORD_SIZE)
+
+namespace robotieee {
+
+  static uint8_t records[TELEMETRY_BUFFER_RECORDS][TELEMETRY_RECORD_SIZE]; // The records not sent yet
+  static uint8_t firstRecord;                                             // The oldest record in records
+  static uint8_t recordCount;                                             // The number of records in records
+
+  // The package being sent as it goes on the link, in a frame from protocol version 4 on
+  static uint8_t package[FRAMED_LENGTH(TELEMETRY_PACKAGE_LENGTH)];
+  static uint16_t packageLength;                                          // The bytes of package, 0 if no package is being sent
+  static uint16_t packageSent;                                            // The bytes of package already written on Serial1
+
+  /**
+   * Writes a 16 bit number in little endian
+   */
+  static void putInt16(uint8_t* data, int16_t value) {
+    data[0] = (uint8_t) value;
+    data[1] = (uint8_t) (value >> 8);
+  }
+
+  void telemetryRecord(uint8_t state, const int* line, int16_t leftSpeed, int16_t rightSpeed, int16_t heading) {
+    uint32_t now = millis();
+
+    if (recordCount == TELEMETRY_BUFFER_RECORDS) {
+      firstRecord = (firstRecord + 1) % TELEMETRY_BUFFER_RECORDS;
+      recordCount--;
+    }
+    uint8_t* record = records[(firstRecord + recordCount) % TELEMETRY_BUFFER_RECORDS];
+    recordCount++;
+
+    putInt16(record, (int16_t) now);
+    record[2] = state;
+    for (uint8_t i = 0; i < 3; i++) {
+      record[3 + i] = (uint8_t) (constrain(line[i], 0, 1000) / 4);
+    }
+    record[6] = (uint8_t) (int8_t) (leftSpeed / 4);
+    record[7] = (uint8_t) (int8_t) (rightSpeed / 4);
+    putInt16(record + 8, heading);
+  }
+
+  /**
+   * Moves the oldest records into a new package
+   */
+  static void preparePackage(uint8_t version) {
+    uint8_t count = recordCount < TELEMETRY_PACKAGE_RECORDS ? recordCount : TELEMETRY_PACKAGE_RECORDS;
+    uint8_t payloadLength = 1 + count * TELEMETRY_RECORD_SIZE;
+    uint8_t raw[TELEMETRY_PACKAGE_LENGTH];
+
+    // The header is encoded as the one of any other package
+    CommunicationPackage::writeHeader(raw, version, 0, payloadLength, PACKAGE_TYPE_COMMUNICATION);
+
+    raw[PACKAGE_HEADER_BYTE_LENGTH] = TELEMETRY_MESSAGE_TYPE;
+    for (uint8_t r = 0; r < count; r++) {
+      for (uint8_t i = 0; i < TELEMETRY_RECORD_SIZE; i++) {
+        raw[PACKAGE_HEADER_BYTE_LENGTH + 1 + r * TELEMETRY_RECORD_SIZE + i] = records[firstRecord][i];
+      }
+      firstRecord = (firstRecord + 1) % TELEMETRY_BUFFER_RECORDS;
+      recordCount--;
+    }
+
+    if (version >= FRAMED_PROTOCOL_VERSION) {
+      packageLength = frameEncode(raw, PACKAGE_HEADER_BYTE_LENGTH + payloadLength, package);
+    } else {
+      packageLength = PACKAGE_HEADER_BYTE_LENGTH + payloadLength;
+      memcpy(package, raw, packageLength);
+    }
+    packageSent = 0;
+  }
+
+  void telemetryStream(uint8_t version) {
+    if (packageLength == 0) {
+      if (recordCount == 0) {
+        return;
+      }
+      preparePackage(version);
+    }
+
+    uint16_t size = packageLength - packageSent;
+    int room = Serial1.availableForWrite();
+    if (size > room) {
+      size = room;
+    }
+    Serial1.write(package + packageSent, size);
+    packageSent += size;
+
+    if (packageSent == packageLength) {
+      packageLength = 0;
+    }
+  }
+
+  void telemetryFinish() {
+    if (packageLength == 0) {
+      return;
+    }
+    Serial1.write(package + packageSent, packageLength - packageSent);
+    packageLength = 0;
+  }
+
+  uint8_t telemetryPending() {
+    return recordCount;
+  }
+
+}
+
+#endif /* TELEMETRY */
@@ -0,0 +1,92 @@
+/**
+ * @file
+ *
+ * Telemetry of the robot: what it sees and does while it moves, streamed to the host.
+ *
+ * The robot records its state every TELEMETRY_INTERVAL milliseconds (see robotieee::robot::recordTelemetry) into a ring
+ * buffer of binary records.
+ * When the link is idle, telemetryStream() sends the records as PACKAGE_TYPE_COMMUNICATION packages whose payload
+ * starts with TELEMETRY_MESSAGE_TYPE, in a frame (see framing.hpp) from protocol version 4 on. It writes only the
+ * bytes that fit in the transmit buffer of Serial1, so it never waits: the rest of the package goes at the next call.
+ * The host must not acknowledge these packages.
+ *
+ * Each record is TELEMETRY_RECORD_SIZE bytes, little endian:
+ * \li 0-1: the time, in milliseconds (millis(), wrapping around every 65.5 seconds);
+ * \li 2: the motion state (see robotieee::motion_state);
+ * \li 3-5: the calibrated readings of the left, center and right line sensors, divided by 4;
+ * \li 6-7: the speeds of the left and right motors, divided by 4, signed;
+ * \li 8-9: the heading since the start of the movement, in tenths of degree, counter clockwise, signed.
+ *
+ * Zumo32U4/tools/telemetry.py decodes them on the host.
+ *
+ * The telemetry takes about 260 bytes of RAM: it is compiled only if TELEMETRY is defined
+ *
+ * @date Oct 19, 2026
+ * @author agent
+ */
+
+#ifndef TELEMETRY_HPP_
+#define TELEMETRY_HPP_
+
+#include <Arduino.h>
+#include <stdint.h>
+
+// Uncomment to stream the telemetry to the host
+//#define TELEMETRY
+
+/**
+ * the milliseconds between two records
+ */
+#define TELEMETRY_INTERVAL          50
+/**
+ * the bytes of a record
+ */
+#define TELEMETRY_RECORD_SIZE       10
+/**
+ * the records kept until they are sent. When it is full, the oldest record is lost
+ */
+#define TELEMETRY_BUFFER_RECORDS    16
+/**
+ * the records sent in a package at most
+ */
+#define TELEMETRY_PACKAGE_RECORDS   8
+/**
+ * the first byte of the payload of a telemetry package
+ */
+#define TELEMETRY_MESSAGE_TYPE      'T'
+
+namespace robotieee {
+
+/**
+ * Records the state of the robot
+ *
+ * @param[in] state the motion state
+ * @param[in] line the calibrated readings of the line sensors (0-1000)
+ * @param[in] leftSpeed the speed of the left motor (-400, 400)
+ * @param[in] rightSpeed the speed of the right motor (-400, 400)
+ * @param[in] heading the heading since the start of the movement, in tenths of degree
+ */
+void telemetryRecord(uint8_t state, const int* line, int16_t leftSpeed, int16_t rightSpeed, int16_t heading);
+
+/**
+ * Sends the records to the host, without waiting: it writes as much of a package as fits in the transmit buffer.
+ * Call it whenever the link is idle
+ *
+ * @param[in] version the protocol version of the link, used for the next package
+ */
+void telemetryStream(uint8_t version);
+
+/**
+ * Sends the rest of the package telemetryStream() started, waiting for the transmit buffer if needed.
+ * Call it before sending any other package, so the bytes of the two don't mix up
+ */
+void telemetryFinish();
+
+/**
+ * @return the records waiting to be sent
+ */
+uint8_t telemetryPending();
+
+}
+
+#endif /* TELEMETRY_HPP_ */
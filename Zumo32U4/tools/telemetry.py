@@ -0,0 +1,143 @@
+#!/usr/bin/env python3
+"""
+Decodes the telemetry the robot streams over bluetooth (see Zumo32U4/telemetry.hpp) and prints it as CSV.
+
+The input is the raw byte stream coming from the robot: the serial device of the bluetooth module (already
+configured at 9600 baud, e.g. with stty) or a file where it has been saved. The packages that are not telemetry
+are skipped. From protocol version 4 on the packages come in frames (see Zumo32U4/framing.hpp): the frames are
+decoded and the ones with a wrong CRC are skipped.
+
+usage: telemetry.py [INPUT]   (standard input if missing)
+"""
+
+import struct
+import sys
+
+PROTOCOL_VERSION = 2
+WINDOW_PROTOCOL_VERSION = 3
+FRAMED_PROTOCOL_VERSION = 4
+FRAME_DELIMITER = 0
+CRC16_LENGTH = 2
+PACKAGE_HEADER_BYTE_LENGTH = 4
+PACKAGE_TYPE_COMMUNICATION = ord('C')
+TELEMETRY_MESSAGE_TYPE = ord('T')
+TELEMETRY_RECORD_SIZE = 10
+
+# robotieee::motion_state
+MOTION_STATES = ('idle', 'rotating', 'following', 'seeking', 'centering', 'straight', 'arc')
+
+RECORD = struct.Struct('<HB3Bbbh')
+
+
+def decode_record(data):
+	time, state, left, center, right, left_speed, right_speed, heading = RECORD.unpack(data)
+	return {
+		'time': time,
+		'state': MOTION_STATES[state] if state < len(MOTION_STATES) else str(state),
+		'left': left * 4,
+		'center': center * 4,
+		'right': right * 4,
+		'left_speed': left_speed * 4,
+		'right_speed': right_speed * 4,
+		'heading': heading / 10.0,
+	}
+
+
+def crc16(data):
+	"""
+	CRC-16/CCITT-FALSE, as robotieee::crc16
+	"""
+	crc = 0xFFFF
+	for byte in data:
+		crc ^= byte << 8
+		for _ in range(8):
+			crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+			crc &= 0xFFFF
+	return crc
+
+
+def cobs_decode(encoded):
+	"""
+	Decodes COBS, as robotieee::cobsDecode. Returns None if the bytes are malformed
+	"""
+	data = bytearray()
+	read = 0
+	while read < len(encoded):
+		code = encoded[read]
+		read += 1
+		if code == 0 or read + code - 1 > len(encoded):
+			return None
+		data += encoded[read:read + code - 1]
+		read += code - 1
+		# the last block, and the blocks of 254 bytes, are not followed by a 0 byte
+		if code != 0xFF and read < len(encoded):
+			data.append(0)
+	return bytes(data)
+
+
+def frame_decode(frame):
+	"""
+	Extracts the package from the bytes between the delimiters of a frame, as robotieee::frameDecode.
+	Returns None if the frame is malformed or its CRC is wrong
+	"""
+	data = cobs_decode(frame)
+	if data is None or len(data) <= CRC16_LENGTH:
+		return None
+	package, crc = data[:-CRC16_LENGTH], data[-CRC16_LENGTH:]
+	if crc16(package) != (crc[0] << 8 | crc[1]):
+		return None
+	return package
+
+
+def packages(stream):
+	"""
+	Splits the byte stream into packages, as (type, payload). A byte that cannot start a package or a frame is
+	skipped, so the decoding resynchronizes after a corrupted or partial package
+	"""
+	buffer = b''
+	while True:
+		data = stream.read(1)
+		if not data:
+			return
+		buffer += data
+		if buffer[0] == FRAME_DELIMITER:
+			if len(buffer) == 1 or buffer[-1] != FRAME_DELIMITER:
+				continue
+			package = frame_decode(buffer[1:-1])
+			# two frames can share the delimiter between them
+			buffer = buffer[-1:]
+			if package is not None and len(package) >= PACKAGE_HEADER_BYTE_LENGTH and package[0] >> 4 >= FRAMED_PROTOCOL_VERSION \
+					and len(package) == PACKAGE_HEADER_BYTE_LENGTH + package[2]:
+				yield package[3], package[PACKAGE_HEADER_BYTE_LENGTH:]
+			continue
+		if buffer[0] >> 4 not in (PROTOCOL_VERSION, WINDOW_PROTOCOL_VERSION):
+			buffer = buffer[1:]
+			continue
+		if len(buffer) < PACKAGE_HEADER_BYTE_LENGTH:
+			continue
+		length = PACKAGE_HEADER_BYTE_LENGTH + buffer[2]
+		if len(buffer) < length:
+			continue
+		yield buffer[3], buffer[PACKAGE_HEADER_BYTE_LENGTH:length]
+		buffer = buffer[length:]
+
+
+def records(stream):
+	for package_type, payload in packages(stream):
+		if package_type != PACKAGE_TYPE_COMMUNICATION or len(payload) < 1 or payload[0] != TELEMETRY_MESSAGE_TYPE:
+			continue
+		for start in range(1, len(payload) - TELEMETRY_RECORD_SIZE + 1, TELEMETRY_RECORD_SIZE):
+			yield decode_record(payload[start:start + TELEMETRY_RECORD_SIZE])
+
+
+def main(argv):
+	stream = open(argv[1], 'rb', buffering=0) if len(argv) > 1 else sys.stdin.buffer
+	columns = ('time', 'state', 'left', 'center', 'right', 'left_speed', 'right_speed', 'heading')
+	print(','.join(columns))
+	for record in records(stream):
+		print(','.join(str(record[c]) for c in columns))
+		sys.stdout.flush()
+
+
+if __name__ == '__main__':
+	main(sys.argv)
@@ -0,0 +1,161 @@
+/*
+   trace.cpp
+
+    Created on: Oct 19, 2026
+        Author: agent
+*/
+#include "trace.hpp"
+
+#ifdef TRACE
+
+#include "BluetoothAsSerial.hpp"
+
+namespace robotieee {
+
+  struct trace_record {
+    uint8_t event;
+    uint32_t start;
+    uint32_t duration;
+  };
+
+  // The names are read only by traceDump: they stay in flash
+  static const char EVENT_NAMES[TE_COUNT][9] PROGMEM = {
+    "activity", "wait", "send", "rotate", "follow", "seek", "center", "straight", "arc",
+  };
+
+  static struct trace_record records[TRACE_BUFFER_SIZE]; // The last operations recorded
+  static uint8_t nextRecord;                              // Where the next operation is recorded in records
+  static bool recordsFull;                                // True once records has wrapped around
+  static uint16_t histograms[TE_COUNT][TRACE_BUCKETS];    // The durations of every operation recorded
+  static uint32_t longest[TE_COUNT];                      // The longest duration of each kind of operation
+
+  void traceRecord(enum trace_event event, uint32_t start) {
+    uint32_t duration = micros() - start;
+    uint8_t bucket = 0;
+
+    for (uint32_t d = duration >> 8; d > 0 && bucket < TRACE_BUCKETS - 1; d >>= 1) {
+      bucket++;
+    }
+    // The counts stop at their maximum instead of wrapping around
+    if (histograms[event][bucket] < UINT16_MAX) {
+      histograms[event][bucket]++;
+    }
+    if (duration > longest[event]) {
+      longest[event] = duration;
+    }
+
+    records[nextRecord].event = event;
+    records[nextRecord].start = start;
+    records[nextRecord].duration = duration;
+    nextRecord = (nextRecord + 1) % TRACE_BUFFER_SIZE;
+    recordsFull = recordsFull || nextRecord == 0;
+  }
+
+  uint16_t traceCount(enum trace_event event) {
+    uint16_t count = 0;
+
+    for (uint8_t i = 0; i < TRACE_BUCKETS; i++) {
+      count += histograms[event][i];
+    }
+    return count;
+  }
+
+  uint16_t traceHistogram(enum trace_event event, uint8_t bucket) {
+    return histograms[event][bucket];
+  }
+
+  void traceReset() {
+    for (uint8_t e = 0; e < TE_COUNT; e++) {
+      for (uint8_t i = 0; i < TRACE_BUCKETS; i++) {
+        histograms[e][i] = 0;
+      }
+      longest[e] = 0;
+    }
+    nextRecord = 0;
+    recordsFull = false;
+  }
+
+  /**
+   * Sends the text in the payload of package, if any, and starts a new payload
+   */
+  static void dumpFlush(CommunicationPackage& package) {
+    if (package.getPayload()->getSize() > 1) {
+      package.setPayloadLength(package.getPayload()->getSize());
+      BluetoothAsSerial::getInstance()->sendWithoutAck(&package);
+    }
+    package.getPayload()->clear();
+    package.appendToPayload(TRACE_MESSAGE_TYPE);
+  }
+
+  /**
+   * Appends a character to the text of the dump, sending the package when it is full
+   */
+  static void dumpChar(CommunicationPackage& package, char c) {
+    if (!package.appendToPayload(c)) {
+      dumpFlush(package);
+      package.appendToPayload(c);
+    }
+  }
+
+  static void dumpNumber(CommunicationPackage& package, uint32_t number) {
+    char digits[10];
+    uint8_t count = 0;
+
+    do {
+      digits[count++] = '0' + number % 10;
+      number /= 10;
+    } while (number > 0);
+    while (count > 0) {
+      dumpChar(package, digits[--count]);
+    }
+  }
+
+  static void dumpName(CommunicationPackage& package, uint8_t event) {
+    char c;
+
+    for (uint8_t i = 0; i < sizeof(EVENT_NAMES[0]) && (c = pgm_read_byte(&EVENT_NAMES[event][i])) != '\0'; i++) {
+      dumpChar(package, c);
+    }
+  }
+
+  void traceDump(uint8_t version) {
+    CommunicationPackage package(version, 0, 0, PACKAGE_TYPE_COMMUNICATION);
+
+    package.appendToPayload(TRACE_MESSAGE_TYPE);
+    for (uint8_t e = 0; e < TE_COUNT; e++) {
+      if (traceCount((enum trace_event) e) == 0) {
+        continue;
+      }
+      dumpName(package, e);
+      dumpChar(package, ' ');
+      dumpNumber(package, traceCount((enum trace_event) e));
+      dumpChar(package, ' ');
+      dumpNumber(package, longest[e]);
+      for (uint8_t i = 0; i < TRACE_BUCKETS; i++) {
+        dumpChar(package, ' ');
+        dumpNumber(package, histograms[e][i]);
+      }
+      dumpChar(package, '\n');
+    }
+
+    uint8_t first = recordsFull ? nextRecord : 0;
+    uint8_t size = recordsFull ? TRACE_BUFFER_SIZE : nextRecord;
+    for (uint8_t i = 0; i < size; i++) {
+      const struct trace_record& record = records[(first + i) % TRACE_BUFFER_SIZE];
+      dumpName(package, record.event);
+      dumpChar(package, ' ');
+      dumpNumber(package, record.start);
+      dumpChar(package, ' ');
+      dumpNumber(package, record.duration);
+      dumpChar(package, '\n');
+    }
+    dumpChar(package, 'e');
+    dumpChar(package, 'n');
+    dumpChar(package, 'd');
+    dumpChar(package, '\n');
+    dumpFlush(package);
+  }
+
+}
+
+#endif /* TRACE */
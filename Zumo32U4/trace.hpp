@@ -0,0 +1,144 @@
+/**
+ * @file
+ *
+ * Tracing of where the time goes on the robot: how long it waits for the packages of the host, sends the acks,
+ * turns, follows the line and so on.
+ *
+ * Every traced operation is timed with micros(). The last ones are kept in a ring buffer, and a histogram of the
+ * durations of each kind of operation is kept since the boot. traceDump() sends both to the host.
+ *
+ * The tracing takes about 615 bytes of RAM (the names of the operations stay in flash): it is compiled only if TRACE
+ * is defined. Without it, the TRACE_BEGIN and TRACE_END macros expand to nothing
+ *
+ * @date Oct 19, 2026
+ * @author agent
+ */
+
+#ifndef TRACE_HPP_
+#define TRACE_HPP_
+
+#include <Arduino.h>
+#include <stdint.h>
+
+// Uncomment to trace the firmware
+//#define TRACE
+
+/**
+ * the number of operations kept in the ring buffer
+ */
+#define TRACE_BUFFER_SIZE 32
+/**
+ * the number of buckets of the histograms. Bucket 0 counts the operations shorter than 256us, bucket i > 0 the ones
+ * from 2^(i+7) to 2^(i+8) microseconds; the last one counts every operation longer than that
+ */
+#define TRACE_BUCKETS     16
+/**
+ * the first byte of the payload of the packages of a dump (see traceDump)
+ */
+#define TRACE_MESSAGE_TYPE 'D'
+
+#ifdef TRACE
+/**
+ * Starts timing an operation, in a new local variable
+ */
+#  define TRACE_BEGIN(name)       uint32_t name = micros()
+/**
+ * Records an operation started with TRACE_BEGIN
+ */
+#  define TRACE_END(event, name)  traceRecord(event, name)
+#else
+#  define TRACE_BEGIN(name)
+#  define TRACE_END(event, name)
+#endif
+
+namespace robotieee {
+
+/**
+ * the kinds of operations traced
+ */
+enum trace_event {
+  /**
+   * a package of the host, from its reading to the ack
+   */
+  TE_ACTIVITY,
+  /**
+   * the reading of a package (see ICommunicator::waitForPackage)
+   */
+  TE_WAIT_PACKAGE,
+  /**
+   * the sending of a package, including the wait for its ack (see ICommunicator::sendPackage)
+   */
+  TE_SEND_PACKAGE,
+  /**
+   * a rotation on the spot, e.g. of faceDirection (see robotieee::MS_ROTATING)
+   */
+  TE_ROTATION,
+  /**
+   * the line following between two intersections (see robotieee::MS_FOLLOWING_LINE)
+   */
+  TE_FOLLOW_LINE,
+  /**
+   * the search of a lost line (see robotieee::MS_SEEKING_LINE)
+   */
+  TE_SEEK_LINE,
+  /**
+   * the centering on an intersection (see robotieee::MS_CENTERING)
+   */
+  TE_CENTERING,
+  /**
+   * a straight movement (see robotieee::MS_STRAIGHT_MOVE)
+   */
+  TE_STRAIGHT_MOVE,
+  /**
+   * a turn along an arc (see robotieee::MS_ARC_TURNING)
+   */
+  TE_ARC_TURN,
+  /**
+   * the number of kinds of operations
+   */
+  TE_COUNT,
+};
+
+/**
+ * Records an operation that has just ended
+ *
+ * @param[in] event the kind of operation
+ * @param[in] start the value of micros() when the operation started
+ */
+void traceRecord(enum trace_event event, uint32_t start);
+
+/**
+ * @param[in] event a kind of operation
+ * @return how many operations of that kind have been recorded since the boot (or the last traceReset)
+ */
+uint16_t traceCount(enum trace_event event);
+
+/**
+ * @param[in] event a kind of operation
+ * @param[in] bucket a bucket of the histogram (see TRACE_BUCKETS)
+ * @return how many operations of that kind lasted the time of the bucket
+ */
+uint16_t traceHistogram(enum trace_event event, uint8_t bucket);
+
+/**
+ * Forgets every operation recorded
+ */
+void traceReset();
+
+/**
+ * Sends the traces to the host as text, cut into PACKAGE_TYPE_COMMUNICATION packages whose payload starts with
+ * TRACE_MESSAGE_TYPE (see BluetoothAsSerial::sendWithoutAck). The host must not acknowledge them. The text has:
+ * \li a line for every kind of operation recorded: <tt>name count max b0 b1 ... b15</tt>, with the longest duration
+ *     in microseconds and the histogram;
+ * \li a line for every operation in the ring buffer, oldest first: <tt>name start duration</tt>, in microseconds;
+ * \li a line with just <tt>end</tt>.
+ *
+ * Every line ends with a newline.
+ *
+ * @param[in] version the protocol version of the link
+ */
+void traceDump(uint8_t version);
+
+}
+
+#endif /* TRACE_HPP_ */
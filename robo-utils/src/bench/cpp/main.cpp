@@ -0,0 +1,324 @@
+/*
+ * main.cpp
+ *
+ * Benchmark of the sokoban solvers registered in solver_registry.
+ *
+ * Every solver is run on the instances in BENCH_INSTANCE_FOLDER (or the one given with --instances) and on a
+ * generated corpus scaling on grid size and number of blocks. Each run happens in a child process, so that the peak
+ * memory is the one of the run alone and a run exceeding the timeout can be killed. Every plan found is checked with
+ * plan_validator: a plan which doesn't solve the instance is reported as \c invalid.
+ *
+ * With --cache every solver looks in the given plan_cache file first, so a second run measures the cache hits.
+ *
+ * usage: robo-utilsBench [--solver NAME]... [--instances FOLDER] [--report FILE] [--timeout SECONDS] [--label TEXT] [--no-corpus] [--cache FILE]
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <dirent.h>
+#include <poll.h>
+#include <signal.h>
+#include <string>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+#include "plan_cache.hpp"
+#include "plan_validator.hpp"
+#include "sokoban_solver.hpp"
+#include "sokoban_world.hpp"
+
+using namespace robo_utils;
+
+#define DEFAULT_TIMEOUT_SECONDS 60
+#define DEFAULT_REPORT "bench_report.json"
+
+/**
+ * a problem to benchmark
+ */
+struct bench_instance {
+	std::string name;
+	sokoban_world world;
+};
+
+/**
+ * what a child process tells the parent at the end of a run
+ */
+struct bench_measure {
+	bool solved;
+	bool valid;
+	double wall_time_ms;
+	solver_statistics statistics;
+	long peak_rss_kb;
+	unsigned long plan_length;
+	unsigned long pushes;
+	unsigned long predicted_time_ms;
+};
+
+/**
+ * the outcome of a run
+ */
+enum bench_status {
+	BS_SOLVED,
+	BS_INVALID,
+	BS_UNSOLVED,
+	BS_TIMEOUT,
+	BS_CRASHED
+};
+
+static const char* status_names[] = {"solved", "invalid", "unsolved", "timeout", "crashed"};
+
+struct bench_result {
+	std::string solver;
+	const bench_instance* instance;
+	bench_status status;
+	bench_measure measure;
+};
+
+static void load_instances(const std::string& folder, std::vector<bench_instance>& instances) {
+	DIR* dir = opendir(folder.c_str());
+	std::vector<std::string> names;
+
+	if (dir == nullptr) {
+		fprintf(stderr, "can't open instance folder %s\n", folder.c_str());
+		return;
+	}
+	for (struct dirent* entry = readdir(dir); entry != nullptr; entry = readdir(dir)) {
+		if (strncmp(entry->d_name, "instance-", 9) == 0) {
+			names.push_back(entry->d_name);
+		}
+	}
+	closedir(dir);
+	std::sort(names.begin(), names.end());
+
+	for (unsigned int i=0; i<names.size(); i++) {
+		sokoban_world w{1, 1};
+		if (!w.load_instance_file(folder + "/" + names[i])) {
+			fprintf(stderr, "can't parse instance %s\n", names[i].c_str());
+			continue;
+		}
+		instances.push_back(bench_instance{names[i], w});
+	}
+}
+
+/**
+ * Generate worlds of increasing size and number of blocks
+ */
+static void generate_corpus(std::vector<bench_instance>& instances) {
+	const unsigned int sizes[] = {6, 8, 10, 12};
+	const unsigned int blocks[] = {1, 2, 3, 4};
+	const unsigned int seeds = 2;
+
+	for (unsigned int s=0; s<sizeof(sizes)/sizeof(sizes[0]); s++) {
+		for (unsigned int b=0; b<sizeof(blocks)/sizeof(blocks[0]); b++) {
+			for (unsigned int seed=1; seed<=seeds; seed++) {
+				char name[64];
+				snprintf(name, sizeof(name), "gen-%ux%u-b%u-s%u", sizes[s], sizes[s], blocks[b], seed);
+				instances.push_back(bench_instance{name, generate_sokoban_world(sizes[s], sizes[s], blocks[b], seed)});
+			}
+		}
+	}
+}
+
+/**
+ * Executed in the child process
+ */
+static bench_measure measure_run(const std::string& solver_name, const sokoban_world& world, const std::string& cache_file) {
+	bench_measure result;
+	sokoban_solver* solver = solver_registry::get_instance()->create(solver_name);
+	plan_cache cache;
+	sokoban_plan plan;
+	struct rusage usage;
+
+	if (!cache_file.empty() && cache.open(cache_file)) {
+		solver = new cached_solver{solver, &cache};
+	}
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	result.solved = solver->solve(world, plan, result.statistics);
+	std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+	delete solver;
+
+	result.wall_time_ms = std::chrono::duration<double, std::milli>(end - start).count();
+	getrusage(RUSAGE_SELF, &usage);
+	result.peak_rss_kb = usage.ru_maxrss;
+	result.plan_length = result.solved ? plan.size() : 0;
+
+	plan_validation validation = plan_validator{world}.validate(plan);
+	result.valid = validation.solved;
+	result.pushes = result.solved ? validation.pushes : 0;
+	result.predicted_time_ms = result.solved ? validation.predicted_time_ms : 0;
+	return result;
+}
+
+static bench_result run(const std::string& solver_name, const bench_instance& instance, int timeout_seconds, const std::string& cache_file) {
+	bench_result result;
+	int channel[2];
+
+	result.solver = solver_name;
+	result.instance = &instance;
+	result.status = BS_CRASHED;
+	memset(&result.measure, 0, sizeof(result.measure));
+
+	fflush(stdout);
+	if (pipe(channel) != 0) {
+		return result;
+	}
+	pid_t child = fork();
+	if (child < 0) {
+		close(channel[0]);
+		close(channel[1]);
+		return result;
+	}
+	if (child == 0) {
+		close(channel[0]);
+		bench_measure m = measure_run(solver_name, instance.world, cache_file);
+		ssize_t written = write(channel[1], &m, sizeof(m));
+		_exit(written == sizeof(m) ? 0 : 1);
+	}
+
+	close(channel[1]);
+	struct pollfd fd = {channel[0], POLLIN, 0};
+	int ready = poll(&fd, 1, timeout_seconds * 1000);
+	if (ready <= 0) {
+		kill(child, SIGKILL);
+		result.status = BS_TIMEOUT;
+	} else if (read(channel[0], &result.measure, sizeof(result.measure)) == sizeof(result.measure)) {
+		if (!result.measure.solved) {
+			result.status = BS_UNSOLVED;
+		} else {
+			result.status = result.measure.valid ? BS_SOLVED : BS_INVALID;
+		}
+	}
+	close(channel[0]);
+	waitpid(child, nullptr, 0);
+
+	return result;
+}
+
+static void json_escape(FILE* f, const std::string& s) {
+	fputc('"', f);
+	for (unsigned int i=0; i<s.size(); i++) {
+		if (s[i] == '"' || s[i] == '\\') {
+			fputc('\\', f);
+		}
+		fputc(s[i], f);
+	}
+	fputc('"', f);
+}
+
+/**
+ * Write the report. Every result is on its own line, so reports of two commits can be compared with a plain diff as well
+ */
+static bool write_report(const std::string& filename, const std::string& label, const std::vector<bench_result>& results) {
+	FILE* f = fopen(filename.c_str(), "w");
+	if (f == nullptr) {
+		return false;
+	}
+
+	fprintf(f, "{\n  \"label\": ");
+	json_escape(f, label);
+	fprintf(f, ",\n  \"results\": [\n");
+	for (unsigned int i=0; i<results.size(); i++) {
+		const bench_result& r = results[i];
+		fprintf(f, "    {\"solver\": ");
+		json_escape(f, r.solver);
+		fprintf(f, ", \"instance\": ");
+		json_escape(f, r.instance->name);
+		fprintf(f, ", \"rows\": %u, \"columns\": %u, \"blocks\": %lu, \"status\": \"%s\", \"wall_time_ms\": %.3f, \"nodes_expanded\": %lu, \"nodes_generated\": %lu, \"search_memory_bytes\": %lu, \"peak_rss_kb\": %ld, \"plan_length\": %lu, \"pushes\": %lu, \"predicted_time_ms\": %lu}%s\n",
+				r.instance->world.rows(), r.instance->world.columns(), (unsigned long)r.instance->world.blocks().size(),
+				status_names[r.status], r.measure.wall_time_ms,
+				r.measure.statistics.nodes_expanded, r.measure.statistics.nodes_generated, r.measure.statistics.peak_memory_bytes,
+				r.measure.peak_rss_kb, r.measure.plan_length, r.measure.pushes, r.measure.predicted_time_ms,
+				(i + 1) < results.size() ? "," : "");
+	}
+	fprintf(f, "  ]\n}\n");
+	fclose(f);
+	return true;
+}
+
+static void print_usage(const char* program) {
+	fprintf(stderr, "usage: %s [--solver NAME]... [--instances FOLDER] [--report FILE] [--timeout SECONDS] [--label TEXT] [--no-corpus] [--cache FILE]\n", program);
+	fprintf(stderr, "registered solvers:");
+	std::vector<std::string> names = solver_registry::get_instance()->names();
+	for (unsigned int i=0; i<names.size(); i++) {
+		fprintf(stderr, " %s", names[i].c_str());
+	}
+	fprintf(stderr, "\n");
+}
+
+int main(int argc, const char* argv[]) {
+	std::vector<std::string> solvers;
+	std::string instance_folder = BENCH_INSTANCE_FOLDER;
+	std::string report = DEFAULT_REPORT;
+	std::string label = "";
+	std::string cache_file = "";
+	int timeout_seconds = DEFAULT_TIMEOUT_SECONDS;
+	bool corpus = true;
+
+	for (int i=1; i<argc; i++) {
+		std::string arg = argv[i];
+		bool has_value = (i + 1) < argc;
+		if (arg == "--solver" && has_value) {
+			solvers.push_back(argv[++i]);
+		} else if (arg == "--instances" && has_value) {
+			instance_folder = argv[++i];
+		} else if (arg == "--report" && has_value) {
+			report = argv[++i];
+		} else if (arg == "--timeout" && has_value) {
+			timeout_seconds = atoi(argv[++i]);
+		} else if (arg == "--label" && has_value) {
+			label = argv[++i];
+		} else if (arg == "--cache" && has_value) {
+			cache_file = argv[++i];
+		} else if (arg == "--no-corpus") {
+			corpus = false;
+		} else {
+			print_usage(argv[0]);
+			return 1;
+		}
+	}
+	if (solvers.empty()) {
+		solvers = solver_registry::get_instance()->names();
+	}
+	for (unsigned int i=0; i<solvers.size(); i++) {
+		sokoban_solver* s = solver_registry::get_instance()->create(solvers[i]);
+		if (s == nullptr) {
+			fprintf(stderr, "unknown solver %s\n", solvers[i].c_str());
+			print_usage(argv[0]);
+			return 1;
+		}
+		delete s;
+	}
+
+	std::vector<bench_instance> instances;
+	load_instances(instance_folder, instances);
+	if (corpus) {
+		generate_corpus(instances);
+	}
+
+	std::vector<bench_result> results;
+	printf("%-14s %-20s %-9s %12s %12s %12s %8s\n", "solver", "instance", "status", "time (ms)", "expanded", "rss (KB)", "plan");
+	for (unsigned int s=0; s<solvers.size(); s++) {
+		for (unsigned int i=0; i<instances.size(); i++) {
+			bench_result r = run(solvers[s], instances[i], timeout_seconds, cache_file);
+			printf("%-14s %-20s %-9s %12.3f %12lu %12ld %8lu\n", r.solver.c_str(), instances[i].name.c_str(), status_names[r.status],
+					r.measure.wall_time_ms, r.measure.statistics.nodes_expanded, r.measure.peak_rss_kb, r.measure.plan_length);
+			results.push_back(r);
+		}
+	}
+
+	if (!write_report(report, label, results)) {
+		fprintf(stderr, "can't write report %s\n", report.c_str());
+		return 1;
+	}
+	printf("report written in %s\n", report.c_str());
+	return 0;
+}
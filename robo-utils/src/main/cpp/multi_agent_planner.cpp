@@ -0,0 +1,406 @@
+/*
+ * multi_agent_planner.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifdef DESKTOP_BUILD
+
+#include "multi_agent_planner.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <queue>
+#include <unordered_set>
+
+namespace robo_utils {
+
+#define FOREVER ((unsigned int) -1)
+#define UNREACHABLE ((unsigned int) -1)
+#define NOBODY ((unsigned int) -1)
+#define NO_PARENT ((uint32_t) -1)
+#define WAIT_ACTION 0xFF
+
+/**
+ * a cell is occupied by \c owner in the time steps [from, to)
+ */
+struct reservation {
+	unsigned int from;
+	unsigned int to;
+	/**
+	 * robots are numbered from 0, blocks follow the robots
+	 */
+	unsigned int owner;
+};
+
+/**
+ * Who occupies each cell over time
+ */
+class reservation_table {
+private:
+	std::vector<std::vector<reservation>> _cells;
+public:
+	reservation_table(unsigned int cells) : _cells(cells) {
+	}
+public:
+	void reserve(unsigned int cell, unsigned int from, unsigned int to, unsigned int owner) {
+		this->_cells[cell].push_back(reservation{from, to, owner});
+	}
+	/**
+	 * Shorten the endless reservation of \c owner on \c cell so that it finishes at \c time
+	 */
+	void release(unsigned int cell, unsigned int owner, unsigned int time) {
+		std::vector<reservation>& list = this->_cells[cell];
+		for (unsigned int i=0; i<list.size(); i++) {
+			if (list[i].owner == owner && list[i].to == FOREVER) {
+				if (list[i].from >= time) {
+					list.erase(list.begin() + i);
+				} else {
+					list[i].to = time;
+				}
+				return;
+			}
+		}
+	}
+	/**
+	 * @return the owner of the cell at the given time step, ::NOBODY if the cell is free
+	 */
+	unsigned int owner_at(unsigned int cell, unsigned int time) const {
+		const std::vector<reservation>& list = this->_cells[cell];
+		for (unsigned int i=0; i<list.size(); i++) {
+			if (list[i].from <= time && time < list[i].to) {
+				return list[i].owner;
+			}
+		}
+		return NOBODY;
+	}
+	/**
+	 * @return \c true if the cell is free at the given time, apart from the reservations of \c a and \c b
+	 */
+	bool is_free(unsigned int cell, unsigned int time, unsigned int a, unsigned int b) const {
+		unsigned int owner = this->owner_at(cell, time);
+		return owner == NOBODY || owner == a || owner == b;
+	}
+	/**
+	 * @return \c true if the cell is free from the given time on, apart from the reservations of \c a and \c b
+	 */
+	bool is_free_from(unsigned int cell, unsigned int time, unsigned int a, unsigned int b) const {
+		const std::vector<reservation>& list = this->_cells[cell];
+		for (unsigned int i=0; i<list.size(); i++) {
+			if (list[i].to > time && list[i].owner != a && list[i].owner != b) {
+				return false;
+			}
+		}
+		return true;
+	}
+	/**
+	 * @return \c true if someone (apart from \c a and \c b) goes from \c to to \c from while we go from \c from to \c to in the given time step
+	 */
+	bool is_swap(unsigned int from, unsigned int to, unsigned int time, unsigned int a, unsigned int b) const {
+		unsigned int owner = this->owner_at(to, time);
+		if (owner == NOBODY || owner == a || owner == b) {
+			return false;
+		}
+		return this->owner_at(from, time + 1) == owner;
+	}
+	unsigned long memory() const {
+		unsigned long result = this->_cells.capacity() * sizeof(std::vector<reservation>);
+		for (unsigned int i=0; i<this->_cells.size(); i++) {
+			result += this->_cells[i].capacity() * sizeof(reservation);
+		}
+		return result;
+	}
+};
+
+/**
+ * a state of the search of a single delivery
+ */
+struct delivery_node {
+	uint16_t robot;
+	uint16_t block;
+	uint32_t time;
+	uint32_t parent;
+	/**
+	 * the action leading to this node: <tt>type << 2 | direction</tt> or ::WAIT_ACTION
+	 */
+	uint8_t action;
+};
+
+/**
+ * the delivery of a block into a goal
+ */
+struct delivery {
+	unsigned int block;
+	unsigned int goal;
+	/**
+	 * pushes needed to bring a block from each cell into the goal
+	 */
+	std::vector<unsigned int> distance;
+};
+
+/**
+ * the outcome of the search of a delivery
+ */
+struct delivery_path {
+	std::vector<delivery_node> nodes;
+	unsigned int end_time;
+};
+
+struct delivery_entry {
+	unsigned int f;
+	unsigned int h;
+	uint32_t node;
+
+	bool operator<(const delivery_entry& other) const {
+		//std::priority_queue puts the greatest on top
+		if (this->f != other.f) {
+			return this->f > other.f;
+		}
+		return this->h > other.h;
+	}
+};
+
+/**
+ * Compute how many pushes are needed to move a block from every cell into a goal, ignoring the other blocks
+ */
+static std::vector<unsigned int> pull_distances(const sokoban_world& w, unsigned int goal) {
+	std::vector<unsigned int> result(w.cells(), UNREACHABLE);
+	std::vector<unsigned int> queue{goal};
+
+	result[goal] = 0;
+	for (unsigned int i=0; i<queue.size(); i++) {
+		unsigned int block = queue[i];
+		for (int d=0; d<GRID_DIRECTIONS; d++) {
+			grid_direction back = opposite_direction((grid_direction)d);
+			unsigned int previous;
+			unsigned int robot;
+			if (!w.neighbour(block, back, previous) || w.is_wall(previous)) {
+				continue;
+			}
+			if (!w.neighbour(previous, back, robot) || w.is_wall(robot)) {
+				continue;
+			}
+			if (result[previous] == UNREACHABLE) {
+				result[previous] = result[block] + 1;
+				queue.push_back(previous);
+			}
+		}
+	}
+	return result;
+}
+
+/**
+ * Assign every block to a different goal, nearest pairs first
+ *
+ * @return \c false if some block can't reach any free goal
+ */
+static bool assign_goals(const sokoban_world& w, std::vector<delivery>& deliveries) {
+	const std::vector<unsigned int>& blocks = w.blocks();
+	std::vector<unsigned int> goals = w.goals();
+	std::vector<std::vector<unsigned int>> distances;
+	std::vector<std::pair<unsigned int, std::pair<unsigned int, unsigned int>>> pairs;
+	std::vector<bool> block_done(blocks.size(), false);
+	std::vector<bool> goal_done(goals.size(), false);
+
+	for (unsigned int g=0; g<goals.size(); g++) {
+		distances.push_back(pull_distances(w, goals[g]));
+		for (unsigned int b=0; b<blocks.size(); b++) {
+			if (distances[g][blocks[b]] != UNREACHABLE) {
+				pairs.push_back(std::make_pair(distances[g][blocks[b]], std::make_pair(b, g)));
+			}
+		}
+	}
+	std::sort(pairs.begin(), pairs.end());
+
+	for (unsigned int i=0; i<pairs.size(); i++) {
+		unsigned int b = pairs[i].second.first;
+		unsigned int g = pairs[i].second.second;
+		if (block_done[b] || goal_done[g]) {
+			continue;
+		}
+		block_done[b] = true;
+		goal_done[g] = true;
+		deliveries.push_back(delivery{b, goals[g], distances[g]});
+	}
+	return deliveries.size() == blocks.size();
+}
+
+/**
+ * Plan a single delivery for a robot against the reservation table
+ */
+static bool plan_delivery(const sokoban_world& w, const reservation_table& table, const delivery& task, unsigned int robot_id, unsigned int block_id, unsigned int robot_cell, unsigned int block_cell, unsigned int start_time, unsigned int max_steps, delivery_path& path, solver_statistics& statistics) {
+	std::vector<delivery_node> nodes;
+	std::unordered_set<uint64_t> visited;
+	std::priority_queue<delivery_entry> open;
+	unsigned long memory;
+
+	if (task.distance[block_cell] == UNREACHABLE) {
+		return false;
+	}
+	nodes.push_back(delivery_node{(uint16_t)robot_cell, (uint16_t)block_cell, start_time, NO_PARENT, WAIT_ACTION});
+	visited.insert(robot_cell | ((uint64_t)block_cell << 16) | ((uint64_t)start_time << 32));
+	open.push(delivery_entry{start_time + task.distance[block_cell], task.distance[block_cell], 0});
+
+	uint32_t found = NO_PARENT;
+	while (!open.empty()) {
+		uint32_t current = open.top().node;
+		open.pop();
+		delivery_node n = nodes[current];
+
+		if (n.block == task.goal && table.is_free_from(n.block, n.time, robot_id, block_id) && table.is_free_from(n.robot, n.time, robot_id, block_id)) {
+			found = current;
+			break;
+		}
+		if (n.time - start_time >= max_steps) {
+			continue;
+		}
+		statistics.nodes_expanded++;
+
+		unsigned int t = n.time + 1;
+		for (int d=-1; d<GRID_DIRECTIONS; d++) {
+			unsigned int robot = n.robot;
+			unsigned int block = n.block;
+			uint8_t action = WAIT_ACTION;
+
+			if (d >= 0) {
+				if (!w.neighbour(n.robot, (grid_direction)d, robot) || w.is_wall(robot)) {
+					continue;
+				}
+				if (table.is_swap(n.robot, robot, n.time, robot_id, block_id)) {
+					continue;
+				}
+				if (robot == n.block) {
+					if (!w.neighbour(n.block, (grid_direction)d, block) || w.is_wall(block) || task.distance[block] == UNREACHABLE) {
+						continue;
+					}
+					if (table.is_swap(n.block, block, n.time, robot_id, block_id)) {
+						continue;
+					}
+					action = (SAT_PUSH << 2) | d;
+				} else {
+					action = (SAT_MOVE << 2) | d;
+				}
+			}
+			if (!table.is_free(robot, t, robot_id, block_id) || !table.is_free(block, t, robot_id, block_id)) {
+				continue;
+			}
+			uint64_t key = robot | ((uint64_t)block << 16) | ((uint64_t)t << 32);
+			if (!visited.insert(key).second) {
+				continue;
+			}
+			nodes.push_back(delivery_node{(uint16_t)robot, (uint16_t)block, t, current, action});
+			open.push(delivery_entry{t + task.distance[block], task.distance[block], (uint32_t)(nodes.size() - 1)});
+			statistics.nodes_generated++;
+		}
+	}
+
+	memory = nodes.capacity() * sizeof(delivery_node) + visited.size() * (sizeof(uint64_t) + 2 * sizeof(void*)) + visited.bucket_count() * sizeof(void*) + table.memory();
+	if (memory > statistics.peak_memory_bytes) {
+		statistics.peak_memory_bytes = memory;
+	}
+	if (found == NO_PARENT) {
+		return false;
+	}
+
+	path.nodes.clear();
+	for (uint32_t i=found; i!=NO_PARENT; i=nodes[i].parent) {
+		path.nodes.push_back(nodes[i]);
+	}
+	std::reverse(path.nodes.begin(), path.nodes.end());
+	path.end_time = nodes[found].time;
+	return true;
+}
+
+unsigned int makespan(const multi_agent_plan& plan) {
+	unsigned int result = 0;
+
+	for (unsigned int i=0; i<plan.size(); i++) {
+		if (!plan[i].empty() && plan[i].back().time + 1 > result) {
+			result = plan[i].back().time + 1;
+		}
+	}
+	return result;
+}
+
+multi_agent_planner::multi_agent_planner(unsigned int max_steps) : _max_steps{max_steps} {
+
+}
+
+multi_agent_planner::~multi_agent_planner() {
+
+}
+
+bool multi_agent_planner::solve(const sokoban_world& world, const std::vector<unsigned int>& robots, multi_agent_plan& plan, solver_statistics& statistics) {
+	const std::vector<unsigned int>& blocks = world.blocks();
+	unsigned int robot_count = robots.size();
+	reservation_table table{world.cells()};
+	std::vector<delivery> deliveries;
+	std::vector<unsigned int> robot_cell{robots};
+	std::vector<unsigned int> robot_time(robot_count, 0);
+	multi_agent_plan result(robot_count);
+
+	statistics = solver_statistics{0, 0, 0};
+	if (robots.empty() || world.cells() > 0xFFFF) {
+		return false;
+	}
+	for (unsigned int r=0; r<robot_count; r++) {
+		if (robots[r] >= world.cells() || world.is_wall(robots[r]) || world.has_block(robots[r]) || std::count(robots.begin(), robots.end(), robots[r]) > 1) {
+			return false;
+		}
+		table.reserve(robots[r], 0, FOREVER, r);
+	}
+	for (unsigned int b=0; b<blocks.size(); b++) {
+		table.reserve(blocks[b], 0, FOREVER, robot_count + b);
+	}
+	if (!assign_goals(world, deliveries)) {
+		return false;
+	}
+
+	for (unsigned int i=0; i<deliveries.size(); i++) {
+		const delivery& task = deliveries[i];
+		unsigned int block_id = robot_count + task.block;
+		unsigned int best = NOBODY;
+		delivery_path best_path;
+
+		if (blocks[task.block] == task.goal) {
+			continue;
+		}
+		for (unsigned int r=0; r<robot_count; r++) {
+			delivery_path path;
+			if (!plan_delivery(world, table, task, r, block_id, robot_cell[r], blocks[task.block], robot_time[r], this->_max_steps, path, statistics)) {
+				continue;
+			}
+			if (best == NOBODY || path.end_time < best_path.end_time) {
+				best = r;
+				best_path = path;
+			}
+		}
+		if (best == NOBODY) {
+			return false;
+		}
+
+		//the robot and the block leave their cell and follow the path, then they stay in their last cell
+		const std::vector<delivery_node>& nodes = best_path.nodes;
+		unsigned int start = nodes.front().time;
+		table.release(robot_cell[best], best, start);
+		table.release(blocks[task.block], block_id, start);
+		for (unsigned int k=0; k<nodes.size(); k++) {
+			unsigned int to = (k + 1) < nodes.size() ? nodes[k].time + 1 : FOREVER;
+			table.reserve(nodes[k].robot, nodes[k].time, to, best);
+			table.reserve(nodes[k].block, nodes[k].time, to, block_id);
+			if (k > 0 && nodes[k].action != WAIT_ACTION) {
+				sokoban_action action{(sokoban_action_type)(nodes[k].action >> 2), (grid_direction)(nodes[k].action & 0x3)};
+				result[best].push_back(timed_action{nodes[k - 1].time, action});
+			}
+		}
+		robot_cell[best] = nodes.back().robot;
+		robot_time[best] = best_path.end_time;
+	}
+
+	plan.swap(result);
+	return true;
+}
+
+}
+
+#endif /* DESKTOP_BUILD */
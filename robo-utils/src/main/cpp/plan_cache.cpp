@@ -0,0 +1,305 @@
+/*
+ * plan_cache.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifdef DESKTOP_BUILD
+
+#include "plan_cache.hpp"
+#include "sokoban_symmetry.hpp"
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace robo_utils {
+
+#define CACHE_MAGIC "RBPLAN01"
+#define CACHE_MAGIC_LENGTH 8
+/**
+ * bytes of the data area reserved for each slot when a cache file is created
+ */
+#define INITIAL_BYTES_PER_SLOT 64
+/**
+ * a new plan is refused when the table is filled more than this percentage
+ */
+#define MAX_LOAD_PERCENTAGE 75
+
+/**
+ * the beginning of a cache file
+ */
+struct cache_header {
+	char magic[CACHE_MAGIC_LENGTH];
+	uint32_t slots;
+	uint32_t count;
+	uint64_t data_used;
+	uint64_t data_capacity;
+};
+
+/**
+ * an element of the table. Its key and plan are in the data area, one after the other
+ */
+struct cache_slot {
+	uint64_t hash;
+	uint64_t offset;
+	/**
+	 * 0 if the slot is empty
+	 */
+	uint32_t key_length;
+	uint32_t plan_length;
+};
+
+static_assert(sizeof(cache_header) == 32, "cache_header must have the same layout on every host");
+static_assert(sizeof(cache_slot) == 24, "cache_slot must have the same layout on every host");
+
+static unsigned long data_start(uint32_t slots) {
+	return sizeof(cache_header) + slots * sizeof(cache_slot);
+}
+
+/**
+ * Check that a cache file read from the disk can be trusted
+ *
+ * Every key and plan must be within the used part of the data area, and the table must have an empty slot (or ::plan_cache::find would never stop)
+ *
+ * @param[in] memory the mapped file
+ * @param[in] size the bytes of the file
+ * @return \c true if every slot can be read safely
+ */
+static bool is_consistent(const unsigned char* memory, unsigned long size) {
+	const cache_header* header = (const cache_header*)memory;
+
+	if (memcmp(header->magic, CACHE_MAGIC, CACHE_MAGIC_LENGTH) != 0 || header->slots == 0) {
+		return false;
+	}
+	if (data_start(header->slots) > size || header->data_capacity > size - data_start(header->slots) || header->data_used > header->data_capacity) {
+		return false;
+	}
+
+	const cache_slot* table = (const cache_slot*)(memory + sizeof(cache_header));
+	uint32_t used = 0;
+	for (uint32_t i=0; i<header->slots; i++) {
+		if (table[i].key_length == 0) {
+			continue;
+		}
+		//written this way no sum can overflow
+		if (table[i].offset > header->data_used || table[i].key_length > header->data_used - table[i].offset || table[i].plan_length > header->data_used - table[i].offset - table[i].key_length) {
+			return false;
+		}
+		used++;
+	}
+	return used == header->count && used < header->slots;
+}
+
+plan_cache::plan_cache() : _fd{-1}, _memory{nullptr}, _size{0} {
+
+}
+
+plan_cache::~plan_cache() {
+	this->close();
+}
+
+bool plan_cache::open(const std::string& filename, unsigned int slots) {
+	struct stat info;
+
+	this->close();
+	if (slots == 0) {
+		return false;
+	}
+	this->_fd = ::open(filename.c_str(), O_RDWR | O_CREAT, 0644);
+	if (this->_fd < 0 || fstat(this->_fd, &info) != 0) {
+		this->close();
+		return false;
+	}
+
+	bool created = info.st_size == 0;
+	if (created) {
+		info.st_size = data_start(slots) + slots * INITIAL_BYTES_PER_SLOT;
+		if (ftruncate(this->_fd, info.st_size) != 0) {
+			this->close();
+			return false;
+		}
+	} else if ((unsigned long)info.st_size < sizeof(cache_header)) {
+		this->close();
+		return false;
+	}
+
+	void* memory = mmap(nullptr, info.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, this->_fd, 0);
+	if (memory == MAP_FAILED) {
+		this->close();
+		return false;
+	}
+	this->_memory = (unsigned char*)memory;
+	this->_size = info.st_size;
+
+	cache_header* header = (cache_header*)this->_memory;
+	if (created) {
+		//ftruncate filled the file with 0, hence every slot is already empty
+		memcpy(header->magic, CACHE_MAGIC, CACHE_MAGIC_LENGTH);
+		header->slots = slots;
+		header->count = 0;
+		header->data_used = 0;
+		header->data_capacity = slots * INITIAL_BYTES_PER_SLOT;
+	} else if (!is_consistent(this->_memory, this->_size)) {
+		this->close();
+		return false;
+	}
+	return true;
+}
+
+void plan_cache::close() {
+	if (this->_memory != nullptr) {
+		munmap(this->_memory, this->_size);
+		this->_memory = nullptr;
+		this->_size = 0;
+	}
+	if (this->_fd >= 0) {
+		::close(this->_fd);
+		this->_fd = -1;
+	}
+}
+
+bool plan_cache::is_open() const {
+	return this->_memory != nullptr;
+}
+
+unsigned int plan_cache::size() const {
+	if (!this->is_open()) {
+		return 0;
+	}
+	return ((const cache_header*)this->_memory)->count;
+}
+
+bool plan_cache::find(const std::string& key, unsigned int& slot) const {
+	const cache_header* header = (const cache_header*)this->_memory;
+	const cache_slot* table = (const cache_slot*)(this->_memory + sizeof(cache_header));
+	const unsigned char* data = this->_memory + data_start(header->slots);
+	uint64_t hash = hash_key(key);
+
+	for (slot = hash % header->slots; table[slot].key_length != 0; slot = (slot + 1) % header->slots) {
+		if (table[slot].hash == hash && table[slot].key_length == key.size() && memcmp(data + table[slot].offset, key.data(), key.size()) == 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+bool plan_cache::lookup(const sokoban_world& world, sokoban_plan& plan) const {
+	grid_symmetry applied;
+	unsigned int slot;
+
+	if (!this->is_open()) {
+		return false;
+	}
+	std::string key = canonical_key(world, applied);
+	if (!this->find(key, slot)) {
+		return false;
+	}
+
+	const cache_header* header = (const cache_header*)this->_memory;
+	const cache_slot& entry = ((const cache_slot*)(this->_memory + sizeof(cache_header)))[slot];
+	const unsigned char* actions = this->_memory + data_start(header->slots) + entry.offset + entry.key_length;
+	grid_symmetry back = inverse_symmetry(applied);
+
+	plan.resize(entry.plan_length);
+	for (unsigned int i=0; i<entry.plan_length; i++) {
+		plan[i].type = (sokoban_action_type)(actions[i] >> 2);
+		plan[i].direction = transform_direction((grid_direction)(actions[i] & 0x3), back);
+	}
+	return true;
+}
+
+bool plan_cache::store(const sokoban_world& world, const sokoban_plan& plan) {
+	grid_symmetry applied;
+	unsigned int slot;
+
+	if (!this->is_open()) {
+		return false;
+	}
+	std::string key = canonical_key(world, applied);
+	if (this->find(key, slot)) {
+		return true;
+	}
+	cache_header* header = (cache_header*)this->_memory;
+	if ((header->count + 1) * 100 > (unsigned long)header->slots * MAX_LOAD_PERCENTAGE) {
+		return false;
+	}
+	if (!this->reserve(key.size() + plan.size())) {
+		return false;
+	}
+
+	//the file may have been mapped elsewhere
+	header = (cache_header*)this->_memory;
+	cache_slot& entry = ((cache_slot*)(this->_memory + sizeof(cache_header)))[slot];
+	unsigned char* data = this->_memory + data_start(header->slots) + header->data_used;
+
+	memcpy(data, key.data(), key.size());
+	for (unsigned int i=0; i<plan.size(); i++) {
+		data[key.size() + i] = (unsigned char)((plan[i].type << 2) | transform_direction(plan[i].direction, applied));
+	}
+	entry.hash = hash_key(key);
+	entry.offset = header->data_used;
+	entry.plan_length = plan.size();
+	//written last: the slot becomes visible only when complete
+	entry.key_length = key.size();
+	header->data_used += key.size() + plan.size();
+	header->count++;
+	return true;
+}
+
+bool plan_cache::reserve(unsigned long bytes) {
+	cache_header* header = (cache_header*)this->_memory;
+
+	if (header->data_capacity - header->data_used >= bytes) {
+		return true;
+	}
+	unsigned long capacity = 2 * header->data_capacity;
+	if (capacity < header->data_used + bytes) {
+		capacity = header->data_used + bytes;
+	}
+	unsigned long size = data_start(header->slots) + capacity;
+
+	if (ftruncate(this->_fd, size) != 0) {
+		return false;
+	}
+	void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, this->_fd, 0);
+	if (memory == MAP_FAILED) {
+		return false;
+	}
+	munmap(this->_memory, this->_size);
+	this->_memory = (unsigned char*)memory;
+	this->_size = size;
+	((cache_header*)this->_memory)->data_capacity = capacity;
+	return true;
+}
+
+cached_solver::cached_solver(sokoban_solver* solver, plan_cache* cache) : sokoban_solver{}, _solver{solver}, _cache{cache} {
+
+}
+
+cached_solver::~cached_solver() {
+	delete this->_solver;
+}
+
+const char* cached_solver::name() const {
+	return this->_solver->name();
+}
+
+bool cached_solver::solve(const sokoban_world& world, sokoban_plan& plan, solver_statistics& statistics) {
+	if (this->_cache->lookup(world, plan)) {
+		statistics = solver_statistics{0, 0, 0};
+		return true;
+	}
+	if (!this->_solver->solve(world, plan, statistics)) {
+		return false;
+	}
+	this->_cache->store(world, plan);
+	return true;
+}
+
+}
+
+#endif /* DESKTOP_BUILD */
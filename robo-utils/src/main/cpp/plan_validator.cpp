@@ -0,0 +1,133 @@
+/*
+ * plan_validator.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifdef DESKTOP_BUILD
+
+#include "plan_validator.hpp"
+
+namespace robo_utils {
+
+#define TEST_CELL(bitboard, cell) (((bitboard)[(cell) >> 6] >> ((cell) & 63)) & 1)
+#define SET_CELL(bitboard, cell) (bitboard)[(cell) >> 6] |= (uint64_t)1 << ((cell) & 63)
+#define CLEAR_CELL(bitboard, cell) (bitboard)[(cell) >> 6] &= ~((uint64_t)1 << ((cell) & 63))
+
+execution_time_model default_execution_time_model() {
+	execution_time_model result;
+
+	result.move_ms = 1200;
+	result.push_ms = 1600;
+	result.turn_90_ms = 700;
+	result.turn_180_ms = 1300;
+	result.message_ms = 150;
+	//the orientation of a robot after its construction
+	result.start_orientation = GD_DOWN;
+	return result;
+}
+
+plan_validator::plan_validator(const sokoban_world& world, const execution_time_model& time_model) : _stride{world.columns() + 2}, _delta{}, _walls{}, _goals{}, _blocks{}, _misplaced{0}, _player{0}, _time_model(time_model), _current{} {
+	unsigned int framed = (world.rows() + 2) * this->_stride;
+	unsigned int words = (framed + 63) / 64;
+
+	this->_delta[GD_UP] = -(int)this->_stride;
+	this->_delta[GD_RIGHT] = 1;
+	this->_delta[GD_DOWN] = this->_stride;
+	this->_delta[GD_LEFT] = -1;
+	this->_walls.assign(words, 0);
+	this->_goals.assign(words, 0);
+	this->_blocks.assign(words, 0);
+
+	for (unsigned int i=0; i<framed; i++) {
+		unsigned int y = i / this->_stride;
+		unsigned int x = i % this->_stride;
+		if (y == 0 || x == 0 || y == world.rows() + 1 || x == world.columns() + 1) {
+			SET_CELL(this->_walls, i);
+			continue;
+		}
+		unsigned int cell = (y - 1) * world.columns() + (x - 1);
+		if (world.is_wall(cell)) {
+			SET_CELL(this->_walls, i);
+		}
+		if (world.is_goal(cell)) {
+			SET_CELL(this->_goals, i);
+		}
+	}
+	for (unsigned int i=0; i<world.blocks().size(); i++) {
+		unsigned int cell = world.blocks()[i];
+		unsigned int framed_cell = (cell / world.columns() + 1) * this->_stride + cell % world.columns() + 1;
+		SET_CELL(this->_blocks, framed_cell);
+		if (!world.is_goal(cell)) {
+			this->_misplaced++;
+		}
+	}
+	this->_player = (world.player() / world.columns() + 1) * this->_stride + world.player() % world.columns() + 1;
+}
+
+plan_validator::~plan_validator() {
+
+}
+
+plan_validation plan_validator::validate(const sokoban_plan& plan) {
+	return this->validate(plan.data(), plan.size());
+}
+
+plan_validation plan_validator::validate(const sokoban_action* actions, unsigned int size) {
+	plan_validation result{true, size, false, 0, 0, 0, 0};
+	const uint64_t* walls = this->_walls.data();
+	const uint64_t* goals = this->_goals.data();
+	const execution_time_model& times = this->_time_model;
+	unsigned int robot = this->_player;
+	unsigned int misplaced = this->_misplaced;
+	unsigned int orientation = times.start_orientation;
+	unsigned long turn_time = 0;
+
+	this->_current = this->_blocks;
+	uint64_t* blocks = this->_current.data();
+
+	for (unsigned int i=0; i<size; i++) {
+		unsigned int d = actions[i].direction & 0x3;
+		unsigned int next = robot + this->_delta[d];
+
+		if (TEST_CELL(walls, next)) {
+			result.valid = false;
+		} else if (actions[i].type == SAT_MOVE) {
+			result.valid = !TEST_CELL(blocks, next);
+		} else {
+			unsigned int beyond = next + this->_delta[d];
+			result.valid = TEST_CELL(blocks, next) && !TEST_CELL(walls, beyond) && !TEST_CELL(blocks, beyond);
+			if (result.valid) {
+				CLEAR_CELL(blocks, next);
+				SET_CELL(blocks, beyond);
+				misplaced += TEST_CELL(goals, next);
+				misplaced -= TEST_CELL(goals, beyond);
+			}
+		}
+		if (!result.valid) {
+			result.failed_action = i;
+			break;
+		}
+
+		if (d != orientation) {
+			result.turns++;
+			turn_time += ((d ^ orientation) == 2) ? times.turn_180_ms : times.turn_90_ms;
+			orientation = d;
+		}
+		if (actions[i].type == SAT_MOVE) {
+			result.moves++;
+		} else {
+			result.pushes++;
+		}
+		robot = next;
+	}
+
+	result.solved = result.valid && misplaced == 0;
+	result.predicted_time_ms = turn_time + (unsigned long)result.moves * times.move_ms + (unsigned long)result.pushes * times.push_ms + (unsigned long)(result.moves + result.pushes) * times.message_ms;
+	return result;
+}
+
+}
+
+#endif /* DESKTOP_BUILD */
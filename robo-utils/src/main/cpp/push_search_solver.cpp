@@ -0,0 +1,413 @@
+/*
+ * push_search_solver.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifdef DESKTOP_BUILD
+
+#include "push_search_solver.hpp"
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <stdint.h>
+#include <unordered_set>
+
+namespace robo_utils {
+
+/**
+ * the parent of the starting state
+ */
+#define NO_PARENT 0xFFFFFFFFu
+/**
+ * the maximum number of cells a world may have to be solved by push_search_solver (cells are stored in 16 bits)
+ */
+#define PUSH_SEARCH_MAX_CELLS 0xFFFF
+/**
+ * distance of a cell from where no goal can be reached
+ */
+#define UNREACHABLE 0xFFFFFFFFu
+
+/**
+ * A state of the search. The blocks of the state are stored in push_search_space::pool
+ */
+struct push_node {
+	/**
+	 * the index of the state generating this one
+	 */
+	uint32_t parent;
+	/**
+	 * the smallest cell index the robot can reach
+	 */
+	uint16_t player;
+	/**
+	 * the cell where the block pushed to reach this state was
+	 */
+	uint16_t pushed_from;
+	/**
+	 * the direction of the push leading to this state
+	 */
+	uint8_t direction;
+};
+
+/**
+ * Everything the search needs
+ */
+struct push_search_space {
+	const sokoban_world& world;
+	/**
+	 * number of blocks in every state
+	 */
+	unsigned int blocks;
+	/**
+	 * sorted blocks of each state: the blocks of the i-th state are in <tt>[i*blocks, (i+1)*blocks)</tt>.
+	 * Reach it through \c data(): without blocks the pool is empty
+	 */
+	std::vector<uint16_t> pool;
+	/**
+	 * all the states generated
+	 */
+	std::vector<push_node> nodes;
+	/**
+	 * number of pushes needed to bring a block in the cell to the nearest goal, ignoring other blocks
+	 */
+	std::vector<unsigned int> goal_distance;
+	/**
+	 * \c true if in the current configuration there's a block in the cell
+	 */
+	std::vector<bool> occupied;
+	/**
+	 * <tt>reach_stamp[i] == stamp</tt> iff the robot can reach the cell \c i in the last call of ::compute_reachable
+	 */
+	std::vector<uint32_t> reach_stamp;
+	uint32_t stamp;
+	/**
+	 * the cells reached in the last call of ::compute_reachable
+	 */
+	std::vector<uint16_t> reached;
+
+	push_search_space(const sokoban_world& w) : world(w), blocks{(unsigned int)w.blocks().size()}, pool{}, nodes{}, goal_distance(w.cells(), UNREACHABLE), occupied(w.cells(), false), reach_stamp(w.cells(), 0), stamp{0}, reached{} {
+	}
+};
+
+struct push_state_hash {
+	const push_search_space* space;
+
+	size_t operator()(uint32_t node) const {
+		//FNV-1a
+		uint32_t result = 2166136261u;
+		const uint16_t* b = space->pool.data() + node * space->blocks;
+		for (unsigned int i=0; i<space->blocks; i++) {
+			result = (result ^ b[i]) * 16777619u;
+		}
+		result = (result ^ space->nodes[node].player) * 16777619u;
+		return result;
+	}
+};
+
+struct push_state_equal {
+	const push_search_space* space;
+
+	bool operator()(uint32_t a, uint32_t b) const {
+		if (space->nodes[a].player != space->nodes[b].player) {
+			return false;
+		}
+		return std::equal(space->pool.data() + a * space->blocks, space->pool.data() + a * space->blocks + space->blocks, space->pool.data() + b * space->blocks);
+	}
+};
+
+typedef std::unordered_set<uint32_t, push_state_hash, push_state_equal> push_state_set;
+
+/**
+ * Compute how many pushes are needed to move a block from every cell to the nearest goal
+ *
+ * The computation is done backwards: starting from the goals, blocks are \a pulled away.
+ */
+static void compute_goal_distances(push_search_space& space) {
+	const sokoban_world& w = space.world;
+	std::vector<unsigned int> queue = w.goals();
+
+	for (unsigned int i=0; i<queue.size(); i++) {
+		space.goal_distance[queue[i]] = 0;
+	}
+	for (unsigned int i=0; i<queue.size(); i++) {
+		unsigned int block = queue[i];
+		for (int d=0; d<GRID_DIRECTIONS; d++) {
+			grid_direction back = opposite_direction((grid_direction)d);
+			unsigned int previous;
+			unsigned int robot;
+			if (!w.neighbour(block, back, previous) || w.is_wall(previous)) {
+				continue;
+			}
+			if (!w.neighbour(previous, back, robot) || w.is_wall(robot)) {
+				continue;
+			}
+			if (space.goal_distance[previous] == UNREACHABLE) {
+				space.goal_distance[previous] = space.goal_distance[block] + 1;
+				queue.push_back(previous);
+			}
+		}
+	}
+}
+
+/**
+ * Compute the cells the robot can reach given the blocks in push_search_space::occupied
+ *
+ * @return the smallest cell index the robot can reach
+ */
+static uint16_t compute_reachable(push_search_space& space, unsigned int start) {
+	const sokoban_world& w = space.world;
+	uint16_t result = start;
+
+	space.stamp++;
+	space.reached.clear();
+	space.reached.push_back(start);
+	space.reach_stamp[start] = space.stamp;
+	for (unsigned int i=0; i<space.reached.size(); i++) {
+		unsigned int current = space.reached[i];
+		if (current < result) {
+			result = current;
+		}
+		for (int d=0; d<GRID_DIRECTIONS; d++) {
+			unsigned int next;
+			if (!w.neighbour(current, (grid_direction)d, next) || w.is_wall(next) || space.occupied[next] || space.reach_stamp[next] == space.stamp) {
+				continue;
+			}
+			space.reach_stamp[next] = space.stamp;
+			space.reached.push_back(next);
+		}
+	}
+
+	return result;
+}
+
+static void mark_blocks(push_search_space& space, uint32_t node, bool value) {
+	const uint16_t* b = space.pool.data() + node * space.blocks;
+	for (unsigned int i=0; i<space.blocks; i++) {
+		space.occupied[b[i]] = value;
+	}
+}
+
+static bool is_goal_state(const push_search_space& space, uint32_t node) {
+	const uint16_t* b = space.pool.data() + node * space.blocks;
+	for (unsigned int i=0; i<space.blocks; i++) {
+		if (!space.world.is_goal(b[i])) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static unsigned int heuristic(const push_search_space& space, uint32_t node) {
+	const uint16_t* b = space.pool.data() + node * space.blocks;
+	unsigned int result = 0;
+	for (unsigned int i=0; i<space.blocks; i++) {
+		result += space.goal_distance[b[i]];
+	}
+	return result;
+}
+
+/**
+ * Append to the plan the moves leading the robot from \c from to \c to without pushing anything
+ */
+static void append_walk(push_search_space& space, unsigned int from, unsigned int to, sokoban_plan& plan) {
+	const sokoban_world& w = space.world;
+	std::vector<uint8_t> came_from(w.cells(), GRID_DIRECTIONS);
+	std::vector<unsigned int> queue{from};
+
+	came_from[from] = 0;
+	for (unsigned int i=0; i<queue.size() && queue[i] != to; i++) {
+		for (int d=0; d<GRID_DIRECTIONS; d++) {
+			unsigned int next;
+			if (!w.neighbour(queue[i], (grid_direction)d, next) || w.is_wall(next) || space.occupied[next] || came_from[next] != GRID_DIRECTIONS) {
+				continue;
+			}
+			came_from[next] = d;
+			queue.push_back(next);
+		}
+	}
+
+	std::vector<grid_direction> reversed;
+	for (unsigned int current = to; current != from; ) {
+		grid_direction d = (grid_direction)came_from[current];
+		reversed.push_back(d);
+		w.neighbour(current, opposite_direction(d), current);
+	}
+	for (unsigned int i=reversed.size(); i>0; i--) {
+		plan.push_back(sokoban_action{SAT_MOVE, reversed[i-1]});
+	}
+}
+
+/**
+ * Rebuild the whole plan, robot moves included, reaching the given state
+ */
+static void build_plan(push_search_space& space, uint32_t node, sokoban_plan& plan) {
+	const sokoban_world& w = space.world;
+	std::vector<uint32_t> pushes;
+
+	for (uint32_t current = node; space.nodes[current].parent != NO_PARENT; current = space.nodes[current].parent) {
+		pushes.push_back(current);
+	}
+
+	std::fill(space.occupied.begin(), space.occupied.end(), false);
+	for (unsigned int i=0; i<w.blocks().size(); i++) {
+		space.occupied[w.blocks()[i]] = true;
+	}
+	unsigned int robot = w.player();
+	for (unsigned int i=pushes.size(); i>0; i--) {
+		const push_node& n = space.nodes[pushes[i-1]];
+		grid_direction d = (grid_direction)n.direction;
+		unsigned int stand;
+		unsigned int target;
+		w.neighbour(n.pushed_from, opposite_direction(d), stand);
+		w.neighbour(n.pushed_from, d, target);
+
+		append_walk(space, robot, stand, plan);
+		plan.push_back(sokoban_action{SAT_PUSH, d});
+		space.occupied[n.pushed_from] = false;
+		space.occupied[target] = true;
+		robot = n.pushed_from;
+	}
+}
+
+push_search_solver::push_search_solver(push_search_strategy strategy) : _strategy{strategy} {
+
+}
+
+push_search_solver::~push_search_solver() {
+
+}
+
+const char* push_search_solver::name() const {
+	return this->_strategy == PSS_BREADTH_FIRST ? "push-bfs" : "push-greedy";
+}
+
+bool push_search_solver::solve(const sokoban_world& world, sokoban_plan& plan, solver_statistics& statistics) {
+	push_search_space space{world};
+	const unsigned int k = space.blocks;
+
+	statistics.nodes_expanded = 0;
+	statistics.nodes_generated = 0;
+	statistics.peak_memory_bytes = 0;
+
+	if (world.cells() > PUSH_SEARCH_MAX_CELLS) {
+		return false;
+	}
+
+	compute_goal_distances(space);
+	for (unsigned int i=0; i<k; i++) {
+		if (space.goal_distance[world.blocks()[i]] == UNREACHABLE) {
+			return false;
+		}
+	}
+
+	//the starting state
+	for (unsigned int i=0; i<k; i++) {
+		space.pool.push_back(world.blocks()[i]);
+	}
+	std::sort(space.pool.begin(), space.pool.end());
+	mark_blocks(space, 0, true);
+	space.nodes.push_back(push_node{NO_PARENT, compute_reachable(space, world.player()), 0, 0});
+	mark_blocks(space, 0, false);
+
+	push_state_set visited{1024, push_state_hash{&space}, push_state_equal{&space}};
+	visited.insert(0);
+	statistics.nodes_generated = 1;
+
+	typedef std::pair<unsigned int, uint32_t> open_entry;
+	std::priority_queue<open_entry, std::vector<open_entry>, std::greater<open_entry> > open;
+	uint32_t next_breadth_first = 0;
+	uint32_t solution = is_goal_state(space, 0) ? 0 : NO_PARENT;
+
+	if (this->_strategy == PSS_GREEDY) {
+		open.push(open_entry{heuristic(space, 0), 0});
+	}
+
+	std::vector<uint16_t> reachable;
+	while (solution == NO_PARENT) {
+		uint32_t current;
+		if (this->_strategy == PSS_GREEDY) {
+			if (open.empty()) {
+				break;
+			}
+			current = open.top().second;
+			open.pop();
+		} else {
+			if (next_breadth_first == space.nodes.size()) {
+				break;
+			}
+			current = next_breadth_first++;
+		}
+		statistics.nodes_expanded++;
+
+		mark_blocks(space, current, true);
+		compute_reachable(space, space.nodes[current].player);
+		reachable = space.reached;
+
+		for (unsigned int r=0; r<reachable.size() && solution == NO_PARENT; r++) {
+			for (int d=0; d<GRID_DIRECTIONS; d++) {
+				unsigned int from;
+				unsigned int to;
+				if (!world.neighbour(reachable[r], (grid_direction)d, from) || !space.occupied[from]) {
+					continue;
+				}
+				if (!world.neighbour(from, (grid_direction)d, to) || world.is_wall(to) || space.occupied[to] || space.goal_distance[to] == UNREACHABLE) {
+					continue;
+				}
+
+				//build the successor at the end of the storage
+				uint32_t child = space.nodes.size();
+				for (unsigned int i=0; i<k; i++) {
+					uint16_t b = space.pool[current * k + i];
+					space.pool.push_back(b == from ? to : b);
+				}
+				std::sort(space.pool.begin() + child * k, space.pool.end());
+
+				space.occupied[from] = false;
+				space.occupied[to] = true;
+				uint16_t player = compute_reachable(space, from);
+				space.occupied[to] = false;
+				space.occupied[from] = true;
+
+				space.nodes.push_back(push_node{current, player, (uint16_t)from, (uint8_t)d});
+				if (!visited.insert(child).second) {
+					space.nodes.pop_back();
+					space.pool.resize(child * k);
+					continue;
+				}
+				statistics.nodes_generated++;
+
+				if (is_goal_state(space, child)) {
+					solution = child;
+					break;
+				}
+				if (this->_strategy == PSS_GREEDY) {
+					open.push(open_entry{heuristic(space, child), child});
+				}
+			}
+		}
+		mark_blocks(space, current, false);
+	}
+
+	statistics.peak_memory_bytes =
+			space.pool.capacity() * sizeof(uint16_t) +
+			space.nodes.capacity() * sizeof(push_node) +
+			visited.bucket_count() * sizeof(void*) +
+			visited.size() * (sizeof(uint32_t) + 2 * sizeof(void*)) +
+			open.size() * sizeof(open_entry) +
+			space.goal_distance.capacity() * sizeof(unsigned int) +
+			space.reach_stamp.capacity() * sizeof(uint32_t);
+
+	if (solution == NO_PARENT) {
+		return false;
+	}
+
+	plan.clear();
+	build_plan(space, solution, plan);
+	return true;
+}
+
+}
+
+#endif /* DESKTOP_BUILD */
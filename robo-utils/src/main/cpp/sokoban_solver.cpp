@@ -0,0 +1,63 @@
+/*
+ * sokoban_solver.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifdef DESKTOP_BUILD
+
+#include "sokoban_solver.hpp"
+#include "push_search_solver.hpp"
+
+namespace robo_utils {
+
+static sokoban_solver* create_push_bfs_solver() {
+	return new push_search_solver{PSS_BREADTH_FIRST};
+}
+
+static sokoban_solver* create_push_greedy_solver() {
+	return new push_search_solver{PSS_GREEDY};
+}
+
+solver_registry::solver_registry() : _factories{} {
+	this->add("push-bfs", create_push_bfs_solver);
+	this->add("push-greedy", create_push_greedy_solver);
+}
+
+bool solver_registry::add(const std::string& name, sokoban_solver_factory factory) {
+	for (unsigned int i=0; i<this->_factories.size(); i++) {
+		if (this->_factories[i].first == name) {
+			return false;
+		}
+	}
+	this->_factories.push_back(std::make_pair(name, factory));
+	return true;
+}
+
+std::vector<std::string> solver_registry::names() const {
+	std::vector<std::string> result;
+	for (unsigned int i=0; i<this->_factories.size(); i++) {
+		result.push_back(this->_factories[i].first);
+	}
+	return result;
+}
+
+sokoban_solver* solver_registry::create(const std::string& name) const {
+	for (unsigned int i=0; i<this->_factories.size(); i++) {
+		if (this->_factories[i].first == name) {
+			return this->_factories[i].second();
+		}
+	}
+	return nullptr;
+}
+
+solver_registry* solver_registry::get_instance() {
+	static solver_registry instance; /* The single instance */
+
+	return &instance;
+}
+
+}
+
+#endif /* DESKTOP_BUILD */
@@ -0,0 +1,164 @@
+/*
+ * sokoban_symmetry.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifdef DESKTOP_BUILD
+
+#include "sokoban_symmetry.hpp"
+
+namespace robo_utils {
+
+#define CELL_WALL 1
+#define CELL_GOAL 2
+#define CELL_BLOCK 4
+#define CELL_PLAYER 8
+
+/**
+ * how a symmetry changes a (dx, dy) displacement: dx' = xx * dx + xy * dy, dy' = yx * dx + yy * dy
+ */
+struct symmetry_matrix {
+	int xx;
+	int xy;
+	int yx;
+	int yy;
+};
+
+static const symmetry_matrix matrices[GRID_SYMMETRIES] = {
+		{ 1,  0,  0,  1}, //GS_IDENTITY
+		{ 0, -1,  1,  0}, //GS_ROTATE_90
+		{-1,  0,  0, -1}, //GS_ROTATE_180
+		{ 0,  1, -1,  0}, //GS_ROTATE_270
+		{-1,  0,  0,  1}, //GS_FLIP_COLUMNS
+		{ 1,  0,  0, -1}, //GS_FLIP_ROWS
+		{ 0,  1,  1,  0}, //GS_TRANSPOSE
+		{ 0, -1, -1,  0}, //GS_ANTI_TRANSPOSE
+};
+
+static const int direction_dx[GRID_DIRECTIONS] = {0, 1, 0, -1};
+static const int direction_dy[GRID_DIRECTIONS] = {-1, 0, 1, 0};
+
+static bool is_swapping(grid_symmetry s) {
+	return matrices[s].xx == 0;
+}
+
+/**
+ * Move a cell of a rows x columns grid according to a symmetry
+ *
+ * @return the index of the cell in the transformed grid
+ */
+static unsigned int transform_index(unsigned int index, unsigned int rows, unsigned int columns, grid_symmetry s) {
+	const symmetry_matrix& m = matrices[s];
+	int x = index % columns;
+	int y = index / columns;
+	//coordinates relative to the centre of the grid (doubled, so they stay integers)
+	int cx = 2 * x - (int)(columns - 1);
+	int cy = 2 * y - (int)(rows - 1);
+	int tx = m.xx * cx + m.xy * cy;
+	int ty = m.yx * cx + m.yy * cy;
+	unsigned int new_rows = is_swapping(s) ? columns : rows;
+	unsigned int new_columns = is_swapping(s) ? rows : columns;
+
+	return ((ty + (int)(new_rows - 1)) / 2) * new_columns + (tx + (int)(new_columns - 1)) / 2;
+}
+
+grid_symmetry inverse_symmetry(grid_symmetry s) {
+	switch (s) {
+	case GS_ROTATE_90: return GS_ROTATE_270;
+	case GS_ROTATE_270: return GS_ROTATE_90;
+	default: return s;
+	}
+}
+
+grid_direction transform_direction(grid_direction d, grid_symmetry s) {
+	const symmetry_matrix& m = matrices[s];
+	int dx = m.xx * direction_dx[d] + m.xy * direction_dy[d];
+	int dy = m.yx * direction_dx[d] + m.yy * direction_dy[d];
+
+	for (unsigned int i=0; i<GRID_DIRECTIONS; i++) {
+		if (direction_dx[i] == dx && direction_dy[i] == dy) {
+			return (grid_direction)i;
+		}
+	}
+	return d;
+}
+
+sokoban_world transform_world(const sokoban_world& world, grid_symmetry s) {
+	unsigned int rows = world.rows();
+	unsigned int columns = world.columns();
+	sokoban_world result = is_swapping(s) ? sokoban_world{columns, rows} : sokoban_world{rows, columns};
+
+	for (unsigned int i=0; i<world.cells(); i++) {
+		unsigned int j = transform_index(i, rows, columns, s);
+		result.set_wall(j, world.is_wall(i));
+		result.set_goal(j, world.is_goal(i));
+	}
+	for (unsigned int i=0; i<world.blocks().size(); i++) {
+		result.add_block(transform_index(world.blocks()[i], rows, columns, s));
+	}
+	result.set_player(transform_index(world.player(), rows, columns, s));
+	return result;
+}
+
+sokoban_plan transform_plan(const sokoban_plan& plan, grid_symmetry s) {
+	sokoban_plan result{plan};
+
+	for (unsigned int i=0; i<result.size(); i++) {
+		result[i].direction = transform_direction(result[i].direction, s);
+	}
+	return result;
+}
+
+/**
+ * Encode the world as it would be after applying a symmetry, without building it
+ */
+static std::string encode(const sokoban_world& world, grid_symmetry s) {
+	unsigned int rows = world.rows();
+	unsigned int columns = world.columns();
+	unsigned int new_rows = is_swapping(s) ? columns : rows;
+	unsigned int new_columns = is_swapping(s) ? rows : columns;
+	std::string result(4 + world.cells(), '\0');
+
+	result[0] = (char)(new_rows >> 8);
+	result[1] = (char)(new_rows & 0xFF);
+	result[2] = (char)(new_columns >> 8);
+	result[3] = (char)(new_columns & 0xFF);
+	for (unsigned int i=0; i<world.cells(); i++) {
+		result[4 + transform_index(i, rows, columns, s)] = (char)((world.is_wall(i) ? CELL_WALL : 0) | (world.is_goal(i) ? CELL_GOAL : 0));
+	}
+	for (unsigned int i=0; i<world.blocks().size(); i++) {
+		result[4 + transform_index(world.blocks()[i], rows, columns, s)] |= CELL_BLOCK;
+	}
+	result[4 + transform_index(world.player(), rows, columns, s)] |= CELL_PLAYER;
+	return result;
+}
+
+std::string canonical_key(const sokoban_world& world, grid_symmetry& applied) {
+	std::string best = encode(world, GS_IDENTITY);
+	applied = GS_IDENTITY;
+
+	for (unsigned int s=1; s<GRID_SYMMETRIES; s++) {
+		std::string candidate = encode(world, (grid_symmetry)s);
+		if (candidate < best) {
+			best.swap(candidate);
+			applied = (grid_symmetry)s;
+		}
+	}
+	return best;
+}
+
+unsigned long long hash_key(const std::string& key) {
+	unsigned long long result = 14695981039346656037ULL;
+
+	for (unsigned int i=0; i<key.size(); i++) {
+		result ^= (unsigned char)key[i];
+		result *= 1099511628211ULL;
+	}
+	return result;
+}
+
+}
+
+#endif /* DESKTOP_BUILD */
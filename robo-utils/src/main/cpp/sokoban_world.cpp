@@ -0,0 +1,386 @@
+/*
+ * sokoban_world.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifdef DESKTOP_BUILD
+
+#include "sokoban_world.hpp"
+#include <algorithm>
+#include <fstream>
+#include <random>
+#include <sstream>
+
+namespace robo_utils {
+
+#define NO_PLAYER ((unsigned int) -1)
+/**
+ * percentage of inner cells of a generated world which become pillars
+ */
+#define GENERATED_PILLARS_PERCENTAGE 8
+/**
+ * how many backward steps are performed, per block, while generating a world
+ */
+#define GENERATED_PULLS_PER_BLOCK 60
+/**
+ * how many times a world is set up again when its backward walk ends with every block on a goal
+ */
+#define GENERATED_WALK_ATTEMPTS 16
+
+sokoban_world::sokoban_world(unsigned int rows, unsigned int columns) : _rows{rows}, _columns{columns}, _walls(rows * columns, false), _goals(rows * columns, false), _blocks{}, _player{0} {
+
+}
+
+sokoban_world::~sokoban_world() {
+
+}
+
+bool sokoban_world::load_xsb(const std::string& text) {
+	std::vector<std::string> lines;
+	std::string line;
+	std::istringstream stream{text};
+	unsigned int columns = 0;
+
+	while (std::getline(stream, line)) {
+		if (!line.empty() && line[line.size() - 1] == '\r') {
+			line.erase(line.size() - 1);
+		}
+		lines.push_back(line);
+		if (line.size() > columns) {
+			columns = line.size();
+		}
+	}
+	//drop trailing empty lines
+	while (!lines.empty() && lines.back().find_first_not_of(' ') == std::string::npos) {
+		lines.pop_back();
+	}
+	if (lines.empty() || columns == 0) {
+		return false;
+	}
+
+	sokoban_world result{(unsigned int)lines.size(), columns};
+	unsigned int player = NO_PLAYER;
+	std::vector<bool> floor(result.cells(), false);
+
+	for (unsigned int y=0; y<result._rows; y++) {
+		for (unsigned int x=0; x<columns; x++) {
+			unsigned int i = y * columns + x;
+			char c = x < lines[y].size() ? lines[y][x] : ' ';
+			switch (c) {
+			case '#': result._walls[i] = true; break;
+			case ' ': case '-': case '_': floor[i] = true; break;
+			case '.': floor[i] = true; result._goals[i] = true; break;
+			case '$': floor[i] = true; result._blocks.push_back(i); break;
+			case '*': floor[i] = true; result._goals[i] = true; result._blocks.push_back(i); break;
+			case '+': result._goals[i] = true; //fallthrough
+			case '@': {
+				if (player != NO_PLAYER) {
+					return false;
+				}
+				floor[i] = true;
+				player = i;
+				break;
+			}
+			default: return false;
+			}
+		}
+	}
+	if (player == NO_PLAYER) {
+		return false;
+	}
+	result._player = player;
+
+	//every floor cell the robot can't reach (ignoring blocks) is outside the level
+	std::vector<bool> reached(result.cells(), false);
+	std::vector<unsigned int> frontier{player};
+	reached[player] = true;
+	while (!frontier.empty()) {
+		unsigned int current = frontier.back();
+		frontier.pop_back();
+		for (int d=0; d<GRID_DIRECTIONS; d++) {
+			unsigned int next;
+			if (result.neighbour(current, (grid_direction)d, next) && floor[next] && !reached[next]) {
+				reached[next] = true;
+				frontier.push_back(next);
+			}
+		}
+	}
+	for (unsigned int i=0; i<result.cells(); i++) {
+		if (!reached[i]) {
+			result._walls[i] = true;
+		}
+	}
+
+	*this = result;
+	return true;
+}
+
+bool sokoban_world::load_instance_file(const std::string& filename) {
+	std::ifstream file{filename.c_str()};
+	if (!file.is_open()) {
+		return false;
+	}
+
+	std::string line;
+	std::string level;
+	while (std::getline(file, line)) {
+		if (line.compare(0, 2, ";;") != 0) {
+			if (level.empty()) {
+				continue;
+			}
+			break;
+		}
+		//";; " is the prefix of every line of the drawing
+		std::string row = line.size() > 3 ? line.substr(3) : "";
+		if (row.find_first_of("#") == std::string::npos) {
+			//the level name or an empty comment
+			if (level.empty()) {
+				continue;
+			}
+			break;
+		}
+		level += row;
+		level += '\n';
+	}
+
+	return this->load_xsb(level);
+}
+
+std::string sokoban_world::to_xsb() const {
+	std::string result;
+	result.reserve(this->_rows * (this->_columns + 1));
+
+	for (unsigned int y=0; y<this->_rows; y++) {
+		for (unsigned int x=0; x<this->_columns; x++) {
+			unsigned int i = y * this->_columns + x;
+			char c = ' ';
+			if (this->_walls[i]) {
+				c = '#';
+			} else if (this->has_block(i)) {
+				c = this->_goals[i] ? '*' : '$';
+			} else if (i == this->_player) {
+				c = this->_goals[i] ? '+' : '@';
+			} else if (this->_goals[i]) {
+				c = '.';
+			}
+			result += c;
+		}
+		result += '\n';
+	}
+
+	return result;
+}
+
+unsigned int sokoban_world::rows() const {
+	return this->_rows;
+}
+
+unsigned int sokoban_world::columns() const {
+	return this->_columns;
+}
+
+unsigned int sokoban_world::cells() const {
+	return this->_rows * this->_columns;
+}
+
+unsigned int sokoban_world::index_of(const point& p) const {
+	return p.y * this->_columns + p.x;
+}
+
+point sokoban_world::point_of(unsigned int index) const {
+	return point{(int)(index / this->_columns), (int)(index % this->_columns)};
+}
+
+bool sokoban_world::neighbour(unsigned int index, grid_direction d, unsigned int& next) const {
+	unsigned int y = index / this->_columns;
+	unsigned int x = index % this->_columns;
+
+	switch (d) {
+	case GD_UP: {
+		if (y == 0) {
+			return false;
+		}
+		next = index - this->_columns;
+		return true;
+	}
+	case GD_DOWN: {
+		if (y + 1 >= this->_rows) {
+			return false;
+		}
+		next = index + this->_columns;
+		return true;
+	}
+	case GD_LEFT: {
+		if (x == 0) {
+			return false;
+		}
+		next = index - 1;
+		return true;
+	}
+	case GD_RIGHT: {
+		if (x + 1 >= this->_columns) {
+			return false;
+		}
+		next = index + 1;
+		return true;
+	}
+	}
+	return false;
+}
+
+bool sokoban_world::is_wall(unsigned int index) const {
+	return this->_walls[index];
+}
+
+bool sokoban_world::is_goal(unsigned int index) const {
+	return this->_goals[index];
+}
+
+bool sokoban_world::has_block(unsigned int index) const {
+	for (unsigned int i=0; i<this->_blocks.size(); i++) {
+		if (this->_blocks[i] == index) {
+			return true;
+		}
+	}
+	return false;
+}
+
+unsigned int sokoban_world::player() const {
+	return this->_player;
+}
+
+const std::vector<unsigned int>& sokoban_world::blocks() const {
+	return this->_blocks;
+}
+
+std::vector<unsigned int> sokoban_world::goals() const {
+	std::vector<unsigned int> result;
+	for (unsigned int i=0; i<this->cells(); i++) {
+		if (this->_goals[i]) {
+			result.push_back(i);
+		}
+	}
+	return result;
+}
+
+bool sokoban_world::is_solved() const {
+	for (unsigned int i=0; i<this->_blocks.size(); i++) {
+		if (!this->_goals[this->_blocks[i]]) {
+			return false;
+		}
+	}
+	return true;
+}
+
+void sokoban_world::set_wall(unsigned int index, bool wall) {
+	this->_walls[index] = wall;
+}
+
+void sokoban_world::set_goal(unsigned int index, bool goal) {
+	this->_goals[index] = goal;
+}
+
+void sokoban_world::add_block(unsigned int index) {
+	this->_blocks.push_back(index);
+}
+
+void sokoban_world::clear_blocks() {
+	this->_blocks.clear();
+}
+
+void sokoban_world::set_player(unsigned int index) {
+	this->_player = index;
+}
+
+grid_direction opposite_direction(grid_direction d) {
+	return (grid_direction)((d + 2) % GRID_DIRECTIONS);
+}
+
+/**
+ * Check if every occupied cell is a goal of the world
+ */
+static bool blocks_on_goals(const sokoban_world& world, const std::vector<bool>& occupied) {
+	for (unsigned int i=0; i<world.cells(); i++) {
+		if (occupied[i] && !world.is_goal(i)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+sokoban_world generate_sokoban_world(unsigned int rows, unsigned int columns, unsigned int blocks, unsigned int seed) {
+	sokoban_world result{rows, columns};
+	std::mt19937 generator{seed};
+	std::vector<unsigned int> free_cells;
+
+	for (unsigned int y=0; y<rows; y++) {
+		for (unsigned int x=0; x<columns; x++) {
+			unsigned int i = y * columns + x;
+			if (y == 0 || x == 0 || y + 1 == rows || x + 1 == columns) {
+				result.set_wall(i, true);
+			} else if ((generator() % 100) < GENERATED_PILLARS_PERCENTAGE) {
+				result.set_wall(i, true);
+			} else {
+				free_cells.push_back(i);
+			}
+		}
+	}
+	if (free_cells.size() <= blocks) {
+		return result;
+	}
+
+	std::vector<bool> occupied(result.cells(), false);
+	unsigned int player = 0;
+	//a walk ending with every block on a goal is thrown away and the world is set up again
+	for (unsigned int attempt=0; attempt<GENERATED_WALK_ATTEMPTS && blocks_on_goals(result, occupied); attempt++) {
+		//goals and blocks start on the same cells: the world is solved
+		std::shuffle(free_cells.begin(), free_cells.end(), generator);
+		std::fill(occupied.begin(), occupied.end(), false);
+		for (unsigned int i=0; i<result.cells(); i++) {
+			result.set_goal(i, false);
+		}
+		for (unsigned int i=0; i<blocks; i++) {
+			result.set_goal(free_cells[i], true);
+			occupied[free_cells[i]] = true;
+		}
+		//the robot starts next to a block, or the walk may never come back to pull it in a large room
+		player = free_cells[blocks];
+		for (unsigned int d=0; d<GRID_DIRECTIONS; d++) {
+			unsigned int next;
+			if (blocks > 0 && result.neighbour(free_cells[0], (grid_direction)d, next) && !result.is_wall(next) && !occupied[next]) {
+				player = next;
+				break;
+			}
+		}
+
+		//walk backwards: the robot either moves or pulls the block behind it
+		for (unsigned int step=0; step<(blocks * GENERATED_PULLS_PER_BLOCK); step++) {
+			grid_direction d = (grid_direction)(generator() % GRID_DIRECTIONS);
+			unsigned int next;
+			if (!result.neighbour(player, d, next) || result.is_wall(next) || occupied[next]) {
+				continue;
+			}
+			unsigned int behind;
+			bool pull = (generator() % 2) == 0;
+			if (pull && result.neighbour(player, opposite_direction(d), behind) && occupied[behind]) {
+				occupied[behind] = false;
+				occupied[player] = true;
+			}
+			player = next;
+		}
+	}
+
+	for (unsigned int i=0; i<result.cells(); i++) {
+		if (occupied[i]) {
+			result.add_block(i);
+		}
+	}
+	result.set_player(player);
+	return result;
+}
+
+}
+
+#endif /* DESKTOP_BUILD */
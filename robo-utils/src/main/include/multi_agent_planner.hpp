@@ -0,0 +1,117 @@
+/**
+ * @file
+ *
+ * Plans for several robots sharing the same sokoban grid.
+ *
+ * Available only when building with \c DESKTOP_BUILD.
+ *
+ * @date Oct 19, 2026
+ * @author agent
+ */
+
+#ifndef MULTI_AGENT_PLANNER_HPP_
+#define MULTI_AGENT_PLANNER_HPP_
+
+#ifdef DESKTOP_BUILD
+
+#include <vector>
+#include "sokoban_world.hpp"
+#include "sokoban_solver.hpp"
+
+namespace robo_utils {
+
+/**
+ * default value of multi_agent_planner::max_steps
+ */
+#define MULTI_AGENT_DEFAULT_MAX_STEPS 256
+
+/**
+ * An action a robot starts at a given time step. It is over at the beginning of the next time step
+ */
+struct timed_action {
+	/**
+	 * the time step when the action is performed
+	 */
+	unsigned int time;
+	/**
+	 * what the robot does
+	 */
+	sokoban_action action;
+};
+
+/**
+ * The actions of a single robot, ordered by time. In the time steps without an action the robot stays still
+ */
+typedef std::vector<timed_action> timed_plan;
+
+/**
+ * The plans of a team of robots: the i-th plan belongs to the i-th robot
+ */
+typedef std::vector<timed_plan> multi_agent_plan;
+
+/**
+ * @param[in] plan the plan of a team
+ * @return the number of time steps needed by the team to execute the plan
+ */
+unsigned int makespan(const multi_agent_plan& plan);
+
+/**
+ * Solve a sokoban problem with several robots, each pushing blocks on its own.
+ *
+ * The planner uses prioritized planning:
+ * \li every block is assigned to a goal (greedily, nearest pairs first);
+ * \li deliveries are planned one after the other, each by the robot which can complete it first;
+ * \li a delivery is planned with an A* over (robot cell, block cell, time) avoiding what is recorded in a reservation table.
+ * 	The table tells who (a robot or a block) occupies a cell at a given time; once a delivery is planned, the cells
+ * 	occupied by the robot and the block over time are added to it. Robots and blocks idle in their cell until they are needed again.
+ *
+ * Two robots are never in the same cell at the same time step and never swap cells in a time step.
+ * The planner is not complete: a problem may have a solution even if no plan is found.
+ *
+ * @code
+ * multi_agent_planner planner;
+ * multi_agent_plan plan;
+ * solver_statistics statistics;
+ * std::vector<unsigned int> robots{w.player(), w.index_of(point{1, 8})};
+ * if (planner.solve(w, robots, plan, statistics)) {
+ * 	makespan(plan);
+ * }
+ * @endcode
+ */
+class multi_agent_planner {
+private:
+	/**
+	 * the maximum number of time steps a single delivery can last
+	 */
+	unsigned int _max_steps;
+public:
+	/**
+	 * Setup the planner
+	 *
+	 * @param[in] max_steps the maximum number of time steps a single delivery can last
+	 */
+	multi_agent_planner(unsigned int max_steps = MULTI_AGENT_DEFAULT_MAX_STEPS);
+	/**
+	 * Dispose the planner
+	 */
+	~multi_agent_planner();
+public:
+	/**
+	 * Solve a problem
+	 *
+	 * The robot of the world (sokoban_world::player) is ignored: robots are the ones in \c robots.
+	 *
+	 * @param[in] world the problem to solve
+	 * @param[in] robots the cells where the robots start. They must be different free cells
+	 * @param[out] plan the actions of each robot. Untouched if no solution has been found
+	 * @param[out] statistics how much work has been done to solve the problem
+	 * @return \c true if a plan has been found, \c false otherwise
+	 */
+	bool solve(const sokoban_world& world, const std::vector<unsigned int>& robots, multi_agent_plan& plan, solver_statistics& statistics);
+};
+
+}
+
+#endif /* DESKTOP_BUILD */
+
+#endif /* MULTI_AGENT_PLANNER_HPP_ */
@@ -0,0 +1,166 @@
+/**
+ * @file
+ *
+ * A persistent cache of sokoban plans, stored in a memory mapped file.
+ *
+ * Available only when building with \c DESKTOP_BUILD.
+ *
+ * @date Oct 19, 2026
+ * @author agent
+ */
+
+#ifndef PLAN_CACHE_HPP_
+#define PLAN_CACHE_HPP_
+
+#ifdef DESKTOP_BUILD
+
+#include <string>
+#include "sokoban_world.hpp"
+#include "sokoban_solver.hpp"
+
+namespace robo_utils {
+
+/**
+ * number of slots of a cache file when it is created
+ */
+#define PLAN_CACHE_DEFAULT_SLOTS 4096
+
+/**
+ * Maps sokoban worlds to the plans solving them.
+ *
+ * Worlds are indexed by their canonical key (see ::canonical_key), hence a plan stored for a world is found also for every
+ * rotated or mirrored version of it: the plan returned is transformed accordingly.
+ *
+ * The cache lives in a file mapped in memory: a lookup doesn't perform any system call and what is stored survives
+ * the process. The file contains an open addressing table of fixed size followed by an area with keys and plans, which grows when needed.
+ * A file can't be shared by processes writing at the same time.
+ *
+ * @code
+ * plan_cache cache;
+ * cache.open("plans.cache");
+ * if (!cache.lookup(w, plan)) {
+ * 	solver->solve(w, plan, statistics);
+ * 	cache.store(w, plan);
+ * }
+ * @endcode
+ */
+class plan_cache {
+private:
+	/**
+	 * the descriptor of the cache file. -1 if there is no file open
+	 */
+	int _fd;
+	/**
+	 * where the file is mapped
+	 */
+	unsigned char* _memory;
+	/**
+	 * the number of bytes mapped
+	 */
+	unsigned long _size;
+public:
+	/**
+	 * Creates a cache with no file open. Every lookup fails
+	 */
+	plan_cache();
+	/**
+	 * Dispose the cache, closing the file
+	 */
+	~plan_cache();
+	plan_cache(const plan_cache& other) = delete;
+	plan_cache& operator=(const plan_cache& other) = delete;
+public:
+	/**
+	 * Open a cache file, creating it if it doesn't exist
+	 *
+	 * A file already open is closed first.
+	 *
+	 * @param[in] filename the cache file
+	 * @param[in] slots the number of plans the cache can contain. Used only if the file is created
+	 * @return \c false if the file can't be created, it's not a cache file or it's truncated or corrupted, \c true otherwise
+	 */
+	bool open(const std::string& filename, unsigned int slots = PLAN_CACHE_DEFAULT_SLOTS);
+	/**
+	 * Close the cache file. Everything stored is already in the file
+	 */
+	void close();
+	/**
+	 * @return \c true if a cache file is open
+	 */
+	bool is_open() const;
+	/**
+	 * @return the number of plans stored in the cache
+	 */
+	unsigned int size() const;
+	/**
+	 * Look for the plan of a world
+	 *
+	 * @param[in] world the world to solve
+	 * @param[out] plan the plan solving \c world. Untouched if the world is not in the cache
+	 * @return \c true if the world (or a symmetric version of it) is in the cache
+	 */
+	bool lookup(const sokoban_world& world, sokoban_plan& plan) const;
+	/**
+	 * Add the plan of a world to the cache
+	 *
+	 * @param[in] world the world solved
+	 * @param[in] plan the plan solving \c world
+	 * @return
+	 * 	\li \c true if the plan has been stored or the world was already in the cache;
+	 * 	\li \c false if there is no file open, the table is full or the file can't grow
+	 */
+	bool store(const sokoban_world& world, const sokoban_plan& plan);
+private:
+	/**
+	 * Find the slot of a key
+	 *
+	 * @param[in] key the canonical key of a world
+	 * @param[out] slot the slot containing \c key or, if \c key is not in the cache, the empty slot where it should go
+	 * @return \c true if \c key is in the cache
+	 */
+	bool find(const std::string& key, unsigned int& slot) const;
+	/**
+	 * Enlarge the file so that the data area has at least the given number of free bytes
+	 */
+	bool reserve(unsigned long bytes);
+};
+
+/**
+ * A solver looking in a plan_cache before running another solver
+ *
+ * Plans found by the other solver are added to the cache. When the plan comes from the cache the statistics are all 0.
+ */
+class cached_solver : public sokoban_solver {
+private:
+	/**
+	 * the solver used when the world is not in the cache. Owned by this object
+	 */
+	sokoban_solver* _solver;
+	/**
+	 * the cache used. Not owned by this object
+	 */
+	plan_cache* _cache;
+public:
+	/**
+	 * Setup the solver
+	 *
+	 * @param[in] solver the solver to use on cache misses. It will be deleted together with this object
+	 * @param[in] cache the cache to use. It must outlive this object
+	 */
+	cached_solver(sokoban_solver* solver, plan_cache* cache);
+	/**
+	 * Dispose the solver and the wrapped one
+	 */
+	~cached_solver();
+	cached_solver(const cached_solver& other) = delete;
+	cached_solver& operator=(const cached_solver& other) = delete;
+public:
+	const char* name() const;
+	bool solve(const sokoban_world& world, sokoban_plan& plan, solver_statistics& statistics);
+};
+
+}
+
+#endif /* DESKTOP_BUILD */
+
+#endif /* PLAN_CACHE_HPP_ */
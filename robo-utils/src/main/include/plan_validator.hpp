@@ -0,0 +1,185 @@
+/**
+ * @file
+ *
+ * Fast check of sokoban plans against a world, with a prediction of the time the robot needs to execute them.
+ *
+ * Available only when building with \c DESKTOP_BUILD.
+ *
+ * @date Oct 19, 2026
+ * @author agent
+ */
+
+#ifndef PLAN_VALIDATOR_HPP_
+#define PLAN_VALIDATOR_HPP_
+
+#ifdef DESKTOP_BUILD
+
+#include <cstdint>
+#include <vector>
+#include "sokoban_world.hpp"
+
+namespace robo_utils {
+
+/**
+ * How long the robot takes to perform each part of a plan.
+ *
+ * The robot executes an action by facing its direction (turning if needed) and then following the line for one cell,
+ * pushing the block in front of it if the action is a push. Every action is a message exchanged with the host.
+ * Defaults are rough values for a Zumo32U4 at the default speed: tune them on the real arena
+ */
+struct execution_time_model {
+	/**
+	 * time needed to go to the adjacent cell
+	 */
+	unsigned int move_ms;
+	/**
+	 * time needed to push a block into the next cell, going into the cell where the block was
+	 */
+	unsigned int push_ms;
+	/**
+	 * time needed to turn left or right
+	 */
+	unsigned int turn_90_ms;
+	/**
+	 * time needed to turn back
+	 */
+	unsigned int turn_180_ms;
+	/**
+	 * time needed to send an action to the robot and receive its acknowledgement
+	 */
+	unsigned int message_ms;
+	/**
+	 * where the robot is facing at the beginning of the plan
+	 */
+	grid_direction start_orientation;
+};
+
+/**
+ * @return the default execution_time_model
+ */
+execution_time_model default_execution_time_model();
+
+/**
+ * The outcome of plan_validator::validate
+ */
+struct plan_validation {
+	/**
+	 * \c true if the preconditions of every action hold when the action is executed
+	 */
+	bool valid;
+	/**
+	 * index of the first action whose preconditions don't hold. The size of the plan if the plan is valid
+	 */
+	unsigned int failed_action;
+	/**
+	 * \c true if the plan is valid and every block is on a goal at the end
+	 */
+	bool solved;
+	/**
+	 * number of ::SAT_MOVE actions executed
+	 */
+	unsigned int moves;
+	/**
+	 * number of ::SAT_PUSH actions executed
+	 */
+	unsigned int pushes;
+	/**
+	 * number of times the robot changes its orientation
+	 */
+	unsigned int turns;
+	/**
+	 * time the robot needs to execute the actions (up to the failed one)
+	 */
+	unsigned long predicted_time_ms;
+};
+
+/**
+ * Replays plans on a world, checking the preconditions of \c domainPush.pddl:
+ * \li \c move: the destination cell is neither a wall nor contains a block;
+ * \li \c push-to-goal and \c push-to-nongoal (both ::SAT_PUSH): the adjacent cell contains a block and the cell after it is neither a wall nor contains a block;
+ *
+ * The world is copied at construction into bitboards surrounded by a frame of walls, so replaying an action is
+ * a couple of bit tests without bound checks. Validating many plans on the same world (e.g. while fuzzing a solver)
+ * costs only the copy of the block bitboard per plan.
+ *
+ * @code
+ * plan_validator validator{w};
+ * plan_validation result = validator.validate(plan);
+ * if (!result.solved) {
+ * 	//plan[result.failed_action] can't be executed
+ * }
+ * @endcode
+ */
+class plan_validator {
+private:
+	/**
+	 * columns of the framed grid
+	 */
+	unsigned int _stride;
+	/**
+	 * how the index of a framed cell changes going towards each direction
+	 */
+	int _delta[GRID_DIRECTIONS];
+	/**
+	 * the i-th bit is set if the i-th framed cell is a wall
+	 */
+	std::vector<uint64_t> _walls;
+	/**
+	 * the i-th bit is set if the i-th framed cell is a goal
+	 */
+	std::vector<uint64_t> _goals;
+	/**
+	 * the i-th bit is set if the i-th framed cell contains a block at the beginning of the plan
+	 */
+	std::vector<uint64_t> _blocks;
+	/**
+	 * number of blocks which are not on a goal at the beginning of the plan
+	 */
+	unsigned int _misplaced;
+	/**
+	 * the framed cell where the robot starts
+	 */
+	unsigned int _player;
+	/**
+	 * the times used to predict the execution time
+	 */
+	execution_time_model _time_model;
+	/**
+	 * working copy of ::_blocks
+	 */
+	std::vector<uint64_t> _current;
+public:
+	/**
+	 * Prepare the validation of plans on a world
+	 *
+	 * @param[in] world the world where the plans are executed
+	 * @param[in] time_model the times used to predict the execution time
+	 */
+	plan_validator(const sokoban_world& world, const execution_time_model& time_model = default_execution_time_model());
+	/**
+	 * Dispose the validator
+	 */
+	~plan_validator();
+public:
+	/**
+	 * Replay a plan from the initial state of the world
+	 *
+	 * @param[in] plan the plan to check
+	 * @return what happened during the replay. The replay stops at the first action which can't be executed
+	 */
+	plan_validation validate(const sokoban_plan& plan);
+	/**
+	 * Replay a sequence of actions from the initial state of the world
+	 *
+	 * @param[in] actions the first action
+	 * @param[in] size the number of actions
+	 * @return what happened during the replay. The replay stops at the first action which can't be executed
+	 */
+	plan_validation validate(const sokoban_action* actions, unsigned int size);
+};
+
+}
+
+#endif /* DESKTOP_BUILD */
+
+#endif /* PLAN_VALIDATOR_HPP_ */
@@ -0,0 +1,69 @@
+/**
+ * @file
+ *
+ * A sokoban solver searching in the space of the pushes
+ *
+ * Available only when building with \c DESKTOP_BUILD.
+ *
+ * @date Oct 19, 2026
+ * @author agent
+ */
+
+#ifndef PUSH_SEARCH_SOLVER_HPP_
+#define PUSH_SEARCH_SOLVER_HPP_
+
+#ifdef DESKTOP_BUILD
+
+#include "sokoban_solver.hpp"
+
+namespace robo_utils {
+
+/**
+ * the order in which push_search_solver visits the states
+ */
+enum push_search_strategy {
+	/**
+	 * breadth first: the plan found has the minimum number of pushes
+	 */
+	PSS_BREADTH_FIRST,
+	/**
+	 * greedy best first: states whose blocks are nearer to the goals come first. Faster, but plans are longer
+	 */
+	PSS_GREEDY
+};
+
+/**
+ * Solve a problem by searching on states made by the block positions and the area the robot can reach.
+ *
+ * Moves of the robot which don't push anything are not states on their own: they are computed when the plan is rebuilt.
+ * Blocks are never pushed into cells from where they can't reach a goal anymore.
+ *
+ * Registered in solver_registry as \c push-bfs and \c push-greedy.
+ */
+class push_search_solver : public sokoban_solver {
+private:
+	/**
+	 * how the states are visited
+	 */
+	push_search_strategy _strategy;
+public:
+	/**
+	 * Setup the solver
+	 *
+	 * @param[in] strategy the order in which the states are visited
+	 */
+	push_search_solver(push_search_strategy strategy);
+	/**
+	 * Dispose the solver
+	 */
+	~push_search_solver();
+public:
+	const char* name() const;
+	bool solve(const sokoban_world& world, sokoban_plan& plan, solver_statistics& statistics);
+};
+
+}
+
+#endif /* DESKTOP_BUILD */
+
+#endif /* PUSH_SEARCH_SOLVER_HPP_ */
@@ -0,0 +1,123 @@
+/**
+ * @file
+ *
+ * API every host-side sokoban solver implements, plus a registry to look them up by name.
+ *
+ * Available only when building with \c DESKTOP_BUILD.
+ *
+ * @date Oct 19, 2026
+ * @author agent
+ */
+
+#ifndef SOKOBAN_SOLVER_HPP_
+#define SOKOBAN_SOLVER_HPP_
+
+#ifdef DESKTOP_BUILD
+
+#include <string>
+#include <utility>
+#include <vector>
+#include "sokoban_world.hpp"
+
+namespace robo_utils {
+
+/**
+ * Numbers a solver reports about its last run
+ */
+struct solver_statistics {
+	/**
+	 * number of states whose successors have been generated
+	 */
+	unsigned long nodes_expanded;
+	/**
+	 * number of states created (duplicates excluded)
+	 */
+	unsigned long nodes_generated;
+	/**
+	 * the greatest amount of bytes the search data structures have reached
+	 */
+	unsigned long peak_memory_bytes;
+};
+
+/**
+ * Represents an algorithm able to solve a ::sokoban_world
+ */
+class sokoban_solver {
+public:
+	sokoban_solver() {}
+	virtual ~sokoban_solver() {}
+public:
+	/**
+	 * @return an unique name identifying the solver
+	 */
+	virtual const char* name() const = 0;
+	/**
+	 * Solve a problem
+	 *
+	 * @param[in] world the problem to solve
+	 * @param[out] plan the actions to perform. Untouched if no solution has been found
+	 * @param[out] statistics how much work has been done to solve the problem
+	 * @return \c true if a plan has been found, \c false otherwise
+	 */
+	virtual bool solve(const sokoban_world& world, sokoban_plan& plan, solver_statistics& statistics) = 0;
+};
+
+/**
+ * A function creating a new solver. The caller has to \c delete the solver after its use
+ */
+typedef sokoban_solver* (*sokoban_solver_factory)();
+
+/**
+ * Keeps track of every solver available on the host.
+ *
+ * This class is a Singleton: use solver_registry::get_instance() to access it. The solvers shipped with robo-utils
+ * are registered automatically; new solvers can be added via solver_registry::add.
+ *
+ * @code
+ * sokoban_solver* s = solver_registry::get_instance()->create("push-bfs");
+ * s->solve(world, plan, statistics);
+ * delete s;
+ * @endcode
+ */
+class solver_registry {
+private:
+	/**
+	 * every solver registered, with its name
+	 */
+	std::vector<std::pair<std::string, sokoban_solver_factory> > _factories;
+	/**
+	 * Initialize the registry with the built-in solvers
+	 */
+	solver_registry();
+public:
+	/**
+	 * Register a new solver
+	 *
+	 * @param[in] name the name of the solver
+	 * @param[in] factory the function creating the solver
+	 * @return \c false if a solver with the same name was already registered, \c true otherwise
+	 */
+	bool add(const std::string& name, sokoban_solver_factory factory);
+	/**
+	 * @return the names of all the solvers registered, in registration order
+	 */
+	std::vector<std::string> names() const;
+	/**
+	 * Create a new solver
+	 *
+	 * @param[in] name the name of the solver to create
+	 * @return the new solver (to \c delete after use) or \c nullptr if no solver is called \c name
+	 */
+	sokoban_solver* create(const std::string& name) const;
+public:
+	/**
+	 * @return the single instance of the registry
+	 */
+	static solver_registry* get_instance();
+};
+
+}
+
+#endif /* DESKTOP_BUILD */
+
+#endif /* SOKOBAN_SOLVER_HPP_ */
@@ -0,0 +1,125 @@
+/**
+ * @file
+ *
+ * The 8 symmetries of a rectangular grid (rotations and reflections) applied to sokoban worlds and plans.
+ *
+ * Available only when building with \c DESKTOP_BUILD.
+ *
+ * @date Oct 19, 2026
+ * @author agent
+ */
+
+#ifndef SOKOBAN_SYMMETRY_HPP_
+#define SOKOBAN_SYMMETRY_HPP_
+
+#ifdef DESKTOP_BUILD
+
+#include <string>
+#include "sokoban_world.hpp"
+
+namespace robo_utils {
+
+/**
+ * A transformation mapping a grid onto itself (the dihedral group of the square).
+ *
+ * Rotations are clockwise. Symmetries marked as \a swapping exchange the number of rows with the number of columns
+ */
+enum grid_symmetry {
+	/**
+	 * the grid is left as is
+	 */
+	GS_IDENTITY = 0,
+	/**
+	 * rotation of 90 degrees. Swapping
+	 */
+	GS_ROTATE_90 = 1,
+	/**
+	 * rotation of 180 degrees
+	 */
+	GS_ROTATE_180 = 2,
+	/**
+	 * rotation of 270 degrees. Swapping
+	 */
+	GS_ROTATE_270 = 3,
+	/**
+	 * reflection along the vertical axis (left becomes right)
+	 */
+	GS_FLIP_COLUMNS = 4,
+	/**
+	 * reflection along the horizontal axis (up becomes down)
+	 */
+	GS_FLIP_ROWS = 5,
+	/**
+	 * reflection along the main diagonal. Swapping
+	 */
+	GS_TRANSPOSE = 6,
+	/**
+	 * reflection along the anti diagonal. Swapping
+	 */
+	GS_ANTI_TRANSPOSE = 7
+};
+
+/**
+ * Number of values in ::grid_symmetry
+ */
+#define GRID_SYMMETRIES 8
+
+/**
+ * @param[in] s a symmetry
+ * @return the symmetry undoing \c s
+ */
+grid_symmetry inverse_symmetry(grid_symmetry s);
+
+/**
+ * @param[in] d a direction in the original grid
+ * @param[in] s the symmetry applied to the grid
+ * @return the direction \c d becomes in the transformed grid
+ */
+grid_direction transform_direction(grid_direction d, grid_symmetry s);
+
+/**
+ * @param[in] world the world to transform
+ * @param[in] s the symmetry to apply
+ * @return a new world where every cell (walls, goals, blocks and the robot) has been moved according to \c s
+ */
+sokoban_world transform_world(const sokoban_world& world, grid_symmetry s);
+
+/**
+ * Transform a plan of a world into the plan of the transformed world
+ *
+ * @param[in] plan the plan to transform
+ * @param[in] s the symmetry applied to the world
+ * @return a plan with the same actions of \c plan with their directions transformed according to \c s
+ */
+sokoban_plan transform_plan(const sokoban_plan& plan, grid_symmetry s);
+
+/**
+ * Compute a representation of the world which is the same for all its 8 symmetric versions
+ *
+ * The representation is the byte encoding of the cells (walls, goals, blocks and the robot) of the symmetric version
+ * whose encoding is the lexicographically smallest one.
+ *
+ * @code
+ * grid_symmetry s;
+ * std::string key = canonical_key(w, s);
+ * //transform_world(w, s) is the world represented by key
+ * canonical_key(transform_world(w, GS_ROTATE_90), s) == key; //true
+ * @endcode
+ *
+ * @param[in] world the world to represent
+ * @param[out] applied the symmetry to apply to \c world to obtain the canonical version
+ * @return the canonical representation of \c world
+ */
+std::string canonical_key(const sokoban_world& world, grid_symmetry& applied);
+
+/**
+ * @param[in] key a byte string
+ * @return the 64 bit FNV-1a hash of \c key
+ */
+unsigned long long hash_key(const std::string& key);
+
+}
+
+#endif /* DESKTOP_BUILD */
+
+#endif /* SOKOBAN_SYMMETRY_HPP_ */
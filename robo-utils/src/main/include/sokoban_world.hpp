@@ -0,0 +1,299 @@
+/**
+ * @file
+ *
+ * Provides an in-memory representation of a sokoban problem: walls, blocks, goals and the robot starting cell.
+ *
+ * The module relies on the standard library, hence it is available only when building with \c DESKTOP_BUILD.
+ * It is intended for the host-side tools (solvers, benchmarks) and it is never compiled on the robot.
+ *
+ * @date Oct 19, 2026
+ * @author agent
+ */
+
+#ifndef SOKOBAN_WORLD_HPP_
+#define SOKOBAN_WORLD_HPP_
+
+#ifdef DESKTOP_BUILD
+
+#include <string>
+#include <vector>
+#include "point.hpp"
+
+namespace robo_utils {
+
+/**
+ * A direction within the grid.
+ *
+ * Values are the same of robotieee::object_movement used on the robot, so they can be exchanged freely
+ */
+enum grid_direction {
+	/**
+	 * towards row 0
+	 */
+	GD_UP = 0,
+	/**
+	 * towards maximum column
+	 */
+	GD_RIGHT = 1,
+	/**
+	 * towards maximum row
+	 */
+	GD_DOWN = 2,
+	/**
+	 * towards column 0
+	 */
+	GD_LEFT = 3
+};
+
+/**
+ * Number of values in ::grid_direction
+ */
+#define GRID_DIRECTIONS 4
+
+/**
+ * the kind of action a plan may contain
+ */
+enum sokoban_action_type {
+	/**
+	 * the robot moves into an adjacent free cell
+	 */
+	SAT_MOVE = 0,
+	/**
+	 * the robot pushes the block in the adjacent cell one cell further
+	 */
+	SAT_PUSH = 1
+};
+
+/**
+ * A single step of a plan.
+ *
+ * It has the semantic of \c domainPush.pddl: \c push-to-goal and \c push-to-nongoal are both ::SAT_PUSH
+ */
+struct sokoban_action {
+	/**
+	 * what the robot does
+	 */
+	sokoban_action_type type;
+	/**
+	 * where the robot goes
+	 */
+	grid_direction direction;
+};
+
+/**
+ * A sequence of actions solving a sokoban problem
+ */
+typedef std::vector<sokoban_action> sokoban_plan;
+
+/**
+ * Represents a sokoban problem.
+ *
+ * Coordinates follow the same convention of the robot: (0,0) is the top left corner and \c y grows downwards.
+ * Cells are identified either by a ::point or by their index <tt>y * columns + x</tt>.
+ *
+ * @code
+ * sokoban_world w{1, 1};
+ * w.load_xsb("#####\n#@$.#\n#####\n");
+ * w.rows(); //3
+ * w.blocks().size(); //1
+ * @endcode
+ */
+class sokoban_world {
+private:
+	/**
+	 * number of rows of the grid
+	 */
+	unsigned int _rows;
+	/**
+	 * number of columns of the grid
+	 */
+	unsigned int _columns;
+	/**
+	 * \c true if the cell at the given index can't be traversed
+	 */
+	std::vector<bool> _walls;
+	/**
+	 * \c true if the cell at the given index is a goal
+	 */
+	std::vector<bool> _goals;
+	/**
+	 * indexes of the cells containing a block
+	 */
+	std::vector<unsigned int> _blocks;
+	/**
+	 * index of the cell where the robot starts
+	 */
+	unsigned int _player;
+public:
+	/**
+	 * Creates a world with no walls, no blocks and no goals. The robot is in (0,0)
+	 *
+	 * @param[in] rows the number of rows of the grid
+	 * @param[in] columns the number of columns of the grid
+	 */
+	sokoban_world(unsigned int rows, unsigned int columns);
+	/**
+	 * Dispose the world
+	 */
+	~sokoban_world();
+public:
+	/**
+	 * Replace the whole world with the one described in the XSB textual format
+	 *
+	 * The format is the one of the comments at the beginning of the instances in \c Server/planner_wrapper/Problems/Sokoban:
+	 * \li \c # a wall;
+	 * \li \c $ a block;
+	 * \li \c . a goal;
+	 * \li \c * a block on a goal;
+	 * \li \c @ the robot;
+	 * \li \c + the robot on a goal;
+	 * \li space (or \c - or \c _) a free cell;
+	 *
+	 * Free cells which can't be reached from the robot (e.g. the ones outside the outer wall) are considered walls.
+	 *
+	 * @param[in] text the level. Lines are separated by '\\n'
+	 * @return
+	 * 	\li \c true if the level has been loaded;
+	 * 	\li \c false if the level is malformed (no robot, more than one robot, unknown characters). In this case the world is left untouched
+	 */
+	bool load_xsb(const std::string& text);
+	/**
+	 * Replace the whole world with the one in a PDDL problem file
+	 *
+	 * The level is fetched by the commented drawing (lines starting with <tt>;;</tt>) at the beginning of the file.
+	 *
+	 * @param[in] filename the PDDL problem file to read
+	 * @return \c true if the level has been loaded, \c false otherwise
+	 */
+	bool load_instance_file(const std::string& filename);
+	/**
+	 * Encode the world in the XSB textual format
+	 *
+	 * @return the string representing the world. Each row ends with '\\n'
+	 */
+	std::string to_xsb() const;
+public:
+	/**
+	 * @return the number of rows of the grid
+	 */
+	unsigned int rows() const;
+	/**
+	 * @return the number of columns of the grid
+	 */
+	unsigned int columns() const;
+	/**
+	 * @return the number of cells of the grid
+	 */
+	unsigned int cells() const;
+	/**
+	 * @param[in] p a point
+	 * @return the index of the cell represented by \c p
+	 */
+	unsigned int index_of(const point& p) const;
+	/**
+	 * @param[in] index the index of a cell
+	 * @return the point represented by \c index
+	 */
+	point point_of(unsigned int index) const;
+	/**
+	 * Compute the cell next to another one
+	 *
+	 * @param[in] index the starting cell
+	 * @param[in] d the direction to go to
+	 * @param[out] next the index of the adjacent cell
+	 * @return \c false if going in direction \c d would leave the grid, \c true otherwise
+	 */
+	bool neighbour(unsigned int index, grid_direction d, unsigned int& next) const;
+	/**
+	 * @param[in] index the cell to check
+	 * @return \c true if the cell can't be traversed
+	 */
+	bool is_wall(unsigned int index) const;
+	/**
+	 * @param[in] index the cell to check
+	 * @return \c true if the cell is a goal
+	 */
+	bool is_goal(unsigned int index) const;
+	/**
+	 * @param[in] index the cell to check
+	 * @return \c true if the cell contains a block
+	 */
+	bool has_block(unsigned int index) const;
+	/**
+	 * @return the index of the cell where the robot starts
+	 */
+	unsigned int player() const;
+	/**
+	 * @return the indexes of the cells containing a block
+	 */
+	const std::vector<unsigned int>& blocks() const;
+	/**
+	 * @return the indexes of the cells which are goals
+	 */
+	std::vector<unsigned int> goals() const;
+	/**
+	 * @return \c true if every block is on a goal
+	 */
+	bool is_solved() const;
+public:
+	/**
+	 * Mark or unmark a cell as a wall
+	 *
+	 * @param[in] index the cell involved
+	 * @param[in] wall \c true if the cell can't be traversed
+	 */
+	void set_wall(unsigned int index, bool wall);
+	/**
+	 * Mark or unmark a cell as a goal
+	 *
+	 * @param[in] index the cell involved
+	 * @param[in] goal \c true if the cell is a goal
+	 */
+	void set_goal(unsigned int index, bool goal);
+	/**
+	 * Put a new block in the grid
+	 *
+	 * @param[in] index the cell where the block is
+	 */
+	void add_block(unsigned int index);
+	/**
+	 * Remove every block from the grid
+	 */
+	void clear_blocks();
+	/**
+	 * Move the robot
+	 *
+	 * @param[in] index the cell where the robot is
+	 */
+	void set_player(unsigned int index);
+};
+
+/**
+ * Generate a solvable problem by playing the game backwards
+ *
+ * Goals are randomly scattered in an open room surrounded by walls (with some random pillars inside),
+ * blocks are put on the goals and then the robot \a pulls them around for a while. The final state is the problem returned.
+ * A walk which leaves every block on a goal is thrown away and tried again, so the problem is not solved from the start
+ * (unless there are no blocks).
+ *
+ * @param[in] rows the number of rows of the world (walls included)
+ * @param[in] columns the number of columns of the world (walls included)
+ * @param[in] blocks the number of blocks (and goals) in the world
+ * @param[in] seed the seed of the pseudo random generator. The same seed generates the same world
+ * @return the generated world
+ */
+sokoban_world generate_sokoban_world(unsigned int rows, unsigned int columns, unsigned int blocks, unsigned int seed);
+
+/**
+ * The direction opposite to the given one
+ *
+ * @param[in] d a direction
+ * @return the opposite direction of \c d
+ */
+grid_direction opposite_direction(grid_direction d);
+
+}
+
+#endif /* DESKTOP_BUILD */
+
+#endif /* SOKOBAN_WORLD_HPP_ */
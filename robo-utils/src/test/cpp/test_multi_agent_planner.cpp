@@ -0,0 +1,203 @@
+/*
+ * test_multi_agent_planner.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifdef DESKTOP_BUILD
+
+#include <algorithm>
+#include "catch.hpp"
+#include "multi_agent_planner.hpp"
+
+using namespace robo_utils;
+
+/**
+ * Execute the plans of a team step by step, checking no robot collides and every push is legal
+ *
+ * @return \c true if the plan is valid and every block ends on a goal
+ */
+static bool execute(const sokoban_world& w, std::vector<unsigned int> robots, const multi_agent_plan& plan) {
+	std::vector<unsigned int> blocks = w.blocks();
+	std::vector<unsigned int> next_action(plan.size(), 0);
+
+	for (unsigned int t=0; t<makespan(plan); t++) {
+		std::vector<unsigned int> new_robots{robots};
+		std::vector<unsigned int> new_blocks{blocks};
+
+		for (unsigned int r=0; r<plan.size(); r++) {
+			if (next_action[r] >= plan[r].size() || plan[r][next_action[r]].time != t) {
+				continue;
+			}
+			sokoban_action a = plan[r][next_action[r]++].action;
+			unsigned int next;
+			if (!w.neighbour(robots[r], a.direction, next) || w.is_wall(next)) {
+				return false;
+			}
+			std::vector<unsigned int>::iterator b = std::find(blocks.begin(), blocks.end(), next);
+			if ((a.type == SAT_PUSH) != (b != blocks.end())) {
+				return false;
+			}
+			if (a.type == SAT_PUSH) {
+				unsigned int to;
+				if (!w.neighbour(next, a.direction, to) || w.is_wall(to)) {
+					return false;
+				}
+				new_blocks[b - blocks.begin()] = to;
+			}
+			new_robots[r] = next;
+		}
+
+		for (unsigned int i=0; i<new_robots.size(); i++) {
+			if (std::count(new_robots.begin(), new_robots.end(), new_robots[i]) > 1 || std::count(new_blocks.begin(), new_blocks.end(), new_robots[i]) > 0) {
+				return false;
+			}
+			for (unsigned int j=0; j<new_robots.size(); j++) {
+				if (i != j && new_robots[i] == robots[j] && new_robots[j] == robots[i]) {
+					return false;
+				}
+			}
+		}
+		for (unsigned int i=0; i<new_blocks.size(); i++) {
+			if (std::count(new_blocks.begin(), new_blocks.end(), new_blocks[i]) > 1) {
+				return false;
+			}
+		}
+		robots = new_robots;
+		blocks = new_blocks;
+	}
+
+	for (unsigned int i=0; i<blocks.size(); i++) {
+		if (!w.is_goal(blocks[i])) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * Follow the robots of a team along their plans, ignoring the blocks
+ *
+ * @return the cells of the robots at every time step, from the start to the end of the plan
+ */
+static std::vector<std::vector<unsigned int>> trajectories(const sokoban_world& w, std::vector<unsigned int> robots, const multi_agent_plan& plan) {
+	std::vector<std::vector<unsigned int>> result{robots};
+
+	for (unsigned int r=0; r<plan.size(); r++) {
+		for (unsigned int i=0; i<plan[r].size(); i++) {
+			REQUIRE(plan[r][i].time < makespan(plan));
+		}
+	}
+	for (unsigned int t=0; t<makespan(plan); t++) {
+		for (unsigned int r=0; r<plan.size(); r++) {
+			for (unsigned int i=0; i<plan[r].size(); i++) {
+				if (plan[r][i].time == t) {
+					REQUIRE(w.neighbour(robots[r], plan[r][i].action.direction, robots[r]));
+				}
+			}
+		}
+		result.push_back(robots);
+	}
+	return result;
+}
+
+SCENARIO("test multi agent planner") {
+
+	GIVEN("a warehouse with blocks far from each other") {
+		sokoban_world w{1, 1};
+		REQUIRE(w.load_xsb(
+				"############\n"
+				"#@         #\n"
+				"# $      $ #\n"
+				"#  .    .  #\n"
+				"#          #\n"
+				"#  .    .  #\n"
+				"# $      $ #\n"
+				"#          #\n"
+				"############\n"));
+		multi_agent_planner planner;
+		solver_statistics statistics;
+
+		WHEN("there is a single robot") {
+			std::vector<unsigned int> robots{w.player()};
+			multi_agent_plan plan;
+
+			REQUIRE(planner.solve(w, robots, plan, statistics));
+
+			THEN("the plan is valid") {
+				REQUIRE(plan.size() == 1);
+				REQUIRE(execute(w, robots, plan));
+				REQUIRE(statistics.nodes_expanded > 0);
+			}
+		}
+
+		WHEN("more robots are added") {
+			std::vector<unsigned int> one{w.player()};
+			std::vector<unsigned int> two{w.player(), w.index_of(point{7, 10})};
+			std::vector<unsigned int> three{w.player(), w.index_of(point{7, 10}), w.index_of(point{1, 10})};
+			multi_agent_plan plan1;
+			multi_agent_plan plan2;
+			multi_agent_plan plan3;
+
+			REQUIRE(planner.solve(w, one, plan1, statistics));
+			REQUIRE(planner.solve(w, two, plan2, statistics));
+			REQUIRE(planner.solve(w, three, plan3, statistics));
+
+			THEN("plans are valid and the makespan shrinks") {
+				REQUIRE(execute(w, two, plan2));
+				REQUIRE(execute(w, three, plan3));
+				REQUIRE(makespan(plan2) < makespan(plan1));
+				REQUIRE(makespan(plan3) <= makespan(plan2));
+			}
+		}
+
+		WHEN("the robots are not valid") {
+			multi_agent_plan plan;
+
+			THEN("no plan is found") {
+				REQUIRE_FALSE(planner.solve(w, std::vector<unsigned int>{}, plan, statistics));
+				REQUIRE_FALSE(planner.solve(w, std::vector<unsigned int>{w.player(), w.player()}, plan, statistics));
+				REQUIRE_FALSE(planner.solve(w, std::vector<unsigned int>{w.blocks()[0]}, plan, statistics));
+				REQUIRE(plan.empty());
+			}
+		}
+	}
+
+	GIVEN("a corridor where two robots have to cross") {
+		sokoban_world w{1, 1};
+		REQUIRE(w.load_xsb(
+				"###########\n"
+				"#   ### $.#\n"
+				"#@.     $ #\n"
+				"# ######  #\n"
+				"###########\n"));
+		multi_agent_planner planner;
+		solver_statistics statistics;
+		std::vector<unsigned int> robots{w.player(), w.index_of(point{3, 8})};
+		multi_agent_plan plan;
+
+		REQUIRE(planner.solve(w, robots, plan, statistics));
+		std::vector<std::vector<unsigned int>> cells = trajectories(w, robots, plan);
+
+		THEN("the plan is valid") {
+			REQUIRE(execute(w, robots, plan));
+		}
+
+		THEN("each robot ends on the side the other one started from") {
+			REQUIRE(w.point_of(cells.back()[0]).x > 6);
+			REQUIRE(w.point_of(cells.back()[1]).x < 4);
+		}
+
+		THEN("the robots are never on the same cell and never swap their cells") {
+			for (unsigned int t=0; t<cells.size(); t++) {
+				REQUIRE(cells[t][0] != cells[t][1]);
+				if (t > 0) {
+					REQUIRE_FALSE((cells[t][0] == cells[t-1][1] && cells[t][1] == cells[t-1][0]));
+				}
+			}
+		}
+	}
+}
+
+#endif /* DESKTOP_BUILD */
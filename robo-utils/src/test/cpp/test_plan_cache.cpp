@@ -0,0 +1,193 @@
+/*
+ * test_plan_cache.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifdef DESKTOP_BUILD
+
+#include <cstdio>
+#include <unistd.h>
+#include "catch.hpp"
+#include "plan_cache.hpp"
+#include "sokoban_symmetry.hpp"
+
+using namespace robo_utils;
+
+static bool same_plan(const sokoban_plan& a, const sokoban_plan& b) {
+	if (a.size() != b.size()) {
+		return false;
+	}
+	for (unsigned int i=0; i<a.size(); i++) {
+		if (a[i].type != b[i].type || a[i].direction != b[i].direction) {
+			return false;
+		}
+	}
+	return true;
+}
+
+SCENARIO("test grid symmetries") {
+
+	GIVEN("a world which is not symmetric") {
+		sokoban_world w{1, 1};
+		REQUIRE(w.load_xsb(
+				"#######\n"
+				"#.  $ #\n"
+				"#  #  #\n"
+				"#   @ #\n"
+				"#######\n"));
+
+		THEN("a rotation moves every cell") {
+			REQUIRE(transform_world(w, GS_ROTATE_90).to_xsb() ==
+					"#####\n"
+					"#  .#\n"
+					"#   #\n"
+					"# # #\n"
+					"#@ $#\n"
+					"#   #\n"
+					"#####\n");
+			REQUIRE(transform_direction(GD_UP, GS_ROTATE_90) == GD_RIGHT);
+			REQUIRE(transform_direction(GD_LEFT, GS_FLIP_COLUMNS) == GD_RIGHT);
+			REQUIRE(transform_direction(GD_UP, GS_FLIP_COLUMNS) == GD_UP);
+			REQUIRE(transform_direction(GD_UP, GS_TRANSPOSE) == GD_LEFT);
+		}
+
+		THEN("every symmetry can be undone") {
+			for (unsigned int s=0; s<GRID_SYMMETRIES; s++) {
+				sokoban_world t = transform_world(w, (grid_symmetry)s);
+				REQUIRE(transform_world(t, inverse_symmetry((grid_symmetry)s)).to_xsb() == w.to_xsb());
+				for (unsigned int d=0; d<GRID_DIRECTIONS; d++) {
+					REQUIRE(transform_direction(transform_direction((grid_direction)d, (grid_symmetry)s), inverse_symmetry((grid_symmetry)s)) == d);
+				}
+			}
+		}
+
+		THEN("the canonical key is the same for every symmetric version") {
+			grid_symmetry applied;
+			std::string key = canonical_key(w, applied);
+
+			for (unsigned int s=0; s<GRID_SYMMETRIES; s++) {
+				grid_symmetry other;
+				REQUIRE(canonical_key(transform_world(w, (grid_symmetry)s), other) == key);
+			}
+			sokoban_world moved{w};
+			moved.set_player(w.index_of(point{1, 2}));
+			REQUIRE(canonical_key(moved, applied) != key);
+		}
+	}
+}
+
+SCENARIO("test plan cache") {
+
+	GIVEN("a cache file") {
+		const char* filename = "test_plan_cache.cache";
+		std::remove(filename);
+
+		sokoban_world w{1, 1};
+		REQUIRE(w.load_xsb(
+				"######\n"
+				"#    #\n"
+				"# $$ #\n"
+				"#.. @#\n"
+				"######\n"));
+		sokoban_solver* solver = solver_registry::get_instance()->create("push-bfs");
+		sokoban_plan plan;
+		solver_statistics statistics;
+		REQUIRE(solver->solve(w, plan, statistics));
+		delete solver;
+
+		plan_cache cache;
+		REQUIRE(cache.open(filename, 4));
+
+		WHEN("a plan is stored") {
+			REQUIRE(cache.store(w, plan));
+			REQUIRE(cache.size() == 1);
+
+			THEN("it is found for the world and its symmetric versions") {
+				for (unsigned int s=0; s<GRID_SYMMETRIES; s++) {
+					sokoban_plan cached;
+					REQUIRE(cache.lookup(transform_world(w, (grid_symmetry)s), cached));
+					REQUIRE(same_plan(cached, transform_plan(plan, (grid_symmetry)s)));
+				}
+			}
+
+			THEN("it survives the closing of the file") {
+				sokoban_plan cached;
+				cache.close();
+				REQUIRE_FALSE(cache.lookup(w, cached));
+				REQUIRE(cache.open(filename));
+				REQUIRE(cache.size() == 1);
+				REQUIRE(cache.lookup(w, cached));
+				REQUIRE(same_plan(cached, plan));
+			}
+
+			THEN("a truncated file is refused") {
+				cache.close();
+				FILE* file = std::fopen(filename, "r+b");
+				REQUIRE(file != nullptr);
+				REQUIRE(ftruncate(fileno(file), 32 + 4 * 24 + 8) == 0);
+				std::fclose(file);
+				REQUIRE_FALSE(cache.open(filename));
+			}
+
+			THEN("a file with a slot pointing out of the data area is refused") {
+				cache.close();
+				FILE* file = std::fopen(filename, "r+b");
+				REQUIRE(file != nullptr);
+				//the offset of every slot, used or not
+				for (unsigned int slot=0; slot<4; slot++) {
+					unsigned char offset[8] = {0xFF, 0xFF, 0xFF, 0xFF, 0, 0, 0, 0};
+					REQUIRE(std::fseek(file, 32 + slot * 24 + 8, SEEK_SET) == 0);
+					REQUIRE(std::fwrite(offset, 1, sizeof(offset), file) == sizeof(offset));
+				}
+				std::fclose(file);
+				REQUIRE_FALSE(cache.open(filename));
+			}
+
+			THEN("other worlds are not found") {
+				sokoban_plan cached;
+				sokoban_world other = generate_sokoban_world(6, 6, 2, 1);
+				REQUIRE_FALSE(cache.lookup(other, cached));
+				REQUIRE(cached.empty());
+			}
+		}
+
+		WHEN("the table is full") {
+			unsigned int stored = 0;
+			for (unsigned int seed=1; seed<=10; seed++) {
+				if (cache.store(generate_sokoban_world(12, 12, 4, seed), plan)) {
+					stored++;
+				}
+			}
+
+			THEN("new plans are refused, but the file grows to hold the others") {
+				REQUIRE(stored == 3);
+				REQUIRE(cache.size() == 3);
+				sokoban_plan cached;
+				REQUIRE(cache.lookup(generate_sokoban_world(12, 12, 4, 1), cached));
+				REQUIRE(same_plan(cached, plan));
+			}
+		}
+
+		WHEN("a cached solver is used") {
+			cached_solver solver{solver_registry::get_instance()->create("push-greedy"), &cache};
+			sokoban_plan first;
+			sokoban_plan second;
+
+			REQUIRE(solver.solve(w, first, statistics));
+			REQUIRE(statistics.nodes_expanded > 0);
+			REQUIRE(solver.solve(transform_world(w, GS_FLIP_ROWS), second, statistics));
+
+			THEN("the second time the plan comes from the cache") {
+				REQUIRE(statistics.nodes_expanded == 0);
+				REQUIRE(same_plan(second, transform_plan(first, GS_FLIP_ROWS)));
+			}
+		}
+
+		cache.close();
+		std::remove(filename);
+	}
+}
+
+#endif /* DESKTOP_BUILD */
@@ -0,0 +1,164 @@
+/*
+ * test_plan_validator.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifdef DESKTOP_BUILD
+
+#include <algorithm>
+#include <random>
+#include "catch.hpp"
+#include "plan_validator.hpp"
+#include "sokoban_solver.hpp"
+
+using namespace robo_utils;
+
+/**
+ * Straightforward replay on ::sokoban_world, used as reference
+ *
+ * @return the number of actions executed before the first one which can't be
+ */
+static unsigned int reference_replay(const sokoban_world& w, const sokoban_plan& plan, bool& solved) {
+	unsigned int robot = w.player();
+	std::vector<unsigned int> blocks = w.blocks();
+
+	solved = false;
+	for (unsigned int i=0; i<plan.size(); i++) {
+		unsigned int next;
+		if (!w.neighbour(robot, plan[i].direction, next) || w.is_wall(next)) {
+			return i;
+		}
+		std::vector<unsigned int>::iterator b = std::find(blocks.begin(), blocks.end(), next);
+		if (plan[i].type == SAT_MOVE && b != blocks.end()) {
+			return i;
+		}
+		if (plan[i].type == SAT_PUSH) {
+			unsigned int to;
+			if (b == blocks.end() || !w.neighbour(next, plan[i].direction, to) || w.is_wall(to) || std::find(blocks.begin(), blocks.end(), to) != blocks.end()) {
+				return i;
+			}
+			*b = to;
+		}
+		robot = next;
+	}
+	solved = true;
+	for (unsigned int i=0; i<blocks.size(); i++) {
+		solved = solved && w.is_goal(blocks[i]);
+	}
+	return plan.size();
+}
+
+SCENARIO("test plan validator") {
+
+	GIVEN("a small level") {
+		sokoban_world w{1, 1};
+		REQUIRE(w.load_xsb(
+				"#####\n"
+				"#@$.#\n"
+				"# $ #\n"
+				"#  .#\n"
+				"#####\n"));
+		plan_validator validator{w};
+
+		WHEN("a plan solving it is validated") {
+			sokoban_plan plan{
+				{SAT_PUSH, GD_RIGHT},
+				{SAT_PUSH, GD_DOWN},
+				{SAT_MOVE, GD_LEFT},
+				{SAT_MOVE, GD_DOWN},
+				{SAT_PUSH, GD_RIGHT},
+			};
+			plan_validation result = validator.validate(plan);
+
+			THEN("it is valid and the execution time is predicted") {
+				execution_time_model times = default_execution_time_model();
+				REQUIRE(result.valid);
+				REQUIRE(result.solved);
+				REQUIRE(result.failed_action == plan.size());
+				REQUIRE(result.moves == 2);
+				REQUIRE(result.pushes == 3);
+				//start facing down: right, down, left, down, right
+				REQUIRE(result.turns == 5);
+				REQUIRE(result.predicted_time_ms == 5 * times.turn_90_ms + 2 * times.move_ms + 3 * times.push_ms + 5 * times.message_ms);
+			}
+
+			THEN("the validator can be used again") {
+				REQUIRE(validator.validate(plan).solved);
+			}
+		}
+
+		WHEN("plans with wrong actions are validated") {
+			THEN("the first wrong action is reported") {
+				//into a wall
+				REQUIRE(validator.validate(sokoban_plan{{SAT_MOVE, GD_UP}}).failed_action == 0);
+				//into a block
+				REQUIRE(validator.validate(sokoban_plan{{SAT_MOVE, GD_RIGHT}}).failed_action == 0);
+				//pushing nothing
+				REQUIRE(validator.validate(sokoban_plan{{SAT_PUSH, GD_DOWN}}).failed_action == 0);
+				//pushing a block into a wall
+				REQUIRE(validator.validate(sokoban_plan{{SAT_PUSH, GD_RIGHT}, {SAT_PUSH, GD_RIGHT}}).failed_action == 1);
+				//pushing a block into another one
+				plan_validation result = validator.validate(sokoban_plan{{SAT_MOVE, GD_DOWN}, {SAT_MOVE, GD_DOWN}, {SAT_MOVE, GD_RIGHT}, {SAT_PUSH, GD_UP}});
+				REQUIRE_FALSE(result.valid);
+				REQUIRE_FALSE(result.solved);
+				REQUIRE(result.failed_action == 3);
+				REQUIRE(result.moves == 3);
+			}
+		}
+
+		WHEN("a valid plan doesn't solve the problem") {
+			plan_validation result = validator.validate(sokoban_plan{{SAT_MOVE, GD_DOWN}});
+
+			THEN("it is not solved") {
+				REQUIRE(result.valid);
+				REQUIRE_FALSE(result.solved);
+			}
+		}
+	}
+
+	GIVEN("random action sequences on generated worlds") {
+		std::mt19937 random{7};
+
+		THEN("the validator agrees with the straightforward replay") {
+			for (unsigned int seed=1; seed<=20; seed++) {
+				sokoban_world w = generate_sokoban_world(9, 7, 3, seed);
+				plan_validator validator{w};
+
+				for (unsigned int k=0; k<50; k++) {
+					sokoban_plan plan;
+					for (unsigned int i=random() % 40; i>0; i--) {
+						plan.push_back(sokoban_action{(sokoban_action_type)(random() % 2), (grid_direction)(random() % GRID_DIRECTIONS)});
+					}
+					bool solved;
+					unsigned int executed = reference_replay(w, plan, solved);
+					plan_validation result = validator.validate(plan);
+					REQUIRE(result.failed_action == executed);
+					REQUIRE(result.valid == (executed == plan.size()));
+					REQUIRE(result.solved == solved);
+				}
+			}
+		}
+	}
+
+	GIVEN("the plans of the registered solvers") {
+		std::vector<std::string> names = solver_registry::get_instance()->names();
+
+		THEN("they are all valid") {
+			for (unsigned int i=0; i<names.size(); i++) {
+				sokoban_solver* s = solver_registry::get_instance()->create(names[i]);
+				for (unsigned int seed=1; seed<=10; seed++) {
+					sokoban_world w = generate_sokoban_world(8, 8, 2, seed);
+					sokoban_plan plan;
+					solver_statistics statistics;
+					REQUIRE(s->solve(w, plan, statistics));
+					REQUIRE(plan_validator{w}.validate(plan).solved);
+				}
+				delete s;
+			}
+		}
+	}
+}
+
+#endif /* DESKTOP_BUILD */
@@ -0,0 +1,207 @@
+/*
+ * test_sokoban.cpp
+ *
+ *  Created on: Oct 19, 2026
+ *      Author: agent
+ */
+
+#ifdef DESKTOP_BUILD
+
+#include <algorithm>
+#include "catch.hpp"
+#include "sokoban_world.hpp"
+#include "sokoban_solver.hpp"
+
+using namespace robo_utils;
+
+/**
+ * Apply a plan to a world, checking every action is legal
+ */
+static bool replay(sokoban_world w, const sokoban_plan& plan, sokoban_world& result) {
+	unsigned int robot = w.player();
+	std::vector<unsigned int> blocks = w.blocks();
+
+	for (unsigned int i=0; i<plan.size(); i++) {
+		unsigned int next;
+		if (!w.neighbour(robot, plan[i].direction, next) || w.is_wall(next)) {
+			return false;
+		}
+		std::vector<unsigned int>::iterator b = std::find(blocks.begin(), blocks.end(), next);
+		if (plan[i].type == SAT_MOVE && b != blocks.end()) {
+			return false;
+		}
+		if (plan[i].type == SAT_PUSH) {
+			unsigned int to;
+			if (b == blocks.end() || !w.neighbour(next, plan[i].direction, to) || w.is_wall(to) || std::find(blocks.begin(), blocks.end(), to) != blocks.end()) {
+				return false;
+			}
+			*b = to;
+		}
+		robot = next;
+	}
+	w.clear_blocks();
+	for (unsigned int i=0; i<blocks.size(); i++) {
+		w.add_block(blocks[i]);
+	}
+	w.set_player(robot);
+	result = w;
+	return true;
+}
+
+SCENARIO("test sokoban world") {
+
+	GIVEN("a level in XSB format") {
+		sokoban_world w{1, 1};
+		std::string level =
+				"  #####\n"
+				"###   #\n"
+				"#.@$  #\n"
+				"#######\n";
+
+		REQUIRE(w.load_xsb(level));
+
+		THEN("the grid is correct") {
+			REQUIRE(w.rows() == 4);
+			REQUIRE(w.columns() == 7);
+			REQUIRE(w.player() == w.index_of(point{2, 2}));
+			REQUIRE(w.blocks().size() == 1);
+			REQUIRE(w.blocks()[0] == w.index_of(point{2, 3}));
+			REQUIRE(w.is_goal(w.index_of(point{2, 1})));
+			REQUIRE(w.is_wall(w.index_of(point{0, 0})));
+			REQUIRE_FALSE(w.is_wall(w.index_of(point{1, 4})));
+			REQUIRE_FALSE(w.is_solved());
+		}
+
+		THEN("it can be converted back") {
+			REQUIRE(w.to_xsb() ==
+					"#######\n"
+					"###   #\n"
+					"#.@$  #\n"
+					"#######\n");
+		}
+	}
+
+	GIVEN("malformed levels") {
+		sokoban_world w{1, 1};
+
+		THEN("they are rejected") {
+			REQUIRE_FALSE(w.load_xsb("#####\n# $.#\n#####\n"));
+			REQUIRE_FALSE(w.load_xsb("#####\n#@@.#\n#####\n"));
+			REQUIRE_FALSE(w.load_xsb("#####\n#@x.#\n#####\n"));
+			REQUIRE(w.rows() == 1);
+		}
+	}
+
+	GIVEN("a generated world") {
+		sokoban_world w = generate_sokoban_world(8, 8, 3, 42);
+
+		THEN("it is the same for the same seed") {
+			REQUIRE(w.to_xsb() == generate_sokoban_world(8, 8, 3, 42).to_xsb());
+			REQUIRE(w.blocks().size() == 3);
+			REQUIRE(w.goals().size() == 3);
+		}
+	}
+
+	GIVEN("the worlds generated for the benchmark") {
+
+		THEN("none of them is already solved") {
+			for (unsigned int size=6; size<=12; size+=2) {
+				for (unsigned int blocks=1; blocks<=4; blocks++) {
+					for (unsigned int seed=1; seed<=8; seed++) {
+						REQUIRE_FALSE(generate_sokoban_world(size, size, blocks, seed).is_solved());
+					}
+				}
+			}
+		}
+	}
+}
+
+SCENARIO("test sokoban solvers") {
+
+	GIVEN("the registry") {
+		solver_registry* registry = solver_registry::get_instance();
+
+		THEN("the built-in solvers are there") {
+			REQUIRE(registry->names().size() >= 2);
+			REQUIRE(registry->create("not-a-solver") == nullptr);
+			REQUIRE_FALSE(registry->add("push-bfs", nullptr));
+		}
+
+		WHEN("a small level is solved by every solver") {
+			sokoban_world w{1, 1};
+			REQUIRE(w.load_xsb(
+					"######\n"
+					"#    #\n"
+					"# $$ #\n"
+					"#.. @#\n"
+					"######\n"));
+			std::vector<std::string> names = registry->names();
+
+			for (unsigned int i=0; i<names.size(); i++) {
+				sokoban_solver* s = registry->create(names[i]);
+				sokoban_plan plan;
+				solver_statistics statistics;
+				sokoban_world end{1, 1};
+
+				REQUIRE(s->solve(w, plan, statistics));
+				REQUIRE(statistics.nodes_expanded > 0);
+				REQUIRE(replay(w, plan, end));
+				REQUIRE(end.is_solved());
+				delete s;
+			}
+		}
+
+		WHEN("the level can't be solved") {
+			sokoban_world w{1, 1};
+			REQUIRE(w.load_xsb(
+					"#####\n"
+					"#$ .#\n"
+					"#  @#\n"
+					"#####\n"));
+			sokoban_solver* s = registry->create("push-bfs");
+			sokoban_plan plan;
+			solver_statistics statistics;
+
+			THEN("no plan is found") {
+				REQUIRE_FALSE(s->solve(w, plan, statistics));
+				REQUIRE(plan.empty());
+			}
+			delete s;
+		}
+
+		WHEN("the world has no blocks") {
+			sokoban_world w{1, 1};
+			REQUIRE(w.load_xsb(
+					"####\n"
+					"#@ #\n"
+					"####\n"));
+			sokoban_solver* s = registry->create("push-bfs");
+			sokoban_plan plan;
+			solver_statistics statistics;
+
+			THEN("it is solved with an empty plan") {
+				REQUIRE(s->solve(w, plan, statistics));
+				REQUIRE(plan.empty());
+			}
+			delete s;
+		}
+
+		WHEN("generated worlds are solved by breadth first search") {
+			sokoban_solver* s = registry->create("push-bfs");
+
+			for (unsigned int seed=1; seed<=5; seed++) {
+				sokoban_world w = generate_sokoban_world(7, 7, 2, seed);
+				sokoban_plan plan;
+				solver_statistics statistics;
+				sokoban_world end{1, 1};
+
+				REQUIRE(s->solve(w, plan, statistics));
+				REQUIRE(replay(w, plan, end));
+				REQUIRE(end.is_solved());
+			}
+			delete s;
+		}
+	}
+}
+
+#endif /* DESKTOP_BUILD */